@@ -0,0 +1,210 @@
+#include "header/quadtree.h"
+#include "header/op.h"
+#include "header/pngwriter.h"
+#include "header/jpegwriter.h"
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <filesystem>
+#include <cstdlib>
+#include <cstdio>
+#include <algorithm>
+#include <cmath>
+#include <iterator>
+
+// Benchmark sederhana: baca gambar, bangun quadtree untuk tiap metode,
+// rekonstruksi, lalu tulis hasil ke png/jpg. Dipakai juga untuk training PGO.
+//
+//   quadtree_bench [--iterations N] [--min-block N] gambar...
+//
+// --sampling: bandingkan build persis dengan mode metrik aproksimasi
+// (QuadTreeSampling) untuk beberapa ukuran sampel dan z; waktu build
+// diambil yang tercepat dari N iterasi.
+//
+//   quadtree_bench --sampling [--iterations N] [--min-block N] gambar...
+
+namespace {
+
+struct MethodPreset {
+    int method;
+    const char* name;
+    double threshold;
+};
+
+const MethodPreset kPresets[] = {
+    {1, "VARIANCE", 100.0},
+    {2, "MAD", 10.0},
+    {3, "MPD", 30.0},
+    {4, "ENTROPY", 4.0},
+    {5, "SSIM", 0.9},
+};
+
+using Clock = std::chrono::steady_clock;
+
+double msSince(Clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+// threshold kasar: banyak blok besar menjadi daun, tempat sampling paling berpengaruh
+const MethodPreset kCoarsePresets[] = {
+    {1, "VARIANCE", 1000.0},
+    {2, "MAD", 15.0},
+    {4, "ENTROPY", 6.0},
+    {5, "SSIM", 0.3},
+};
+
+const int kSampleSizes[] = {256, 1024, 4096};
+const double kConfidenceZ[] = {1.0, 3.0};
+
+// build tercepat dari iterations kali; tree berisi hasil build terakhir
+double bestBuildMs(QuadTree& quadtree, const std::vector<std::vector<Color>>& image, const MethodPreset& preset,
+                   int minBlockSize, const QuadTreeSampling& sampling, int iterations) {
+    double best = 0.0;
+    for (int it = 0; it < iterations; it++) {
+        auto start = Clock::now();
+        quadtree.buildfrImage(image, preset.method, preset.threshold, minBlockSize, sampling);
+        double ms = msSince(start);
+        best = it == 0 ? ms : std::min(best, ms);
+    }
+    return best;
+}
+
+int runSamplingBench(const std::vector<std::string>& inputs, int iterations, int minBlockSize) {
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "image,method,threshold,sample_size,z,build_ms,speedup,leaves,leaves_exact,psnr,psnr_exact,"
+              << "sampled_decisions,exact_fallbacks,scanned_pixels" << std::endl;
+
+    std::vector<std::vector<Color>> reconstructed;
+    for (const std::string& input : inputs) {
+        std::vector<std::vector<Color>> image;
+        int width, height;
+        if (!readImage(input, image, width, height)) {
+            std::cerr << "Gagal read gambar: " << input << std::endl;
+            return 1;
+        }
+
+        std::vector<MethodPreset> presets(std::begin(kPresets), std::end(kPresets));
+        presets.insert(presets.end(), std::begin(kCoarsePresets), std::end(kCoarsePresets));
+        for (const MethodPreset& preset : presets) {
+            QuadTree quadtree;
+            double exactMs = bestBuildMs(quadtree, image, preset, minBlockSize, QuadTreeSampling(), iterations);
+            int exactLeaves = quadtree.getLeafCount();
+            quadtree.reconstructImage(reconstructed, width, height);
+            double exactPsnr = hitungPSNR(image, reconstructed);
+            std::cout << input << "," << preset.name << "," << preset.threshold << ",exact,-," << exactMs << ",1.00,"
+                      << exactLeaves << "," << exactLeaves << "," << exactPsnr << "," << exactPsnr << ",0,0,"
+                      << quadtree.getScanStats().scannedPixels << std::endl;
+
+            for (int sampleSize : kSampleSizes) {
+                for (double z : kConfidenceZ) {
+                    QuadTreeSampling sampling;
+                    sampling.enabled = true;
+                    sampling.sampleSize = sampleSize;
+                    sampling.confidenceZ = z;
+                    double buildMs = bestBuildMs(quadtree, image, preset, minBlockSize, sampling, iterations);
+                    quadtree.reconstructImage(reconstructed, width, height);
+                    const QuadTreeScanStats& stats = quadtree.getScanStats();
+                    std::cout << input << "," << preset.name << "," << preset.threshold << "," << sampleSize << ","
+                              << z << ","
+                              << buildMs << "," << exactMs / buildMs << ","
+                              << quadtree.getLeafCount() << "," << exactLeaves << ","
+                              << hitungPSNR(image, reconstructed) << "," << exactPsnr << ","
+                              << stats.sampledDecisions << "," << stats.exactFallbacks << ","
+                              << stats.scannedPixels + stats.sampledPixels << std::endl;
+                }
+            }
+        }
+    }
+    return 0;
+}
+
+}
+
+int main(int argc, char** argv) {
+    int iterations = 1;
+    int minBlockSize = 4;
+    bool samplingMode = false;
+    std::vector<std::string> inputs;
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--min-block" && i + 1 < argc) {
+            minBlockSize = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--sampling") {
+            samplingMode = true;
+        } else {
+            inputs.push_back(arg);
+        }
+    }
+
+    if (inputs.empty()) {
+        std::cerr << "Pemakaian: " << argv[0] << " [--sampling] [--iterations N] [--min-block N] gambar..." << std::endl;
+        return 1;
+    }
+    if (samplingMode) return runSamplingBench(inputs, iterations, minBlockSize);
+
+    std::filesystem::path tempDir = std::filesystem::temp_directory_path();
+    std::string outPng = (tempDir / "quadtree_bench.png").string();
+    std::string outJpg = (tempDir / "quadtree_bench.jpg").string();
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "image,method,nodes,depth,read_ms,build_ms,reconstruct_ms,png_ms,png_bytes,png_stb_ms,png_stb_bytes,jpg_ms,jpg_bytes,jpg_pixels_ms,jpg_pixels_bytes" << std::endl;
+
+    for (const std::string& input : inputs) {
+        for (int it = 0; it < iterations; it++) {
+            auto start = Clock::now();
+            std::vector<std::vector<Color>> image;
+            int width, height;
+            if (!readImage(input, image, width, height)) {
+                std::cerr << "Gagal read gambar: " << input << std::endl;
+                return 1;
+            }
+            double readMs = msSince(start);
+
+            for (const MethodPreset& preset : kPresets) {
+                start = Clock::now();
+                QuadTree quadtree;
+                quadtree.buildfrImage(image, preset.method, preset.threshold, minBlockSize);
+                double buildMs = msSince(start);
+
+                start = Clock::now();
+                std::vector<std::vector<Color>> reconstructed = quadtree.reconstructImage(width, height);
+                double reconstructMs = msSince(start);
+
+                start = Clock::now();
+                writeQuadtreePNG(outPng, quadtree);
+                double pngMs = msSince(start);
+                size_t pngBytes = getFileSize(outPng);
+
+                start = Clock::now();
+                writeImage(outPng, reconstructed);
+                double pngStbMs = msSince(start);
+                size_t pngStbBytes = getFileSize(outPng);
+
+                start = Clock::now();
+                writeQuadtreeJPEG(outJpg, quadtree);
+                double jpgMs = msSince(start);
+                size_t jpgBytes = getFileSize(outJpg);
+
+                start = Clock::now();
+                writeImage(outJpg, reconstructed);
+                double jpgPixelsMs = msSince(start);
+                size_t jpgPixelsBytes = getFileSize(outJpg);
+
+                std::cout << input << "," << preset.name << ","
+                          << quadtree.getTotalNodes() << "," << quadtree.getMaxDepth() << ","
+                          << readMs << "," << buildMs << "," << reconstructMs << ","
+                          << pngMs << "," << pngBytes << "," << pngStbMs << "," << pngStbBytes << ","
+                          << jpgMs << "," << jpgBytes << "," << jpgPixelsMs << "," << jpgPixelsBytes << std::endl;
+            }
+        }
+    }
+
+    std::remove(outPng.c_str());
+    std::remove(outJpg.c_str());
+    return 0;
+}
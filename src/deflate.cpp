@@ -0,0 +1,714 @@
+#include "header/deflate.h"
+#include "header/threadpool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const int kBlockTokens = 1 << 15;
+const int kMaxMatch = 258;
+const int kWindowSize = 1 << 15;
+const int kWindowMask = kWindowSize - 1;
+const int kHashBits = 15;
+const size_t kWindowChunk = 1 << 18;    // data yang dikumpulkan sebelum dikompres
+const size_t kSlideThreshold = 1 << 20; // geser window setelah sebanyak ini
+const size_t kParallelChunk = 1 << 18;
+
+struct LevelConfig {
+    int maxChain;
+    int niceLength;
+    bool lazy;
+};
+
+const LevelConfig kLevels[10] = {
+    {0, 0, false}, {0, 0, false},
+    {4, 16, false}, {8, 32, false}, {16, 64, false},
+    {16, 64, true}, {64, 128, true}, {128, 258, true}, {512, 258, true}, {4096, 258, true}
+};
+
+const uint16_t kLengthBase[29] = {
+    3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+    35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258
+};
+const uint8_t kLengthExtra[29] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+    3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0
+};
+const uint16_t kDistBase[30] = {
+    1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+    257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577
+};
+const uint8_t kDistExtra[30] = {
+    0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+    7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13
+};
+const uint8_t kCodeLengthOrder[19] = {
+    16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15
+};
+
+struct SymbolTables {
+    uint8_t lengthSymbol[kMaxMatch + 1];   // panjang -> indeks kLengthBase
+    uint8_t distSymbol[32769];             // jarak -> indeks kDistBase
+    uint32_t crc[256];
+
+    SymbolTables() {
+        for (int code = 0; code < 29; code++) {
+            int end = code + 1 < 29 ? kLengthBase[code + 1] : kMaxMatch + 1;
+            for (int len = kLengthBase[code]; len < end && len <= kMaxMatch; len++) lengthSymbol[len] = code;
+        }
+        lengthSymbol[kMaxMatch] = 28;
+        for (int code = 0; code < 30; code++) {
+            int end = code + 1 < 30 ? kDistBase[code + 1] : 32769;
+            for (int d = kDistBase[code]; d < end; d++) distSymbol[d] = code;
+        }
+        for (uint32_t n = 0; n < 256; n++) {
+            uint32_t c = n;
+            for (int k = 0; k < 8; k++) c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            crc[n] = c;
+        }
+    }
+};
+
+const SymbolTables& tables() {
+    static const SymbolTables t;
+    return t;
+}
+
+uint32_t reverseBits(uint32_t code, int length) {
+    uint32_t result = 0;
+    for (int i = 0; i < length; i++) {
+        result = (result << 1) | (code & 1);
+        code >>= 1;
+    }
+    return result;
+}
+
+// Panjang kode Huffman dengan batas maxBits (penyesuaian overflow ala miniz).
+// Selalu menghasilkan kode lengkap dengan minimal dua simbol.
+void buildCodeLengths(const uint32_t* freqIn, int n, int maxBits, uint8_t* lengths) {
+    std::vector<uint32_t> freq(freqIn, freqIn + n);
+    int used = 0;
+    for (int i = 0; i < n; i++) used += freq[i] > 0;
+    for (int i = 0; i < n && used < 2; i++) {
+        if (freq[i] == 0) {
+            freq[i] = 1;
+            used++;
+        }
+    }
+
+    std::vector<std::pair<uint32_t, int>> symbols;
+    for (int i = 0; i < n; i++) {
+        if (freq[i]) symbols.push_back({freq[i], i});
+    }
+    std::sort(symbols.begin(), symbols.end());
+    std::fill(lengths, lengths + n, 0);
+
+    // Huffman dua antrian: daun terurut + node internal yang terbentuk berurutan
+    int m = symbols.size();
+    std::vector<uint64_t> weight(2 * m);
+    std::vector<int> parent(2 * m, -1);
+    for (int i = 0; i < m; i++) weight[i] = symbols[i].first;
+
+    int leaf = 0, internal = m, next = m;
+    auto pickSmallest = [&]() {
+        if (leaf < m && (internal >= next || weight[leaf] <= weight[internal])) return leaf++;
+        return internal++;
+    };
+    while (next < 2 * m - 1) {
+        int a = pickSmallest();
+        int b = pickSmallest();
+        weight[next] = weight[a] + weight[b];
+        parent[a] = parent[b] = next;
+        next++;
+    }
+
+    std::vector<int> depth(2 * m, 0);
+    int numCodes[64] = {0};
+    for (int i = 2 * m - 3; i >= 0; i--) depth[i] = depth[parent[i]] + 1;
+    for (int i = 0; i < m; i++) numCodes[std::min(depth[i], 63)]++;
+
+    for (int i = maxBits + 1; i < 64; i++) {
+        numCodes[maxBits] += numCodes[i];
+        numCodes[i] = 0;
+    }
+    uint32_t total = 0;
+    for (int i = maxBits; i > 0; i--) total += (uint32_t)numCodes[i] << (maxBits - i);
+    while (total != (1u << maxBits)) {
+        numCodes[maxBits]--;
+        for (int i = maxBits - 1; i > 0; i--) {
+            if (numCodes[i]) {
+                numCodes[i]--;
+                numCodes[i + 1] += 2;
+                break;
+            }
+        }
+        total--;
+    }
+
+    // simbol paling jarang mendapat kode paling panjang
+    int idx = 0;
+    for (int len = maxBits; len > 0; len--) {
+        for (int k = 0; k < numCodes[len]; k++) lengths[symbols[idx++].second] = len;
+    }
+}
+
+void buildCodes(const uint8_t* lengths, int n, uint16_t* codes) {
+    int count[16] = {0};
+    for (int i = 0; i < n; i++) count[lengths[i]]++;
+    count[0] = 0;
+
+    int nextCode[16] = {0};
+    int code = 0;
+    for (int len = 1; len < 16; len++) {
+        code = (code + count[len - 1]) << 1;
+        nextCode[len] = code;
+    }
+    for (int i = 0; i < n; i++) {
+        if (lengths[i]) codes[i] = reverseBits(nextCode[lengths[i]]++, lengths[i]);
+    }
+}
+
+}
+
+unsigned char zlibLevelFlag(int level) {
+    static const unsigned char flags[10] = {0x01, 0x01, 0x5E, 0x5E, 0x5E, 0x5E, 0x9C, 0xDA, 0xDA, 0xDA};
+    return flags[std::max(0, std::min(level, 9))];
+}
+
+uint32_t adler32Update(uint32_t adler, const unsigned char* data, size_t size) {
+    uint32_t a = adler & 0xFFFF, b = adler >> 16;
+    while (size > 0) {
+        size_t block = std::min<size_t>(size, 5552);
+        size -= block;
+        for (size_t i = 0; i < block; i++) {
+            a += data[i];
+            b += a;
+        }
+        data += block;
+        a %= 65521;
+        b %= 65521;
+    }
+    return (b << 16) | a;
+}
+
+uint32_t adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t sizeB) {
+    const uint32_t base = 65521;
+    uint32_t rem = (uint32_t)(sizeB % base);
+    uint32_t sum1 = adlerA & 0xFFFF;
+    uint32_t sum2 = (uint32_t)(((uint64_t)rem * sum1) % base);
+    sum1 += (adlerB & 0xFFFF) + base - 1;
+    sum2 += ((adlerA >> 16) & 0xFFFF) + ((adlerB >> 16) & 0xFFFF) + base - rem;
+    if (sum1 >= base) sum1 -= base;
+    if (sum1 >= base) sum1 -= base;
+    if (sum2 >= (base << 1)) sum2 -= (base << 1);
+    if (sum2 >= base) sum2 -= base;
+    return sum1 | (sum2 << 16);
+}
+
+uint32_t crc32Update(uint32_t crc, const unsigned char* data, size_t size) {
+    const uint32_t* table = tables().crc;
+    crc = ~crc;
+    for (size_t i = 0; i < size; i++) crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    return ~crc;
+}
+
+DeflateEncoder::DeflateEncoder(std::vector<unsigned char>& out, int level, DeflateFormat format)
+    : out(out), level(std::max(0, std::min(level, 9))), format(format) {
+    std::memset(litLenFreq, 0, sizeof(litLenFreq));
+    std::memset(distFreq, 0, sizeof(distFreq));
+    tokenLitLen.reserve(kBlockTokens);
+    tokenDist.reserve(kBlockTokens);
+
+    if (this->level >= 2) {
+        const LevelConfig& config = kLevels[this->level];
+        maxChain = config.maxChain;
+        niceLength = config.niceLength;
+        lazy = config.lazy;
+        head.assign(1 << kHashBits, -1);
+        prev.assign(kWindowSize, -1);
+    }
+
+    if (format == DEFLATE_ZLIB) {
+        out.push_back(0x78); // CMF: deflate, window 32K
+        out.push_back(zlibLevelFlag(this->level));
+    }
+}
+
+void DeflateEncoder::setDictionary(const unsigned char* data, size_t size) {
+    if (size == 0) return;
+    if (level == 1) {
+        prevByte = data[size - 1];
+    } else if (level >= 2) {
+        size_t n = std::min(size, (size_t)kWindowSize);
+        window.assign(data + size - n, data + size);
+        for (size_t pos = 0; pos < n; pos++) insertHash(pos);
+        processed = n;
+    }
+}
+
+void DeflateEncoder::putBits(uint32_t bits, int count) {
+    bitBuffer |= (uint64_t)bits << bitCount;
+    bitCount += count;
+    if (bitCount >= 32) {
+        unsigned char bytes[4] = {
+            (unsigned char)bitBuffer, (unsigned char)(bitBuffer >> 8),
+            (unsigned char)(bitBuffer >> 16), (unsigned char)(bitBuffer >> 24)
+        };
+        out.insert(out.end(), bytes, bytes + 4);
+        bitBuffer >>= 32;
+        bitCount -= 32;
+    }
+}
+
+void DeflateEncoder::alignToByte() {
+    while (bitCount > 0) {
+        out.push_back((unsigned char)bitBuffer);
+        bitBuffer >>= 8;
+        bitCount -= 8;
+    }
+    bitBuffer = 0;
+    bitCount = 0;
+}
+
+void DeflateEncoder::emitLiteral(unsigned char value) {
+    tokenLitLen.push_back(value);
+    tokenDist.push_back(0);
+    litLenFreq[value]++;
+    if ((int)tokenLitLen.size() >= kBlockTokens) flushBlock(false);
+}
+
+void DeflateEncoder::emitMatch(int length, int distance) {
+    const SymbolTables& t = tables();
+    tokenLitLen.push_back(length);
+    tokenDist.push_back(distance);
+    litLenFreq[257 + t.lengthSymbol[length]]++;
+    distFreq[t.distSymbol[distance]]++;
+    if ((int)tokenLitLen.size() >= kBlockTokens) flushBlock(false);
+}
+
+void DeflateEncoder::flushRun() {
+    if (runLength >= 3) {
+        emitMatch(runLength, 1);
+    } else {
+        for (size_t i = 0; i < runLength; i++) emitLiteral(prevByte);
+    }
+    runLength = 0;
+}
+
+void DeflateEncoder::pushByte(unsigned char value) {
+    if (prevByte == value) {
+        if (++runLength == kMaxMatch) {
+            emitMatch(kMaxMatch, 1);
+            runLength = 0;
+        }
+        return;
+    }
+    flushRun();
+    emitLiteral(value);
+    prevByte = value;
+}
+
+void DeflateEncoder::writeRun(unsigned char value, size_t count) {
+    if (count == 0) return;
+
+    if (format == DEFLATE_ZLIB) {
+        // adler32 untuk deretan byte sama, tanpa membuat buffer
+        unsigned char chunk[4096];
+        std::memset(chunk, value, sizeof(chunk));
+        for (size_t left = count; left > 0;) {
+            size_t n = std::min(left, sizeof(chunk));
+            adler = adler32Update(adler, chunk, n);
+            left -= n;
+        }
+    }
+
+    if (level != 1) {
+        window.insert(window.end(), count, value);
+        if (window.size() - processed >= kWindowChunk) compressWindow(false);
+        return;
+    }
+
+    if (prevByte != value) {
+        pushByte(value);
+        count--;
+    }
+    runLength += count;
+    while (runLength >= (size_t)kMaxMatch) {
+        emitMatch(kMaxMatch, 1);
+        runLength -= kMaxMatch;
+    }
+}
+
+void DeflateEncoder::write(const unsigned char* data, size_t size) {
+    if (format == DEFLATE_ZLIB) adler = adler32Update(adler, data, size);
+
+    if (level != 1) {
+        appendWindow(data, size);
+        return;
+    }
+
+    size_t i = 0;
+    while (i < size) {
+        unsigned char value = data[i];
+        size_t j = i + 1;
+        while (j < size && data[j] == value) j++;
+
+        size_t count = j - i;
+        if (prevByte != value) {
+            pushByte(value);
+            count--;
+        }
+        runLength += count;
+        while (runLength >= (size_t)kMaxMatch) {
+            emitMatch(kMaxMatch, 1);
+            runLength -= kMaxMatch;
+        }
+        i = j;
+    }
+}
+
+void DeflateEncoder::flushBlock(bool final) {
+    const SymbolTables& t = tables();
+    litLenFreq[256]++; // end of block
+
+    // kode fixed memakai 288/32 simbol (286-287 dan 30-31 tidak pernah muncul),
+    // jadi kode kanonisnya harus dibentuk dari semua simbol itu
+    uint8_t litLenLengths[288] = {0}, distLengths[32] = {0};
+    buildCodeLengths(litLenFreq, 286, 15, litLenLengths);
+    buildCodeLengths(distFreq, 30, 15, distLengths);
+
+    int hlit = 286;
+    while (hlit > 257 && litLenLengths[hlit - 1] == 0) hlit--;
+    int hdist = 30;
+    while (hdist > 1 && distLengths[hdist - 1] == 0) hdist--;
+
+    // panjang kode ll + dist digabung lalu di-RLE dengan simbol 16/17/18
+    uint8_t all[286 + 30];
+    std::memcpy(all, litLenLengths, hlit);
+    std::memcpy(all + hlit, distLengths, hdist);
+    int allCount = hlit + hdist;
+
+    std::vector<uint8_t> clSymbols, clExtra;
+    uint32_t clFreq[19] = {0};
+    for (int i = 0; i < allCount;) {
+        int len = all[i];
+        int run = 1;
+        while (i + run < allCount && all[i + run] == len) run++;
+        i += run;
+
+        if (len == 0) {
+            while (run >= 11) {
+                int n = std::min(run, 138);
+                clSymbols.push_back(18); clExtra.push_back(n - 11); clFreq[18]++;
+                run -= n;
+            }
+            if (run >= 3) {
+                clSymbols.push_back(17); clExtra.push_back(run - 3); clFreq[17]++;
+                run = 0;
+            }
+        } else {
+            clSymbols.push_back(len); clExtra.push_back(0); clFreq[len]++;
+            run--;
+            while (run >= 3) {
+                int n = std::min(run, 6);
+                clSymbols.push_back(16); clExtra.push_back(n - 3); clFreq[16]++;
+                run -= n;
+            }
+        }
+        for (; run > 0; run--) {
+            clSymbols.push_back(len); clExtra.push_back(0); clFreq[len]++;
+        }
+    }
+
+    uint8_t clLengths[19];
+    buildCodeLengths(clFreq, 19, 7, clLengths);
+    int hclen = 19;
+    while (hclen > 4 && clLengths[kCodeLengthOrder[hclen - 1]] == 0) hclen--;
+
+    // pilih blok dinamis atau fixed, mana yang lebih kecil
+    uint64_t extraBits = 0;
+    for (int i = 0; i < 29; i++) extraBits += (uint64_t)litLenFreq[257 + i] * kLengthExtra[i];
+    for (int i = 0; i < 30; i++) extraBits += (uint64_t)distFreq[i] * kDistExtra[i];
+
+    uint64_t dynamicBits = 3 + 14 + 3 * hclen + extraBits;
+    for (int i = 0; i < 19; i++) dynamicBits += (uint64_t)clFreq[i] * clLengths[i];
+    dynamicBits += (uint64_t)clFreq[16] * 2 + (uint64_t)clFreq[17] * 3 + (uint64_t)clFreq[18] * 7;
+    for (int i = 0; i < 286; i++) dynamicBits += (uint64_t)litLenFreq[i] * litLenLengths[i];
+    for (int i = 0; i < 30; i++) dynamicBits += (uint64_t)distFreq[i] * distLengths[i];
+
+    uint64_t fixedBits = 3 + extraBits;
+    for (int i = 0; i < 286; i++) {
+        int len = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        fixedBits += (uint64_t)litLenFreq[i] * len;
+    }
+    for (int i = 0; i < 30; i++) fixedBits += (uint64_t)distFreq[i] * 5;
+
+    if (fixedBits <= dynamicBits) {
+        for (int i = 0; i < 288; i++) litLenLengths[i] = i < 144 ? 8 : i < 256 ? 9 : i < 280 ? 7 : 8;
+        for (int i = 0; i < 32; i++) distLengths[i] = 5;
+        putBits(final ? 1 : 0, 1);
+        putBits(1, 2);
+    } else {
+        putBits(final ? 1 : 0, 1);
+        putBits(2, 2);
+        putBits(hlit - 257, 5);
+        putBits(hdist - 1, 5);
+        putBits(hclen - 4, 4);
+        for (int i = 0; i < hclen; i++) putBits(clLengths[kCodeLengthOrder[i]], 3);
+
+        uint16_t clCodes[19];
+        buildCodes(clLengths, 19, clCodes);
+        for (size_t i = 0; i < clSymbols.size(); i++) {
+            int sym = clSymbols[i];
+            putBits(clCodes[sym], clLengths[sym]);
+            if (sym == 16) putBits(clExtra[i], 2);
+            else if (sym == 17) putBits(clExtra[i], 3);
+            else if (sym == 18) putBits(clExtra[i], 7);
+        }
+    }
+
+    uint16_t litLenCodes[288], distCodes[32];
+    buildCodes(litLenLengths, 288, litLenCodes);
+    buildCodes(distLengths, 32, distCodes);
+
+    for (size_t i = 0; i < tokenLitLen.size(); i++) {
+        int dist = tokenDist[i];
+        if (dist == 0) {
+            int lit = tokenLitLen[i];
+            putBits(litLenCodes[lit], litLenLengths[lit]);
+            continue;
+        }
+        int len = tokenLitLen[i];
+        int lsym = t.lengthSymbol[len];
+        putBits(litLenCodes[257 + lsym], litLenLengths[257 + lsym]);
+        if (kLengthExtra[lsym]) putBits(len - kLengthBase[lsym], kLengthExtra[lsym]);
+        int dsym = t.distSymbol[dist];
+        putBits(distCodes[dsym], distLengths[dsym]);
+        if (kDistExtra[dsym]) putBits(dist - kDistBase[dsym], kDistExtra[dsym]);
+    }
+    putBits(litLenCodes[256], litLenLengths[256]);
+
+    tokenLitLen.clear();
+    tokenDist.clear();
+    std::memset(litLenFreq, 0, sizeof(litLenFreq));
+    std::memset(distFreq, 0, sizeof(distFreq));
+}
+
+void DeflateEncoder::appendWindow(const unsigned char* data, size_t size) {
+    window.insert(window.end(), data, data + size);
+    if (window.size() - processed >= kWindowChunk) compressWindow(false);
+}
+
+void DeflateEncoder::writeStored(const unsigned char* data, size_t size, bool final) {
+    putBits(final ? 1 : 0, 1);
+    putBits(0, 2);
+    alignToByte();
+    out.push_back((unsigned char)size);
+    out.push_back((unsigned char)(size >> 8));
+    out.push_back((unsigned char)~size);
+    out.push_back((unsigned char)(~size >> 8));
+    out.insert(out.end(), data, data + size);
+}
+
+void DeflateEncoder::insertHash(size_t pos) {
+    if (pos + 2 >= window.size()) return;
+    uint32_t key = window[pos] | (window[pos + 1] << 8) | (window[pos + 2] << 16);
+    uint32_t h = (key * 2654435761u) >> (32 - kHashBits);
+    prev[pos & kWindowMask] = head[h];
+    head[h] = (int32_t)pos;
+}
+
+int DeflateEncoder::findMatch(size_t pos, size_t avail, int& distance) const {
+    int maxLength = (int)std::min(avail, (size_t)kMaxMatch);
+    if (maxLength < 3 || pos + 2 >= window.size()) return 0;
+
+    uint32_t key = window[pos] | (window[pos + 1] << 8) | (window[pos + 2] << 16);
+    uint32_t h = (key * 2654435761u) >> (32 - kHashBits);
+
+    const unsigned char* current = window.data() + pos;
+    int best = 2;
+    int32_t candidate = head[h];
+    for (int chain = maxChain; candidate >= 0 && chain > 0; chain--) {
+        size_t dist = pos - candidate;
+        if (dist == 0 || dist > (size_t)kWindowSize) break;
+
+        const unsigned char* match = window.data() + candidate;
+        if (match[best] == current[best] && match[0] == current[0]) {
+            int len = 0;
+            while (len < maxLength && match[len] == current[len]) len++;
+            if (len > best) {
+                best = len;
+                distance = (int)dist;
+                if (len >= niceLength || len == maxLength) break;
+            }
+        }
+
+        int32_t next = prev[candidate & kWindowMask];
+        if (next >= candidate) break;
+        candidate = next;
+    }
+    return best >= 3 ? best : 0;
+}
+
+void DeflateEncoder::slideWindow() {
+    if (processed < kSlideThreshold) return;
+
+    // kelipatan ukuran window, supaya indeks prev[pos & mask] tetap berlaku
+    size_t shift = ((processed - kWindowSize) / kWindowSize) * kWindowSize;
+    window.erase(window.begin(), window.begin() + shift);
+    processed -= shift;
+    for (int32_t& v : head) v = v >= (int32_t)shift ? v - (int32_t)shift : -1;
+    for (int32_t& v : prev) v = v >= (int32_t)shift ? v - (int32_t)shift : -1;
+}
+
+void DeflateEncoder::compressWindow(bool flushAll) {
+    size_t size = window.size();
+
+    if (level == 0) {
+        while (size - processed >= 65535 || (flushAll && processed < size)) {
+            size_t n = std::min(size - processed, (size_t)65535);
+            writeStored(window.data() + processed, n, false);
+            processed += n;
+        }
+        window.erase(window.begin(), window.begin() + processed);
+        processed = 0;
+        return;
+    }
+
+    size_t limit = flushAll ? size : (size > (size_t)kMaxMatch ? size - kMaxMatch : 0);
+    size_t pos = processed;
+    while (pos < limit) {
+        int distance = 0;
+        int length = findMatch(pos, size - pos, distance);
+        insertHash(pos);
+
+        if (matchAvailable) {
+            // match di pos-1 dipakai jika match di pos tidak lebih panjang
+            if (prevLength >= 3 && length <= prevLength) {
+                emitMatch(prevLength, prevDistance);
+                size_t end = pos - 1 + prevLength;
+                for (size_t p = pos + 1; p < end; p++) insertHash(p);
+                pos = end;
+                matchAvailable = false;
+                continue;
+            }
+            emitLiteral(window[pos - 1]);
+        }
+
+        if (lazy) {
+            matchAvailable = true;
+            prevLength = length;
+            prevDistance = distance;
+            pos++;
+        } else if (length >= 3) {
+            emitMatch(length, distance);
+            for (size_t p = pos + 1; p < pos + length; p++) insertHash(p);
+            pos += length;
+        } else {
+            emitLiteral(window[pos]);
+            pos++;
+        }
+    }
+    processed = pos;
+
+    if (flushAll && matchAvailable) {
+        if (prevLength >= 3) {
+            emitMatch(prevLength, prevDistance);
+        } else {
+            emitLiteral(window[processed - 1]);
+        }
+        matchAvailable = false;
+    }
+    slideWindow();
+}
+
+void DeflateEncoder::flushSync() {
+    if (finished) return;
+    if (level == 1) {
+        flushRun();
+    } else {
+        compressWindow(true);
+    }
+    if (!tokenLitLen.empty()) flushBlock(false);
+
+    // blok stored kosong: output berhenti tepat di batas byte
+    writeStored(nullptr, 0, false);
+}
+
+void DeflateEncoder::finish() {
+    if (finished) return;
+
+    if (level == 0) {
+        size_t left = window.size() - processed;
+        while (left > 65535) {
+            writeStored(window.data() + processed, 65535, false);
+            processed += 65535;
+            left -= 65535;
+        }
+        writeStored(window.data() + processed, left, true);
+    } else {
+        if (level == 1) {
+            flushRun();
+        } else {
+            compressWindow(true);
+        }
+        flushBlock(true);
+    }
+    alignToByte();
+
+    if (format == DEFLATE_ZLIB) {
+        out.push_back((unsigned char)(adler >> 24));
+        out.push_back((unsigned char)(adler >> 16));
+        out.push_back((unsigned char)(adler >> 8));
+        out.push_back((unsigned char)adler);
+    }
+    finished = true;
+}
+
+void deflateCompress(const unsigned char* data, size_t size, int level, std::vector<unsigned char>& out, int threads) {
+    ThreadPool& pool = ThreadPool::global();
+    int parallel = threads <= 0 ? pool.size() : threads;
+    size_t chunks = (size + kParallelChunk - 1) / kParallelChunk;
+
+    if (parallel <= 1 || chunks < 2) {
+        DeflateEncoder encoder(out, level);
+        encoder.write(data, size);
+        encoder.finish();
+        return;
+    }
+
+    std::vector<std::vector<unsigned char>> parts(chunks);
+    std::vector<uint32_t> adlers(chunks);
+    pool.parallelFor(chunks, [&](size_t i) {
+        size_t start = i * kParallelChunk;
+        size_t length = std::min(kParallelChunk, size - start);
+
+        DeflateEncoder encoder(parts[i], level, DEFLATE_RAW);
+        if (start > 0) {
+            size_t dictionary = std::min(start, (size_t)kWindowSize);
+            encoder.setDictionary(data + start - dictionary, dictionary);
+        }
+        encoder.write(data + start, length);
+        if (i + 1 == chunks) {
+            encoder.finish();
+        } else {
+            encoder.flushSync();
+        }
+        adlers[i] = adler32Update(1, data + start, length);
+    }, parallel);
+
+    out.push_back(0x78);
+    out.push_back(zlibLevelFlag(level));
+
+    uint32_t adler = adlers[0];
+    out.insert(out.end(), parts[0].begin(), parts[0].end());
+    for (size_t i = 1; i < chunks; i++) {
+        out.insert(out.end(), parts[i].begin(), parts[i].end());
+        size_t length = std::min(kParallelChunk, size - i * kParallelChunk);
+        adler = adler32Combine(adler, adlers[i], length);
+    }
+    out.push_back((unsigned char)(adler >> 24));
+    out.push_back((unsigned char)(adler >> 16));
+    out.push_back((unsigned char)(adler >> 8));
+    out.push_back((unsigned char)adler);
+}
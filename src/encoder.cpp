@@ -0,0 +1,243 @@
+#include "header/encoder.h"
+#include "header/op.h"
+#include "header/imagewriter.h"
+#include "header/metric.h"
+#include <algorithm>
+#include <cmath>
+
+const char* qtStatusMessage(QtStatus status) {
+    switch (status) {
+        case QT_OK: return "ok";
+        case QT_ERR_INVALID_ARGUMENT: return "argumen tidak valid";
+        case QT_ERR_UNSUPPORTED_FORMAT: return "format tidak didukung";
+        case QT_ERR_DECODE: return "gagal decode gambar";
+        case QT_ERR_ENCODE: return "gagal encode gambar";
+    }
+    return "status tidak dikenal";
+}
+
+const char* qtBuildStopMessage(QtBuildStop stop) {
+    switch (stop) {
+        case QT_STOP_CONVERGED: return "konvergen";
+        case QT_STOP_NODES: return "budget simpul habis";
+        case QT_STOP_LEAVES: return "budget daun habis";
+        case QT_STOP_BYTES: return "budget byte habis";
+        case QT_STOP_TIME: return "budget waktu habis";
+    }
+    return "alasan tidak dikenal";
+}
+
+static double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool isValidThreshold(int errorMethod, double threshold) {
+    if (errorMethod < 1 || errorMethod > 6 || threshold < 0) return false;
+    return withMetric(errorMethod, [&](auto metric) { return threshold <= decltype(metric)::maxThreshold; });
+}
+
+QtStatus QuadtreeEncoder::validate(const unsigned char* pixels, int width, int height, int channels,
+                                   const QtEncodeOptions& options) const {
+    if (!pixels || width <= 0 || height <= 0 || channels < 1 || channels > 4) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    return qtValidateOptions(options);
+}
+
+QtStatus qtValidateOptions(const QtEncodeOptions& options) {
+    if (options.errorMethod < 1 || options.errorMethod > 6 || options.minBlockSize < 1) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    if (options.targetCompression < 0 || options.targetCompression > 1.0) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    const QuadTreeQualityTarget& quality = options.targetQuality;
+    if (quality.isActive()) {
+        // target kualitas menggantikan threshold, tidak bisa digabung target lain
+        if (quality.metric != QT_QUALITY_PSNR && quality.metric != QT_QUALITY_SSIM) return QT_ERR_INVALID_ARGUMENT;
+        if (!(quality.minimum > 0) || (quality.metric == QT_QUALITY_SSIM && quality.minimum > 1)) {
+            return QT_ERR_INVALID_ARGUMENT;
+        }
+        if (options.targetCompression > 0 || options.budget.isLimited() || options.deadlineMillis > 0) {
+            return QT_ERR_INVALID_ARGUMENT;
+        }
+    } else if (options.targetCompression > 0) {
+        if (options.originalSize == 0) return QT_ERR_INVALID_ARGUMENT;
+    } else if (!isValidThreshold(options.errorMethod, options.threshold)) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    if (options.jpgQuality < 1 || options.jpgQuality > 100) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    if (options.pngLevel < 0 || options.pngLevel > 9 || options.threads < 0) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    if (options.budget.maxNodes < 0 || options.budget.maxLeaves < 0 || options.budget.maxMillis < 0 ||
+        options.budget.millisPerLeaf < 0) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    if (options.sampling.enabled && (options.sampling.sampleSize < 16 || !(options.sampling.confidenceZ > 0))) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    // pencarian threshold membangun tree berkali-kali dan tidak bisa dihentikan di tengah
+    if (options.deadlineMillis < 0 || (options.deadlineMillis > 0 && options.targetCompression > 0)) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    return QT_OK;
+}
+
+QuadTreeBudget qtDeadlineBudget(const QtEncodeOptions& options, int width, int height,
+                                double elapsedMillis, double encodeCostScale, double marginMillis) {
+    ImageWriteOptions writeOptions;
+    writeOptions.pngLevel = options.pngLevel;
+    writeOptions.jpgQuality = options.jpgQuality;
+    writeOptions.threads = options.threads;
+    EncodeCostEstimate cost = estimateEncodeCost(options.format, width, height, writeOptions);
+
+    QuadTreeBudget budget = options.budget;
+    // margin untuk meleset perkiraan; sisa waktu <= 0 tetap dibatasi supaya
+    // build berhenti di root
+    double remaining = options.deadlineMillis - elapsedMillis;
+    if (marginMillis < 0) marginMillis = remaining * 0.1;
+    remaining -= marginMillis + cost.millisFixed * encodeCostScale;
+    remaining = std::max(remaining, 1e-3);
+    budget.maxMillis = budget.maxMillis > 0 ? std::min(budget.maxMillis, remaining) : remaining;
+    budget.millisPerLeaf += cost.millisPerLeaf * encodeCostScale;
+    budget.weightByArea = true;
+    return budget;
+}
+
+QtStatus QuadtreeEncoder::buildLoadedImage(const QtEncodeOptions& options, QuadTree& tree, bool withEncode) {
+    int minBlockSize = options.minBlockSize;
+    lastThreshold = options.threshold;
+    if (options.targetCompression > 0) {
+        minBlockSize = 1;
+        lastThreshold = estimateThresholdForTargetCompression(
+            image, options.errorMethod, minBlockSize, options.targetCompression, options.originalSize, options.threads);
+    }
+
+    QuadTreeBudget budget = options.budget;
+    deadlinePlannedMillis = 0.0;
+    if (options.deadlineMillis > 0) {
+        double elapsed = millisSince(callStart);
+        double margin = deadlineSamples > 0 ? deadlineMargin() : (options.deadlineMillis - elapsed) * 0.1;
+        budget = qtDeadlineBudget(options, (int)image[0].size(), (int)image.size(), elapsed,
+                                  withEncode ? encodeCostScale : 0.0, margin);
+        // kalibrasi hanya jika budget deadline yang membatasi, bukan options.budget.maxMillis
+        if (budget.maxMillis < options.budget.maxMillis || options.budget.maxMillis <= 0) {
+            deadlinePlannedMillis = options.deadlineMillis - margin;
+        }
+    }
+
+    auto buildStart = std::chrono::steady_clock::now();
+    lastReport = QtEncodeReport();
+    if (options.targetQuality.isActive()) {
+        QuadTreeQuality quality = tree.buildForQuality(image, options.errorMethod, options.targetQuality, minBlockSize);
+        lastThreshold = quality.threshold;
+        lastReport.quality = quality.value;
+        lastReport.qualityReached = quality.reached;
+    } else {
+        lastReport.buildStop = tree.build(image, options.errorMethod, lastThreshold, minBlockSize, budget,
+                                          options.sampling);
+    }
+    lastReport.buildMillis = millisSince(buildStart);
+    lastReport.maxDepth = tree.getMaxDepth();
+    lastReport.leaves = tree.getLeafCount();
+    lastReport.residualError = tree.hitungResidualError();
+    lastReport.scanStats = tree.getScanStats();
+    lastReport.totalMillis = millisSince(callStart);
+    lastReport.deadlineMet = options.deadlineMillis <= 0 || lastReport.totalMillis <= options.deadlineMillis;
+    if (!withEncode) calibrateDeadline();
+    return QT_OK;
+}
+
+double QuadtreeEncoder::deadlineMargin() const {
+    return std::max(0.0, deadlineErrorMean + 2.0 * deadlineErrorDev);
+}
+
+void QuadtreeEncoder::calibrateDeadline() {
+    // build yang konvergen sebelum budget habis selesai jauh lebih awal dari
+    // rencana dan tidak mengatakan apa-apa tentang perkiraan waktu
+    if (deadlinePlannedMillis <= 0 || lastReport.buildStop != QT_STOP_TIME) return;
+    double error = lastReport.totalMillis - deadlinePlannedMillis;
+    if (deadlineSamples == 0) {
+        deadlineErrorMean = error;
+        deadlineErrorDev = std::abs(error) * 0.5;
+    } else {
+        // terlambat diserap cepat, lebih awal diturunkan pelan
+        double rate = error > deadlineErrorMean ? 0.5 : 0.25;
+        deadlineErrorDev += rate * (std::abs(error - deadlineErrorMean) - deadlineErrorDev);
+        deadlineErrorMean += rate * (error - deadlineErrorMean);
+    }
+    deadlineSamples++;
+}
+
+QtStatus QuadtreeEncoder::encodeLoadedImage(const QtEncodeOptions& options, std::vector<unsigned char>& out,
+                                            QuadTree* tree) {
+    QuadTree& target = tree ? *tree : scratchTree;
+    QtStatus status = buildLoadedImage(options, target, true);
+    if (status != QT_OK) return status;
+
+    ImageWriteOptions writeOptions;
+    writeOptions.pngLevel = options.pngLevel;
+    writeOptions.jpgQuality = options.jpgQuality;
+    writeOptions.threads = options.threads;
+    auto encodeStart = std::chrono::steady_clock::now();
+    if (!encodeQuadtreeImage(options.format, target, out, writeOptions)) {
+        return QT_ERR_ENCODE;
+    }
+    lastReport.encodeMillis = millisSince(encodeStart);
+    lastReport.totalMillis = millisSince(callStart);
+    lastReport.deadlineMet = options.deadlineMillis <= 0 || lastReport.totalMillis <= options.deadlineMillis;
+
+    // kalibrasi perkiraan encode untuk pemanggilan berikutnya
+    EncodeCostEstimate cost = estimateEncodeCost(options.format, target.getWidth(), target.getHeight(), writeOptions);
+    // indeks daun terukur di buildMillis, bukan encodeMillis
+    double predicted = cost.millisFixed + (cost.millisPerLeaf - cost.millisPerLeafIndex) * lastReport.leaves;
+    if (predicted > 1.0) {
+        double ratio = std::max(0.25, std::min(lastReport.encodeMillis / predicted, 8.0));
+        encodeCostScale = 0.5 * encodeCostScale + 0.5 * ratio;
+    }
+    calibrateDeadline();
+    return QT_OK;
+}
+
+QtStatus QuadtreeEncoder::buildTree(const unsigned char* pixels, int width, int height, int channels,
+                                    const QtEncodeOptions& options, QuadTree& tree) {
+    callStart = std::chrono::steady_clock::now();
+    QtStatus status = validate(pixels, width, height, channels, options);
+    if (status != QT_OK) return status;
+
+    pixelsToImage(pixels, width, height, channels, image);
+    return buildLoadedImage(options, tree, false);
+}
+
+QtStatus QuadtreeEncoder::encode(const unsigned char* pixels, int width, int height, int channels,
+                                 const QtEncodeOptions& options, std::vector<unsigned char>& out,
+                                 QuadTree* tree) {
+    callStart = std::chrono::steady_clock::now();
+    if (!isSupportedImageFormat(options.format)) return QT_ERR_UNSUPPORTED_FORMAT;
+
+    QtStatus status = validate(pixels, width, height, channels, options);
+    if (status != QT_OK) return status;
+
+    pixelsToImage(pixels, width, height, channels, image);
+    return encodeLoadedImage(options, out, tree);
+}
+
+QtStatus QuadtreeEncoder::encodeFromMemory(const unsigned char* input, size_t inputSize,
+                                           const QtEncodeOptions& options, std::vector<unsigned char>& out,
+                                           QuadTree* tree) {
+    callStart = std::chrono::steady_clock::now();
+    if (!isSupportedImageFormat(options.format)) return QT_ERR_UNSUPPORTED_FORMAT;
+
+    QtEncodeOptions effective = options;
+    if (effective.originalSize == 0) effective.originalSize = inputSize;
+
+    QtStatus status = qtValidateOptions(effective);
+    if (status != QT_OK) return status;
+
+    int width, height;
+    if (!readImageFromMemory(input, inputSize, image, width, height)) return QT_ERR_DECODE;
+    return encodeLoadedImage(effective, out, tree);
+}
@@ -0,0 +1,79 @@
+#include "header/gifwriter.h"
+
+namespace {
+
+// output file ditulis per blok sebesar ini
+const size_t kFlushBytes = 1 << 20;
+
+}
+
+GifEncoder::~GifEncoder() {
+    if (active) finish();
+    GifBufferFree(&out);
+}
+
+bool GifEncoder::open(const std::string& path, int width, int height, int delay) {
+    if (active) finish();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) return false;
+    return begin(width, height, delay);
+}
+
+bool GifEncoder::openMemory(int width, int height, int delay) {
+    if (active) finish();
+    return begin(width, height, delay);
+}
+
+bool GifEncoder::begin(int width, int height, int delay) {
+    // ukuran kanvas GIF 16-bit
+    if (width <= 0 || height <= 0 || width > 65535 || height > 65535 || delay < 0) {
+        if (file) std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    this->width = width;
+    this->height = height;
+    out.size = 0;
+    out.failed = false;
+    frameState.resize((size_t)width * height * 4);
+    if (!dict) {
+        dict.reset(new GifLzwDict);
+        GifLzwInit(dict.get());
+    }
+    firstFrame = true;
+    ok = true;
+    active = true;
+
+    GifWriteHeader(&out, width, height, delay);
+    return !out.failed;
+}
+
+bool GifEncoder::writeFrame(const uint8_t* rgba, int delay) {
+    if (!active || !rgba) return false;
+
+    GifWriteFrameToBuffer(&out, frameState.data(), firstFrame, rgba, width, height, delay, 8, false, dict.get());
+    firstFrame = false;
+    flush(kFlushBytes);
+    return ok && !out.failed;
+}
+
+void GifEncoder::flush(size_t minBytes) {
+    if (!file || out.size < minBytes) return;
+    if (out.failed || std::fwrite(out.data, 1, out.size, file) != out.size) ok = false;
+    out.size = 0;
+}
+
+bool GifEncoder::finish() {
+    if (!active) return false;
+    active = false;
+
+    GifWriteTrailer(&out);
+    ok = ok && !out.failed;
+    if (file) {
+        flush(0);
+        if (std::fclose(file) != 0) ok = false;
+        file = nullptr;
+    }
+    return ok;
+}
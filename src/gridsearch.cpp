@@ -0,0 +1,93 @@
+#include "header/gridsearch.h"
+#include "header/metric.h"
+#include "header/threadpool.h"
+#include <algorithm>
+#include <chrono>
+#include <memory>
+
+namespace {
+
+double msSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+}
+
+GridSearchReport runGridSearch(const std::vector<std::vector<Color>>& image, const GridSearchOptions& options) {
+    GridSearchReport report;
+    if (image.empty() || image[0].empty() || options.methods.empty() || options.thresholds.empty() ||
+        options.minBlockSizes.empty()) {
+        report.status = QT_ERR_INVALID_ARGUMENT;
+        return report;
+    }
+    for (int minBlockSize : options.minBlockSizes) {
+        if (minBlockSize < 1) {
+            report.status = QT_ERR_INVALID_ARGUMENT;
+            return report;
+        }
+    }
+
+    // tree terhalus per metode dari threshold yang valid untuk metode itu
+    // (metode yang diulang di input memakai tree yang sama)
+    std::vector<int> methods;
+    std::vector<QuadTreeConfig> configs;
+    int minBlockSize = *std::min_element(options.minBlockSizes.begin(), options.minBlockSizes.end());
+    for (int method : options.methods) {
+        for (double threshold : options.thresholds) {
+            QtEncodeOptions check;
+            check.errorMethod = method;
+            check.threshold = threshold;
+            if (qtValidateOptions(check) != QT_OK) continue;
+            for (int blockSize : options.minBlockSizes) {
+                GridSearchResult result;
+                result.errorMethod = method;
+                result.threshold = threshold;
+                result.minBlockSize = blockSize;
+                report.results.push_back(result);
+            }
+
+            size_t at = std::find(methods.begin(), methods.end(), method) - methods.begin();
+            if (at == methods.size()) {
+                methods.push_back(method);
+                configs.push_back({method, threshold, minBlockSize});
+            } else if (withMetric(method, [](auto metric) { return decltype(metric)::higherIsBetter; })
+                           ? threshold > configs[at].threshold
+                           : threshold < configs[at].threshold) {
+                configs[at].threshold = threshold;
+            }
+        }
+    }
+    if (report.results.empty()) {
+        report.status = QT_ERR_INVALID_ARGUMENT;
+        return report;
+    }
+
+    std::vector<std::unique_ptr<QuadTree>> finest;
+    std::vector<QuadTree*> trees;
+    for (size_t i = 0; i < configs.size(); i++) {
+        finest.emplace_back(new QuadTree());
+        trees.push_back(finest.back().get());
+    }
+    auto start = std::chrono::steady_clock::now();
+    QuadTree::buildMulti(image, configs, trees);
+    report.sharedBuildMillis = msSince(start);
+    for (QuadTree* tree : trees) report.sharedNodes += tree->getTotalNodes();
+
+    int threads = options.threads <= 0 ? ThreadPool::global().size() : options.threads;
+    ThreadPool::global().parallelFor(report.results.size(), [&](size_t i) {
+        GridSearchResult& result = report.results[i];
+        size_t source = std::find(methods.begin(), methods.end(), result.errorMethod) - methods.begin();
+        auto begin = std::chrono::steady_clock::now();
+        QuadTree tree;
+        tree.buildfrTree(*trees[source], result.errorMethod, result.threshold, result.minBlockSize);
+        result.totalNodes = tree.getTotalNodes();
+        result.leaves = tree.getLeafCount();
+        result.maxDepth = tree.getMaxDepth();
+        result.estimatedSize = (size_t)tree.hitungCompressedSize();
+        // satu thread per kombinasi, paralelisme sudah di level kombinasi
+        result.psnr = hitungPSNR(image, tree);
+        result.ssim = hitungImageSSIM(image, tree, options.ssimWindow, 1).ssim;
+        result.millis = msSince(begin);
+    }, threads);
+    return report;
+}
@@ -0,0 +1,101 @@
+#ifndef DEFLATE_H
+#define DEFLATE_H
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+uint32_t adler32Update(uint32_t adler, const unsigned char* data, size_t size);
+// adler32 dari gabungan A + B, diketahui adler A, adler B, dan panjang B
+uint32_t adler32Combine(uint32_t adlerA, uint32_t adlerB, size_t sizeB);
+uint32_t crc32Update(uint32_t crc, const unsigned char* data, size_t size);
+// byte FLG header zlib untuk level (di-clamp ke 0-9), habis dibagi 31 bersama CMF 0x78
+unsigned char zlibLevelFlag(int level);
+
+enum DeflateFormat {
+    DEFLATE_ZLIB,   // header + adler32 (RFC 1950)
+    DEFLATE_RAW     // blok deflate saja, untuk potongan stream paralel
+};
+
+// Encoder deflate (RFC 1951) streaming dengan tabel Huffman dinamis.
+//   level 0   : blok stored
+//   level 1   : matcher run-length (jarak 1), paling cepat; cocok untuk data
+//               PNG hasil filter gambar quadtree yang didominasi byte nol
+//   level 2-9 : LZ77 hash chain, makin tinggi makin panjang pencariannya
+//               (lazy matching mulai level 5)
+// Hasil ditambahkan ke akhir buffer out.
+class DeflateEncoder {
+public:
+    explicit DeflateEncoder(std::vector<unsigned char>& out, int level = 1, DeflateFormat format = DEFLATE_ZLIB);
+
+    DeflateEncoder(const DeflateEncoder&) = delete;
+    DeflateEncoder& operator=(const DeflateEncoder&) = delete;
+
+    // data sebelum potongan ini (maks 32 KB terakhir yang dipakai), dipanggil
+    // sebelum write pertama; match boleh merujuk ke sini
+    void setDictionary(const unsigned char* data, size_t size);
+
+    void write(const unsigned char* data, size_t size);
+    // sama dengan write() untuk count byte bernilai value, tanpa buffer perantara
+    void writeRun(unsigned char value, size_t count);
+
+    // akhiri blok berjalan lalu sisipkan blok stored kosong sehingga output
+    // berhenti di batas byte (sync flush); stream belum ditutup
+    void flushSync();
+    // tutup blok terakhir; untuk DEFLATE_ZLIB tulis juga checksum adler32
+    void finish();
+
+private:
+    void pushByte(unsigned char value);
+    void flushRun();
+    void emitLiteral(unsigned char value);
+    void emitMatch(int length, int distance);
+    void flushBlock(bool final);
+    void writeStored(const unsigned char* data, size_t size, bool final);
+
+    void appendWindow(const unsigned char* data, size_t size);
+    void compressWindow(bool flushAll);
+    void insertHash(size_t pos);
+    int findMatch(size_t pos, size_t avail, int& distance) const;
+    void slideWindow();
+
+    void putBits(uint32_t bits, int count);
+    void alignToByte();
+
+    std::vector<unsigned char>& out;
+    int level;
+    DeflateFormat format;
+    uint64_t bitBuffer = 0;
+    int bitCount = 0;
+
+    std::vector<uint16_t> tokenLitLen;   // literal (0-255) atau panjang match
+    std::vector<uint16_t> tokenDist;     // 0 = literal
+    uint32_t litLenFreq[286];
+    uint32_t distFreq[30];
+
+    // level 1
+    int prevByte = -1;
+    size_t runLength = 0;
+
+    // level 0 dan 2-9: data dikumpulkan dulu di window
+    std::vector<unsigned char> window;
+    size_t processed = 0;
+    std::vector<int32_t> head;
+    std::vector<int32_t> prev;
+    int maxChain = 0;
+    int niceLength = 0;
+    bool lazy = false;
+    bool matchAvailable = false;
+    int prevLength = 0;
+    int prevDistance = 0;
+
+    uint32_t adler = 1;
+    bool finished = false;
+};
+
+// Kompres satu buffer menjadi stream zlib. threads > 1 memecah input menjadi
+// potongan yang dikompres paralel (masing-masing memakai 32 KB sebelumnya
+// sebagai dictionary) lalu disambung; 0 = semua thread pool global.
+void deflateCompress(const unsigned char* data, size_t size, int level, std::vector<unsigned char>& out, int threads = 1);
+
+#endif
@@ -0,0 +1,119 @@
+#ifndef ENCODER_H
+#define ENCODER_H
+
+#include "quadtree.h"
+#include <chrono>
+#include <vector>
+#include <string>
+
+// Kode status API library, pengganti pesan ke console
+enum QtStatus {
+    QT_OK = 0,
+    QT_ERR_INVALID_ARGUMENT,
+    QT_ERR_UNSUPPORTED_FORMAT,
+    QT_ERR_DECODE,
+    QT_ERR_ENCODE
+};
+
+const char* qtStatusMessage(QtStatus status);
+const char* qtBuildStopMessage(QtBuildStop stop);
+
+struct QtEncodeOptions {
+    int errorMethod = 1;            // 1 Variance, 2 MAD, 3 MPD, 4 Entropy, 5 SSIM, 6 SSIM blok
+    double threshold = 100.0;
+    int minBlockSize = 4;
+    double targetCompression = 0.0; // 0 = nonaktif, selain itu threshold dicari otomatis
+    size_t originalSize = 0;        // ukuran file asli (byte), wajib jika targetCompression aktif
+    QuadTreeQualityTarget targetQuality;    // jika aktif, threshold dicari sampai PSNR/SSIM minimum tercapai
+    std::string format = "png";     // png, jpg, jpeg, bmp, tga
+    int jpgQuality = 90;
+    int pngLevel = 1;               // level deflate PNG 0-9
+    int threads = 1;                // thread untuk encode output, 0 = semua core
+    QuadTreeBudget budget;          // jika dibatasi, tree dibangun best-first sampai budget habis
+    double deadlineMillis = 0.0;    // 0 = nonaktif; batas waktu seluruh pemanggilan (decode, build, encode)
+    QuadTreeSampling sampling;      // mode metrik aproksimasi; diabaikan jika budget/deadline/targetQuality aktif
+};
+
+// Ringkasan pemanggilan terakhir: sejauh mana tree dipecah dan waktu tiap tahap
+struct QtEncodeReport {
+    QtBuildStop buildStop = QT_STOP_CONVERGED;
+    int maxDepth = 0;
+    int leaves = 0;
+    double residualError = 0.0;     // rata-rata error daun dibobot luas (SSIM: kemiripan)
+    double buildMillis = 0.0;
+    double encodeMillis = 0.0;
+    double totalMillis = 0.0;
+    bool deadlineMet = true;        // selalu true jika deadlineMillis 0
+    double quality = 0.0;           // PSNR/SSIM blok tree, hanya jika targetQuality aktif
+    bool qualityReached = true;     // false = target kualitas tidak tercapai meski tree terhalus
+    QuadTreeScanStats scanStats;
+};
+
+// cek rentang metode, threshold, ukuran blok, target kompresi/kualitas, kualitas jpg, budget dan sampling
+QtStatus qtValidateOptions(const QtEncodeOptions& options);
+
+// Budget build untuk mode deadline: sisa waktu (deadlineMillis - elapsedMillis)
+// dikurangi marginMillis dan perkiraan waktu encode options.format dikali
+// encodeCostScale, dan waktu encode per daun ikut dicadangkan. marginMillis < 0 =
+// 10% sisa waktu (belum ada kalibrasi). Pemecahan best-first dibobot luas
+// (kasar ke halus); batas lain di options.budget tetap berlaku.
+QuadTreeBudget qtDeadlineBudget(const QtEncodeOptions& options, int width, int height,
+                                double elapsedMillis, double encodeCostScale = 1.0,
+                                double marginMillis = -1.0);
+
+// Encoder yang dibuat sekali lalu dipakai ulang; buffer kerja (gambar,
+// hasil rekonstruksi, buffer RGB) disimpan antar pemanggilan.
+// Satu objek tidak aman dipakai dari beberapa thread sekaligus.
+class QuadtreeEncoder {
+public:
+    QuadtreeEncoder() = default;
+
+    // bangun quadtree dari buffer piksel interleaved (1-4 channel)
+    QtStatus buildTree(const unsigned char* pixels, int width, int height, int channels,
+                       const QtEncodeOptions& options, QuadTree& tree);
+
+    // bangun quadtree lalu encode hasil rekonstruksinya ke out.
+    // tree opsional: jika diisi, quadtree hasil build disimpan di sana.
+    QtStatus encode(const unsigned char* pixels, int width, int height, int channels,
+                    const QtEncodeOptions& options, std::vector<unsigned char>& out,
+                    QuadTree* tree = nullptr);
+
+    // sama seperti encode, tetapi input berupa file gambar terkompresi (png, jpg, ...)
+    // yang sudah ada di memori. Jika options.originalSize 0, ukuran input dipakai.
+    QtStatus encodeFromMemory(const unsigned char* input, size_t inputSize,
+                              const QtEncodeOptions& options, std::vector<unsigned char>& out,
+                              QuadTree* tree = nullptr);
+
+    // threshold yang benar-benar dipakai pada pemanggilan terakhir
+    double getLastThreshold() const { return lastThreshold; }
+    // alasan build terakhir berhenti (budget atau konvergen)
+    QtBuildStop getLastBuildStop() const { return lastReport.buildStop; }
+    const QtEncodeReport& getLastReport() const { return lastReport; }
+
+private:
+    QtStatus validate(const unsigned char* pixels, int width, int height, int channels,
+                      const QtEncodeOptions& options) const;
+
+    // build dari this->image yang sudah terisi; withEncode = waktu encode dicadangkan dari deadline
+    QtStatus buildLoadedImage(const QtEncodeOptions& options, QuadTree& tree, bool withEncode);
+    QtStatus encodeLoadedImage(const QtEncodeOptions& options, std::vector<unsigned char>& out, QuadTree* tree);
+
+    std::vector<std::vector<Color>> image;
+    QuadTree scratchTree;
+    double lastThreshold = 0.0;
+    QtEncodeReport lastReport;
+    std::chrono::steady_clock::time_point callStart;
+    // rasio waktu encode sebenarnya / perkiraan, dikalibrasi tiap encode
+    double encodeCostScale = 1.0;
+    // margin deadline terkalibrasi: rata-rata dan simpangan bergerak dari selisih
+    // waktu selesai sebenarnya dengan rencana budget (ms), hanya dari build yang
+    // berhenti karena waktu
+    double deadlineMargin() const;
+    void calibrateDeadline();
+    double deadlinePlannedMillis = 0.0;     // rencana selesai pemanggilan terakhir, 0 = tidak ada
+    double deadlineErrorMean = 0.0;
+    double deadlineErrorDev = 0.0;
+    int deadlineSamples = 0;
+};
+
+#endif
@@ -25,6 +25,10 @@
 // Pass subsequent frames to GifWriteFrame().
 // Finally, call GifEnd() to close the file handle and free memory.
 //
+// Local change: all output goes through a growable GifBuffer instead of one fputc per
+// byte. GifWriter flushes the buffer to its file once per frame; GifWriteHeader,
+// GifWriteFrameToBuffer and GifWriteTrailer can be used directly to write to memory.
+//
 
 #ifndef gif_h
 #define gif_h
@@ -60,6 +64,11 @@
 #define GIF_FREE free
 #endif
 
+#ifndef GIF_REALLOC
+#include <stdlib.h>
+#define GIF_REALLOC realloc
+#endif
+
 const int kGifTransIndex = 0;
 
 typedef struct
@@ -77,7 +86,102 @@ typedef struct
     uint8_t treeSplit[256];
 } GifPalette;
 
+// Growable output buffer (allocated with GIF_REALLOC, freed with GIF_FREE).
+// failed is set if an allocation fails; later writes are then dropped.
+typedef struct
+{
+    uint8_t* data;
+    size_t size;
+    size_t capacity;
+    bool failed;
+
+    uint8_t padding[7];    // make padding explicit
+} GifBuffer;
+
+// LZW dictionary: open-addressing hash from (prefix code, next index) to code.
+// Entries carry the generation they were inserted in, so clearing the dictionary
+// is a counter increment instead of a memset. Strings extended by their own last
+// index (runs of one palette index) live in a direct per-code table instead.
+// Initialize once with GifLzwInit; it can be reused for any number of frames.
+#define GIF_LZW_HASH_BITS 13
+typedef struct
+{
+    uint32_t stamp[1 << GIF_LZW_HASH_BITS];
+    uint32_t entry[1 << GIF_LZW_HASH_BITS];   // (prefix << 8 | index) << 12 | code
+    uint32_t runStamp[4096];
+    uint16_t runCode[4096];                   // code of "c followed by lastIndex[c]"
+    uint8_t lastIndex[4096];                  // last palette index of the string of code c
+    uint32_t generation;
+} GifLzwDict;
+
+typedef struct
+{
+    FILE* f;
+    uint8_t* oldImage;
+    bool firstFrame;
+
+    uint8_t padding[7];    // make padding explicit
+    GifBuffer out;
+    GifLzwDict* dict;
+} GifWriter;
+
+bool GifBegin( GifWriter* writer, const char* filename, uint32_t width, uint32_t height, uint32_t delay, int32_t bitDepth = 8, bool dither = false );
+bool GifWriteFrame( GifWriter* writer, const uint8_t* image, uint32_t width, uint32_t height, uint32_t delay, int bitDepth = 8, bool dither = false );
+bool GifEnd( GifWriter* writer );
+
+void GifLzwInit( GifLzwDict* dict );
+
+void GifBufferPut( GifBuffer* buf, uint8_t byte );
+void GifBufferWrite( GifBuffer* buf, const void* data, size_t size );
+void GifBufferFree( GifBuffer* buf );
+
+// Lower-level pieces used by GifBegin/GifWriteFrame/GifEnd, writing to a buffer.
+// frameState must hold width*height*4 bytes and is carried from frame to frame
+// (it is the previous frame for delta encoding); firstFrame ignores its contents.
+void GifWriteHeader( GifBuffer* out, uint32_t width, uint32_t height, uint32_t delay );
+// dict may be NULL, in which case a temporary dictionary is allocated for the frame.
+void GifWriteFrameToBuffer( GifBuffer* out, uint8_t* frameState, bool firstFrame, const uint8_t* image, uint32_t width, uint32_t height, uint32_t delay, int bitDepth = 8, bool dither = false, GifLzwDict* dict = NULL );
+void GifWriteTrailer( GifBuffer* out );
+
+// Define GIF_IMPL in exactly one translation unit to get the implementation.
+#ifdef GIF_IMPL
+
 // max, min, and abs functions
+void GifBufferReserve( GifBuffer* buf, size_t extra )
+{
+    if( buf->size + extra <= buf->capacity ) return;
+    size_t capacity = buf->capacity? buf->capacity : 4096;
+    while( capacity < buf->size + extra ) capacity *= 2;
+    uint8_t* data = (uint8_t*)GIF_REALLOC(buf->data, capacity);
+    if( !data ) { buf->failed = true; return; }
+    buf->data = data;
+    buf->capacity = capacity;
+}
+
+void GifBufferPut( GifBuffer* buf, uint8_t byte )
+{
+    if( buf->size == buf->capacity ) GifBufferReserve(buf, 1);
+    if( buf->failed ) return;
+    buf->data[buf->size++] = byte;
+}
+
+void GifBufferWrite( GifBuffer* buf, const void* data, size_t size )
+{
+    GifBufferReserve(buf, size);
+    if( buf->failed ) return;
+    memcpy(buf->data + buf->size, data, size);
+    buf->size += size;
+}
+
+void GifBufferFree( GifBuffer* buf )
+{
+    GIF_FREE(buf->data);
+    buf->data = NULL;
+    buf->size = 0;
+    buf->capacity = 0;
+    buf->failed = false;
+}
+
 int GifIMax(int l, int r) { return l>r?l:r; }
 int GifIMin(int l, int r) { return l<r?l:r; }
 int GifIAbs(int i) { return i<0?-i:i; }
@@ -550,75 +654,103 @@ void GifThresholdImage( const uint8_t* lastFrame, const uint8_t* nextFrame, uint
     }
 }
 
-// Simple structure to write out the LZW-compressed portion of the image
-// one bit at a time
+// Packs LZW codes LSB-first into a 64-bit accumulator and moves whole bytes into
+// 255-byte sub-blocks
 typedef struct
 {
+    uint64_t bits;        // pending bits, LSB first
+    uint32_t bitCount;    // number of pending bits (< 8 between calls)
     uint32_t chunkIndex;
-    uint8_t chunk[256];   // bytes are written in here until we have 256 of them, then written to the file
-
-    uint8_t bitIndex;  // how many bits in the partial byte written so far
-    uint8_t byte;      // current partial byte
-
-    uint8_t padding[2];    // make padding explicit
+    uint8_t chunk[256];   // bytes are written in here until we have 255 of them, then written to the output
 } GifBitStatus;
 
-// insert a single bit
-void GifWriteBit( GifBitStatus* stat, uint32_t bit )
+// write all bytes so far to the output
+void GifWriteChunk( GifBuffer* out, GifBitStatus* stat )
 {
-    bit = bit & 1;
-    bit = bit << stat->bitIndex;
-    stat->byte |= bit;
+    GifBufferPut(out, (uint8_t)stat->chunkIndex);
+    GifBufferWrite(out, stat->chunk, stat->chunkIndex);
+
+    stat->chunkIndex = 0;
+}
 
-    ++stat->bitIndex;
-    if( stat->bitIndex > 7 )
+void GifWriteCode( GifBuffer* out, GifBitStatus* stat, uint32_t code, uint32_t length )
+{
+    stat->bits |= (uint64_t)(code & ((1u << length) - 1)) << stat->bitCount;
+    stat->bitCount += length;
+    while( stat->bitCount >= 8 )
     {
-        // move the newly-finished byte to the chunk buffer
-        stat->chunk[stat->chunkIndex++] = stat->byte;
-        // and start a new byte
-        stat->bitIndex = 0;
-        stat->byte = 0;
+        stat->chunk[stat->chunkIndex++] = (uint8_t)stat->bits;
+        stat->bits >>= 8;
+        stat->bitCount -= 8;
+
+        if( stat->chunkIndex == 255 )
+        {
+            GifWriteChunk(out, stat);
+        }
     }
 }
 
-// write all bytes so far to the file
-void GifWriteChunk( FILE* f, GifBitStatus* stat )
+void GifLzwInit( GifLzwDict* dict )
 {
-    fputc((int)stat->chunkIndex, f);
-    fwrite(stat->chunk, 1, stat->chunkIndex, f);
-
-    stat->bitIndex = 0;
-    stat->byte = 0;
-    stat->chunkIndex = 0;
+    memset(dict, 0, sizeof(*dict));
+    dict->generation = 1;
+    for( int ii=0; ii<256; ++ii ) dict->lastIndex[ii] = (uint8_t)ii;
 }
 
-void GifWriteCode( FILE* f, GifBitStatus* stat, uint32_t code, uint32_t length )
+// forget all codes; stamps only need a real clear when the counter wraps
+void GifLzwClear( GifLzwDict* dict )
 {
-    for( uint32_t ii=0; ii<length; ++ii )
+    if( ++dict->generation == 0 )
     {
-        GifWriteBit(stat, code);
-        code = code >> 1;
+        memset(dict->stamp, 0, sizeof(dict->stamp));
+        memset(dict->runStamp, 0, sizeof(dict->runStamp));
+        dict->generation = 1;
+    }
+}
 
-        if( stat->chunkIndex == 255 )
-        {
-            GifWriteChunk(f, stat);
-        }
+uint32_t GifLzwSlot( uint32_t key )
+{
+    return (key * 2654435761u) >> (32 - GIF_LZW_HASH_BITS);
+}
+
+// code for string(prefix) + index, or -1 if it is not in the dictionary
+int32_t GifLzwFind( const GifLzwDict* dict, uint32_t prefix, uint32_t index )
+{
+    if( dict->lastIndex[prefix] == index )
+        return dict->runStamp[prefix] == dict->generation? dict->runCode[prefix] : -1;
+
+    const uint32_t key = prefix << 8 | index;
+    for( uint32_t slot = GifLzwSlot(key); ; slot = (slot + 1) & ((1 << GIF_LZW_HASH_BITS) - 1) )
+    {
+        if( dict->stamp[slot] != dict->generation ) return -1;
+        if( (dict->entry[slot] >> 12) == key ) return (int32_t)(dict->entry[slot] & 0xfff);
     }
 }
 
-// The LZW dictionary is a 256-ary tree constructed as the file is encoded,
-// this is one node
-typedef struct
+void GifLzwInsert( GifLzwDict* dict, uint32_t prefix, uint32_t index, uint32_t code )
 {
-    uint16_t m_next[256];
-} GifLzwNode;
+    dict->lastIndex[code] = (uint8_t)index;
+    if( dict->lastIndex[prefix] == index )
+    {
+        dict->runStamp[prefix] = dict->generation;
+        dict->runCode[prefix] = (uint16_t)code;
+        return;
+    }
+
+    // at most 4096 codes in 8192 slots, so a free slot always exists
+    const uint32_t key = prefix << 8 | index;
+    uint32_t slot = GifLzwSlot(key);
+    while( dict->stamp[slot] == dict->generation ) slot = (slot + 1) & ((1 << GIF_LZW_HASH_BITS) - 1);
+    dict->stamp[slot] = dict->generation;
+    dict->entry[slot] = key << 12 | code;
+}
 
 // write a 256-color (8-bit) image palette to the file
-void GifWritePalette( const GifPalette* pPal, FILE* f )
+void GifWritePalette( const GifPalette* pPal, GifBuffer* out )
 {
-    fputc(0, f);  // first color: transparency
-    fputc(0, f);
-    fputc(0, f);
+    GifBufferPut(out, (uint8_t)(0));  // first color: transparency
+    GifBufferPut(out, (uint8_t)(0));
+    GifBufferPut(out, (uint8_t)(0));
 
     for(int ii=1; ii<(1 << pPal->bitDepth); ++ii)
     {
@@ -626,95 +758,107 @@ void GifWritePalette( const GifPalette* pPal, FILE* f )
         uint32_t g = pPal->g[ii];
         uint32_t b = pPal->b[ii];
 
-        fputc((int)r, f);
-        fputc((int)g, f);
-        fputc((int)b, f);
+        GifBufferPut(out, (uint8_t)((int)r));
+        GifBufferPut(out, (uint8_t)((int)g));
+        GifBufferPut(out, (uint8_t)((int)b));
     }
 }
 
 // write the image header, LZW-compress and write out the image
-void GifWriteLzwImage(FILE* f, uint8_t* image, uint32_t left, uint32_t top,  uint32_t width, uint32_t height, uint32_t delay, GifPalette* pPal)
+void GifWriteLzwImage(GifBuffer* out, uint8_t* image, uint32_t left, uint32_t top,  uint32_t width, uint32_t height, uint32_t delay, GifPalette* pPal, GifLzwDict* dict)
 {
     // graphics control extension
-    fputc(0x21, f);
-    fputc(0xf9, f);
-    fputc(0x04, f);
-    fputc(0x05, f); // leave prev frame in place, this frame has transparency
-    fputc(delay & 0xff, f);
-    fputc((delay >> 8) & 0xff, f);
-    fputc(kGifTransIndex, f); // transparent color index
-    fputc(0, f);
+    GifBufferPut(out, (uint8_t)(0x21));
+    GifBufferPut(out, (uint8_t)(0xf9));
+    GifBufferPut(out, (uint8_t)(0x04));
+    GifBufferPut(out, (uint8_t)(0x05)); // leave prev frame in place, this frame has transparency
+    GifBufferPut(out, (uint8_t)(delay & 0xff));
+    GifBufferPut(out, (uint8_t)((delay >> 8) & 0xff));
+    GifBufferPut(out, (uint8_t)(kGifTransIndex)); // transparent color index
+    GifBufferPut(out, (uint8_t)(0));
 
-    fputc(0x2c, f); // image descriptor block
+    GifBufferPut(out, (uint8_t)(0x2c)); // image descriptor block
 
-    fputc(left & 0xff, f);           // corner of image in canvas space
-    fputc((left >> 8) & 0xff, f);
-    fputc(top & 0xff, f);
-    fputc((top >> 8) & 0xff, f);
+    GifBufferPut(out, (uint8_t)(left & 0xff));           // corner of image in canvas space
+    GifBufferPut(out, (uint8_t)((left >> 8) & 0xff));
+    GifBufferPut(out, (uint8_t)(top & 0xff));
+    GifBufferPut(out, (uint8_t)((top >> 8) & 0xff));
 
-    fputc(width & 0xff, f);          // width and height of image
-    fputc((width >> 8) & 0xff, f);
-    fputc(height & 0xff, f);
-    fputc((height >> 8) & 0xff, f);
+    GifBufferPut(out, (uint8_t)(width & 0xff));          // width and height of image
+    GifBufferPut(out, (uint8_t)((width >> 8) & 0xff));
+    GifBufferPut(out, (uint8_t)(height & 0xff));
+    GifBufferPut(out, (uint8_t)((height >> 8) & 0xff));
 
-    //fputc(0, f); // no local color table, no transparency
-    //fputc(0x80, f); // no local color table, but transparency
+    //GifBufferPut(out, (uint8_t)(0)); // no local color table, no transparency
+    //GifBufferPut(out, (uint8_t)(0x80)); // no local color table, but transparency
 
-    fputc(0x80 + pPal->bitDepth-1, f); // local color table present, 2 ^ bitDepth entries
-    GifWritePalette(pPal, f);
+    GifBufferPut(out, (uint8_t)(0x80 + pPal->bitDepth-1)); // local color table present, 2 ^ bitDepth entries
+    GifWritePalette(pPal, out);
 
     const int minCodeSize = pPal->bitDepth;
     const uint32_t clearCode = 1 << pPal->bitDepth;
 
-    fputc(minCodeSize, f); // min code size 8 bits
+    GifBufferPut(out, (uint8_t)(minCodeSize)); // min code size 8 bits
 
-    GifLzwNode* codetree = (GifLzwNode*)GIF_TEMP_MALLOC(sizeof(GifLzwNode)*4096);
+    GifLzwDict* tempDict = NULL;
+    if( !dict )
+    {
+        tempDict = (GifLzwDict*)GIF_TEMP_MALLOC(sizeof(GifLzwDict));
+        GifLzwInit(tempDict);
+        dict = tempDict;
+    }
+    GifLzwClear(dict);
 
-    memset(codetree, 0, sizeof(GifLzwNode)*4096);
     int32_t curCode = -1;
     uint32_t codeSize = (uint32_t)minCodeSize + 1;
     uint32_t maxCode = clearCode+1;
 
     GifBitStatus stat;
-    stat.byte = 0;
-    stat.bitIndex = 0;
+    stat.bits = 0;
+    stat.bitCount = 0;
     stat.chunkIndex = 0;
 
-    GifWriteCode(f, &stat, clearCode, codeSize);  // start with a fresh LZW dictionary
+    GifWriteCode(out, &stat, clearCode, codeSize);  // start with a fresh LZW dictionary
 
     for(uint32_t yy=0; yy<height; ++yy)
     {
-        for(uint32_t xx=0; xx<width; ++xx)
-        {
     #ifdef GIF_FLIP_VERT
-            // bottom-left origin image (such as an OpenGL capture)
-            uint8_t nextValue = image[((height-1-yy)*width+xx)*4+3];
+        // bottom-left origin image (such as an OpenGL capture)
+        const uint8_t* row = image + (size_t)(height-1-yy)*width*4 + 3;
     #else
-            // top-left origin
-            uint8_t nextValue = image[(yy*width+xx)*4+3];
+        // top-left origin
+        const uint8_t* row = image + (size_t)yy*width*4 + 3;
     #endif
 
+        uint32_t xx = 0;
+        if( curCode < 0 )
+        {
+            // first value in a new run
+            curCode = row[0];
+            xx = 1;
+        }
+
+        for(; xx<width; ++xx)
+        {
+            uint32_t nextValue = row[xx*4];
+
             // "worst possible mode" - no compression, every single code is followed immediately by a clear
             //WriteCode( f, stat, nextValue, codeSize );
             //WriteCode( f, stat, 256, codeSize );
 
-            if( curCode < 0 )
-            {
-                // first value in a new run
-                curCode = nextValue;
-            }
-            else if( codetree[curCode].m_next[nextValue] )
+            int32_t nextCode = GifLzwFind(dict, (uint32_t)curCode, nextValue);
+            if( nextCode >= 0 )
             {
                 // current run already in the dictionary
-                curCode = codetree[curCode].m_next[nextValue];
+                curCode = nextCode;
             }
             else
             {
                 // finish the current run, write a code
-                GifWriteCode(f, &stat, (uint32_t)curCode, codeSize);
+                GifWriteCode(out, &stat, (uint32_t)curCode, codeSize);
 
                 // insert the new run into the dictionary
-                codetree[curCode].m_next[nextValue] = (uint16_t)++maxCode;
+                GifLzwInsert(dict, (uint32_t)curCode, nextValue, ++maxCode);
 
                 if( maxCode >= (1ul << codeSize) )
                 {
@@ -725,45 +869,107 @@ void GifWriteLzwImage(FILE* f, uint8_t* image, uint32_t left, uint32_t top,  uin
                 if( maxCode == 4095 )
                 {
                     // the dictionary is full, clear it out and begin anew
-                    GifWriteCode(f, &stat, clearCode, codeSize); // clear tree
+                    GifWriteCode(out, &stat, clearCode, codeSize); // clear tree
 
-                    memset(codetree, 0, sizeof(GifLzwNode)*4096);
+                    GifLzwClear(dict);
                     codeSize = (uint32_t)(minCodeSize + 1);
                     maxCode = clearCode+1;
                 }
 
-                curCode = nextValue;
+                curCode = (int32_t)nextValue;
             }
         }
     }
 
     // compression footer
-    GifWriteCode(f, &stat, (uint32_t)curCode, codeSize);
-    GifWriteCode(f, &stat, clearCode, codeSize);
-    GifWriteCode(f, &stat, clearCode + 1, (uint32_t)minCodeSize + 1);
+    GifWriteCode(out, &stat, (uint32_t)curCode, codeSize);
+    GifWriteCode(out, &stat, clearCode, codeSize);
+    GifWriteCode(out, &stat, clearCode + 1, (uint32_t)minCodeSize + 1);
 
     // write out the last partial chunk
-    while( stat.bitIndex ) GifWriteBit(&stat, 0);
-    if( stat.chunkIndex ) GifWriteChunk(f, &stat);
+    if( stat.bitCount ) stat.chunk[stat.chunkIndex++] = (uint8_t)stat.bits;
+    if( stat.chunkIndex ) GifWriteChunk(out, &stat);
 
-    fputc(0, f); // image block terminator
+    GifBufferPut(out, (uint8_t)(0)); // image block terminator
 
-    GIF_TEMP_FREE(codetree);
+    if( tempDict ) GIF_TEMP_FREE(tempDict);
 }
 
-typedef struct
+// Writes the GIF header, screen descriptor, dummy global palette and (if delay != 0)
+// the looping animation extension.
+void GifWriteHeader( GifBuffer* out, uint32_t width, uint32_t height, uint32_t delay )
 {
-    FILE* f;
-    uint8_t* oldImage;
-    bool firstFrame;
+    GifBufferWrite(out, "GIF89a", 6);
 
-    uint8_t padding[7];    // make padding explicit
-} GifWriter;
+    // screen descriptor
+    GifBufferPut(out, (uint8_t)(width & 0xff));
+    GifBufferPut(out, (uint8_t)((width >> 8) & 0xff));
+    GifBufferPut(out, (uint8_t)(height & 0xff));
+    GifBufferPut(out, (uint8_t)((height >> 8) & 0xff));
+
+    GifBufferPut(out, 0xf0);  // there is an unsorted global color table of 2 entries
+    GifBufferPut(out, 0);     // background color
+    GifBufferPut(out, 0);     // pixels are square (we need to specify this because it's 1989)
+
+    // now the "global" palette (really just a dummy palette)
+    // color 0: black, color 1: also black
+    static const uint8_t globalPalette[6] = {0, 0, 0, 0, 0, 0};
+    GifBufferWrite(out, globalPalette, sizeof(globalPalette));
+
+    if( delay != 0 )
+    {
+        // animation header
+        GifBufferPut(out, 0x21); // extension
+        GifBufferPut(out, 0xff); // application specific
+        GifBufferPut(out, 11); // length 11
+        GifBufferWrite(out, "NETSCAPE2.0", 11); // yes, really
+        GifBufferPut(out, 3); // 3 bytes of NETSCAPE2.0 data
+
+        GifBufferPut(out, 1); // this is the Netscape 2.0 sub-block ID and it must be 1, otherwise some viewers error
+        GifBufferPut(out, 0); // loop infinitely (byte 0)
+        GifBufferPut(out, 0); // loop infinitely (byte 1)
+
+        GifBufferPut(out, 0); // block terminator
+    }
+}
+
+void GifWriteFrameToBuffer( GifBuffer* out, uint8_t* frameState, bool firstFrame, const uint8_t* image, uint32_t width, uint32_t height, uint32_t delay, int bitDepth, bool dither, GifLzwDict* dict )
+{
+    const uint8_t* oldImage = firstFrame? NULL : frameState;
+
+    // unused palette entries would otherwise be stack garbage, making the output
+    // differ from run to run
+    GifPalette pal;
+    memset(&pal, 0, sizeof(pal));
+    GifMakePalette((dither? NULL : oldImage), image, width, height, bitDepth, dither, &pal);
+
+    if(dither)
+        GifDitherImage(oldImage, image, frameState, width, height, &pal);
+    else
+        GifThresholdImage(oldImage, image, frameState, width, height, &pal);
+
+    GifWriteLzwImage(out, frameState, 0, 0, width, height, delay, &pal, dict);
+}
+
+void GifWriteTrailer( GifBuffer* out )
+{
+    GifBufferPut(out, 0x3b); // end of file
+}
+
+// Writes buffered bytes to the file; false if the buffer or the write failed.
+bool GifFlush( GifWriter* writer )
+{
+    bool ok = !writer->out.failed;
+    if( ok && writer->out.size )
+        ok = fwrite(writer->out.data, 1, writer->out.size, writer->f) == writer->out.size;
+    writer->out.size = 0;
+    return ok;
+}
 
 // Creates a gif file.
 // The input GIFWriter is assumed to be uninitialized.
 // The delay value is the time between frames in hundredths of a second - note that not all viewers pay much attention to this value.
-bool GifBegin( GifWriter* writer, const char* filename, uint32_t width, uint32_t height, uint32_t delay, int32_t bitDepth = 8, bool dither = false )
+bool GifBegin( GifWriter* writer, const char* filename, uint32_t width, uint32_t height, uint32_t delay, int32_t bitDepth, bool dither )
 {
     (void)bitDepth; (void)dither; // Mute "Unused argument" warnings
 #if defined(_MSC_VER) && (_MSC_VER >= 1400)
@@ -775,73 +981,29 @@ bool GifBegin( GifWriter* writer, const char* filename, uint32_t width, uint32_t
     if(!writer->f) return false;
 
     writer->firstFrame = true;
+    memset(&writer->out, 0, sizeof(writer->out));
 
     // allocate
     writer->oldImage = (uint8_t*)GIF_MALLOC(width*height*4);
+    writer->dict = (GifLzwDict*)GIF_MALLOC(sizeof(GifLzwDict));
+    if( writer->dict ) GifLzwInit(writer->dict);
 
-    fputs("GIF89a", writer->f);
-
-    // screen descriptor
-    fputc(width & 0xff, writer->f);
-    fputc((width >> 8) & 0xff, writer->f);
-    fputc(height & 0xff, writer->f);
-    fputc((height >> 8) & 0xff, writer->f);
-
-    fputc(0xf0, writer->f);  // there is an unsorted global color table of 2 entries
-    fputc(0, writer->f);     // background color
-    fputc(0, writer->f);     // pixels are square (we need to specify this because it's 1989)
-
-    // now the "global" palette (really just a dummy palette)
-    // color 0: black
-    fputc(0, writer->f);
-    fputc(0, writer->f);
-    fputc(0, writer->f);
-    // color 1: also black
-    fputc(0, writer->f);
-    fputc(0, writer->f);
-    fputc(0, writer->f);
-
-    if( delay != 0 )
-    {
-        // animation header
-        fputc(0x21, writer->f); // extension
-        fputc(0xff, writer->f); // application specific
-        fputc(11, writer->f); // length 11
-        fputs("NETSCAPE2.0", writer->f); // yes, really
-        fputc(3, writer->f); // 3 bytes of NETSCAPE2.0 data
-
-        fputc(1, writer->f); // this is the Netscape 2.0 sub-block ID and it must be 1, otherwise some viewers error
-        fputc(0, writer->f); // loop infinitely (byte 0)
-        fputc(0, writer->f); // loop infinitely (byte 1)
-
-        fputc(0, writer->f); // block terminator
-    }
-
-    return true;
+    GifWriteHeader(&writer->out, width, height, delay);
+    return GifFlush(writer);
 }
 
 // Writes out a new frame to a GIF in progress.
 // The GIFWriter should have been created by GIFBegin.
 // AFAIK, it is legal to use different bit depths for different frames of an image -
 // this may be handy to save bits in animations that don't change much.
-bool GifWriteFrame( GifWriter* writer, const uint8_t* image, uint32_t width, uint32_t height, uint32_t delay, int bitDepth = 8, bool dither = false )
+bool GifWriteFrame( GifWriter* writer, const uint8_t* image, uint32_t width, uint32_t height, uint32_t delay, int bitDepth, bool dither )
 {
     if(!writer->f) return false;
 
-    const uint8_t* oldImage = writer->firstFrame? NULL : writer->oldImage;
+    GifWriteFrameToBuffer(&writer->out, writer->oldImage, writer->firstFrame, image, width, height, delay, bitDepth, dither, writer->dict);
     writer->firstFrame = false;
 
-    GifPalette pal;
-    GifMakePalette((dither? NULL : oldImage), image, width, height, bitDepth, dither, &pal);
-
-    if(dither)
-        GifDitherImage(oldImage, image, writer->oldImage, width, height, &pal);
-    else
-        GifThresholdImage(oldImage, image, writer->oldImage, width, height, &pal);
-
-    GifWriteLzwImage(writer->f, writer->oldImage, 0, 0, width, height, delay, &pal);
-
-    return true;
+    return GifFlush(writer);
 }
 
 // Writes the EOF code, closes the file handle, and frees temp memory used by a GIF.
@@ -851,14 +1013,20 @@ bool GifEnd( GifWriter* writer )
 {
     if(!writer->f) return false;
 
-    fputc(0x3b, writer->f); // end of file
-    fclose(writer->f);
+    GifWriteTrailer(&writer->out);
+    bool ok = GifFlush(writer);
+    ok = fclose(writer->f) == 0 && ok;
     GIF_FREE(writer->oldImage);
+    GIF_FREE(writer->dict);
+    GifBufferFree(&writer->out);
 
     writer->f = NULL;
     writer->oldImage = NULL;
+    writer->dict = NULL;
 
-    return true;
+    return ok;
 }
 
+#endif // GIF_IMPL
+
 #endif
\ No newline at end of file
@@ -0,0 +1,54 @@
+#ifndef GIFWRITER_H
+#define GIFWRITER_H
+
+#include "gif.h"
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Penulis GIF animasi RAII di atas gif.h. Output dikumpulkan di buffer dan
+// ditulis ke file per blok besar, atau disimpan di memori. Trailer GIF selalu
+// ditulis dan file selalu ditutup, paling lambat di destruktor. Buffer frame
+// sebelumnya (oldImage gif.h), kamus LZW, dan buffer output dipakai ulang
+// antar frame dan antar gambar, jadi satu objek bisa dipakai berulang kali
+// tanpa alokasi baru.
+class GifEncoder {
+public:
+    GifEncoder() = default;
+    ~GifEncoder();
+
+    GifEncoder(const GifEncoder&) = delete;
+    GifEncoder& operator=(const GifEncoder&) = delete;
+
+    // mulai GIF ke file; delay dalam 1/100 detik, 0 = bukan animasi
+    bool open(const std::string& path, int width, int height, int delay);
+    // mulai GIF di memori; hasil dibaca lewat data()/size() setelah finish()
+    bool openMemory(int width, int height, int delay);
+    // frame RGBA panjang * lebar * 4 byte
+    bool writeFrame(const uint8_t* rgba, int delay);
+    // tulis trailer, flush, dan tutup file; false jika ada yang gagal
+    bool finish();
+
+    bool isOpen() const { return active; }
+    // output mode memori, valid sampai open/openMemory berikutnya
+    const unsigned char* data() const { return out.data; }
+    size_t size() const { return out.size; }
+
+private:
+    bool begin(int width, int height, int delay);
+    void flush(size_t minBytes);
+
+    FILE* file = nullptr;
+    GifBuffer out = {};
+    std::vector<uint8_t> frameState;
+    std::unique_ptr<GifLzwDict> dict;
+    int width = 0;
+    int height = 0;
+    bool active = false;
+    bool firstFrame = true;
+    bool ok = true;
+};
+
+#endif
@@ -0,0 +1,46 @@
+#ifndef GRIDSEARCH_H
+#define GRIDSEARCH_H
+
+#include "encoder.h"
+#include "op.h"
+#include <vector>
+
+// Grid parameter kompresi untuk satu gambar; semua kombinasi metode x
+// threshold x minBlockSize dievaluasi, kecuali threshold di luar rentang
+// metodenya (misalnya 100 untuk entropy) yang dilewati
+struct GridSearchOptions {
+    std::vector<int> methods;
+    std::vector<double> thresholds;
+    std::vector<int> minBlockSizes;
+    int threads = 0;                        // 0 = semua thread pool global
+    SSIMWindow ssimWindow = SSIM_WINDOW_BOX;
+};
+
+struct GridSearchResult {
+    int errorMethod = 0;
+    double threshold = 0.0;
+    int minBlockSize = 0;
+    int totalNodes = 0;
+    int leaves = 0;
+    int maxDepth = 0;
+    size_t estimatedSize = 0;   // hitungCompressedSize
+    double psnr = 0.0;
+    double ssim = 0.0;
+    double millis = 0.0;        // potong tree + PSNR/SSIM kombinasi ini
+};
+
+struct GridSearchReport {
+    QtStatus status = QT_OK;                // invalid jika tidak ada kombinasi valid atau minBlockSize < 1
+    std::vector<GridSearchResult> results;  // urut metode, threshold, lalu minBlockSize sesuai input
+    double sharedBuildMillis = 0.0;         // build tree terhalus semua metode
+    int sharedNodes = 0;                    // total simpul tree terhalus
+};
+
+// Per metode dibangun satu tree terhalus (threshold paling ketat, minBlockSize
+// terkecil) dengan error simpul persis, semua metode dalam satu
+// QuadTree::buildMulti. Tree kombinasi lain adalah prefix tree itu
+// (QuadTree::buildfrTree), jadi gambar tidak di-scan ulang; kombinasi
+// dipotong dan dinilai paralel. Tree terhalus bisa besar jika threshold kecil.
+GridSearchReport runGridSearch(const std::vector<std::vector<Color>>& image, const GridSearchOptions& options);
+
+#endif
@@ -0,0 +1,37 @@
+#ifndef IMAGEWRITER_H
+#define IMAGEWRITER_H
+
+#include "quadtree.h"
+#include <vector>
+#include <string>
+
+// Opsi output quadtree untuk semua format
+struct ImageWriteOptions {
+    int pngLevel = 1;       // level deflate png 0-9
+    int jpgQuality = 90;    // kualitas jpg 1-100
+    int threads = 1;        // thread encode png/jpg, 0 = semua thread pool global
+};
+
+// Tulis hasil kompresi quadtree ke png, jpg/jpeg, bmp, atau tga langsung dari
+// daun, baris demi baris lewat ScanlineRenderer; gambar hasil rekonstruksi
+// penuh tidak pernah dibentuk. bmp dan tga ditulis top-down (tga dengan RLE).
+bool encodeQuadtreeImage(const std::string& extension, const QuadTree& tree, std::vector<unsigned char>& out,
+                         const ImageWriteOptions& options = ImageWriteOptions());
+
+// versi file; bmp dan tga dialirkan langsung ke file per baris
+bool writeQuadtreeImage(const std::string& filename, const QuadTree& tree,
+                        const ImageWriteOptions& options = ImageWriteOptions());
+
+// Perkiraan waktu encode: millisFixed + millisPerLeaf x jumlah daun, termasuk
+// pembentukan indeks daun. Diukur serial pada satu core; dipakai untuk
+// mencadangkan waktu encode dari deadline build.
+struct EncodeCostEstimate {
+    double millisFixed = 0.0;
+    double millisPerLeaf = 0.0;
+    double millisPerLeafIndex = 0.0;    // bagian millisPerLeaf untuk indeks daun, terjadi di akhir build
+};
+
+EncodeCostEstimate estimateEncodeCost(const std::string& extension, int width, int height,
+                                      const ImageWriteOptions& options = ImageWriteOptions());
+
+#endif
@@ -0,0 +1,64 @@
+#ifndef INTEGRALIMAGE_H
+#define INTEGRALIMAGE_H
+
+#include "quadtree.h"
+#include <vector>
+#include <cstdint>
+
+// Tabel jumlah (summed-area table) per channel untuk nilai piksel dan kuadratnya,
+// sehingga jumlah dan jumlah kuadrat blok mana pun didapat dalam O(1).
+// Semua disimpan 32 bit dan boleh wrap: selisih empat sudut tetap benar
+// modulo 2^32, dan blok yang jumlah kuadratnya bisa melewati 2^32 (lebih dari
+// 66051 piksel) dipecah dulu. Memori 24 byte per piksel.
+class IntegralImage {
+public:
+    // kapasitas lama dipakai ulang, jadi membentuk ulang untuk gambar seukuran murah
+    void build(const std::vector<std::vector<Color>>& image);
+    void clear();
+
+    bool empty() const { return table.empty(); }
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+
+    // jumlah dan jumlah kuadrat channel r, g, b blok [x, x + panjang) x [y, y + lebar)
+    void blockSums(int x, int y, int panjang, int lebar, unsigned long long sum[3], unsigned long long sumSq[3]) const {
+        if ((long long)panjang * lebar > kMaxExactPixels) {
+            unsigned long long sumB[3], sumSqB[3];
+            if (lebar >= panjang) {
+                int half = lebar / 2;
+                blockSums(x, y, panjang, half, sum, sumSq);
+                blockSums(x, y + half, panjang, lebar - half, sumB, sumSqB);
+            } else {
+                int half = panjang / 2;
+                blockSums(x, y, half, lebar, sum, sumSq);
+                blockSums(x + half, y, panjang - half, lebar, sumB, sumSqB);
+            }
+            for (int channel = 0; channel < 3; ++channel) {
+                sum[channel] += sumB[channel];
+                sumSq[channel] += sumSqB[channel];
+            }
+            return;
+        }
+        size_t stride = (size_t)(width + 1) * kCellValues;
+        const uint32_t* a = table.data() + (size_t)y * stride + (size_t)x * kCellValues;
+        const uint32_t* b = a + (size_t)panjang * kCellValues;
+        const uint32_t* c = a + (size_t)lebar * stride;
+        const uint32_t* d = c + (size_t)panjang * kCellValues;
+        for (int channel = 0; channel < 3; ++channel) {
+            sum[channel] = (uint32_t)(d[channel] - b[channel] - c[channel] + a[channel]);
+            sumSq[channel] = (uint32_t)(d[channel + 3] - b[channel + 3] - c[channel + 3] + a[channel + 3]);
+        }
+    }
+
+private:
+    // blok terbesar yang jumlah kuadratnya (255^2 per piksel) pasti muat 32 bit
+    static const long long kMaxExactPixels = 0xFFFFFFFFLL / (255 * 255);
+    // per sel: jumlah r, g, b lalu jumlah kuadrat r, g, b
+    static const int kCellValues = 6;
+
+    int width = 0;
+    int height = 0;
+    std::vector<uint32_t> table;      // (height + 1) x (width + 1) x kCellValues
+};
+
+#endif
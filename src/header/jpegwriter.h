@@ -0,0 +1,32 @@
+#ifndef JPEGWRITER_H
+#define JPEGWRITER_H
+
+#include "quadtree.h"
+#include <vector>
+#include <string>
+
+// Encoder JPEG baseline (tabel kuantisasi dan Huffman standar, sama dengan
+// stbi_write_jpg). Blok 8x8 yang seluruh pikselnya satu warna hanya punya
+// koefisien DC, jadi langsung ditulis tanpa konversi warna per piksel dan
+// tanpa DCT; DCT penuh hanya untuk blok di batas daun. Konversi warna dan DCT
+// memakai AVX2 jika CPU mendukung, hasilnya identik dengan jalur skalar.
+// Dengan threads > 1 gambar dibagi menjadi pita restart interval (DRI/RSTn)
+// yang di-encode paralel; hasilnya tetap satu JPEG baseline.
+struct JpegWriteOptions {
+    int quality = 90;   // 1-100; <= 90 memakai chroma subsampling 4:2:0
+    bool simd = true;   // false: paksa kernel skalar
+    int threads = 1;    // > 1: pita di-encode paralel, 0 = semua thread pool global
+};
+
+// rgb: panjang * lebar * 3 byte; blok seragam dideteksi dari pikselnya
+bool encodeJPEG(const unsigned char* rgb, int width, int height, std::vector<unsigned char>& out,
+                const JpegWriteOptions& options = JpegWriteOptions());
+
+// blok seragam diketahui langsung dari daun quadtree
+bool encodeQuadtreeJPEG(const QuadTree& tree, std::vector<unsigned char>& out,
+                        const JpegWriteOptions& options = JpegWriteOptions());
+
+bool writeQuadtreeJPEG(const std::string& filename, const QuadTree& tree,
+                       const JpegWriteOptions& options = JpegWriteOptions());
+
+#endif
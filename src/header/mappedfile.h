@@ -0,0 +1,35 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <string>
+#include <vector>
+#include <cstddef>
+
+// Isi file read-only untuk decoder. Di POSIX file di-mmap (zero-copy, dengan
+// hint madvise untuk akses sekuensial); jika mmap tidak tersedia atau gagal,
+// file dibaca lewat stdio ke buffer internal.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    const unsigned char* data() const { return bytes; }
+    size_t size() const { return length; }
+    bool isMapped() const { return mapping != nullptr; }
+
+private:
+    bool readWithStdio(const std::string& path);
+
+    const unsigned char* bytes = nullptr;
+    size_t length = 0;
+    void* mapping = nullptr;
+    std::vector<unsigned char> buffer;
+};
+
+#endif
@@ -0,0 +1,807 @@
+#ifndef METRIC_H
+#define METRIC_H
+
+#include "quadtree.h"
+#include "integralimage.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Blok [x, x + panjang) x [y, y + lebar) pada gambar, dibaca langsung dari
+// baris gambar tanpa menyalin piksel. Piksel dikunjungi baris demi baris,
+// urutannya sama dengan blockPixels versi lama sehingga hasil hitung identik.
+// integral diisi build untuk metrik yang usesIntegral, selain itu nullptr.
+struct ImageBlock {
+    const std::vector<std::vector<Color>>& image;
+    int x, y, panjang, lebar;
+    const IntegralImage* integral = nullptr;
+
+    int count() const { return panjang * lebar; }
+
+    template <typename Fn>
+    void forEach(Fn&& fn) const {
+        for (int row = y; row < y + lebar; ++row) {
+            const Color* pixel = image[row].data() + x;
+            for (int col = 0; col < panjang; ++col) fn(pixel[col]);
+        }
+    }
+};
+
+// Jumlah channel blok dan banyak piksel yang sudah dibaca. Jumlahnya hanya
+// lengkap jika scan tidak berhenti lebih awal.
+struct BlockScan {
+    unsigned long long sumR = 0, sumG = 0, sumB = 0;
+    long long scanned = 0;
+    double errorBound = 0.0;    // batas error saat scan berhenti (SSIM: batas atas, lainnya batas bawah)
+
+    Color average(int count) const {
+        if (count <= 0) return Color(0, 0, 0);
+        return Color(sumR / count, sumG / count, sumB / count);
+    }
+};
+
+inline void hitungBlockSums(const ImageBlock& block, BlockScan& scan) {
+    block.forEach([&](const Color& pixel) {
+        scan.sumR += pixel.r;
+        scan.sumG += pixel.g;
+        scan.sumB += pixel.b;
+    });
+    scan.scanned += block.count();
+}
+
+inline Color hitungBlockAverage(const ImageBlock& block) {
+    BlockScan scan;
+    hitungBlockSums(block, scan);
+    return scan.average(block.count());
+}
+
+// Scan baris demi baris sambil menjumlah channel dan memanggil accumulate per
+// piksel. Setelah tiap baris (kecuali baris terakhir) exceeded() diperiksa;
+// true = keputusan pecah sudah pasti dan scan berhenti.
+template <typename Accumulate, typename Exceeded>
+inline bool scanUntilExceeded(const ImageBlock& block, BlockScan& scan, Accumulate&& accumulate, Exceeded&& exceeded) {
+    for (int row = block.y; row < block.y + block.lebar; ++row) {
+        const Color* pixel = block.image[row].data() + block.x;
+        for (int col = 0; col < block.panjang; ++col) {
+            scan.sumR += pixel[col].r;
+            scan.sumG += pixel[col].g;
+            scan.sumB += pixel[col].b;
+            accumulate(pixel[col]);
+        }
+        scan.scanned += block.panjang;
+        if (row + 1 < block.y + block.lebar && exceeded()) return true;
+    }
+    return false;
+}
+
+// Batas parsial dihitung dengan rumus berbeda dari error persis, jadi diberi
+// margin supaya pembulatan tidak pernah membalik keputusan
+inline bool clearlyAbove(double bound, double threshold) {
+    return bound > threshold + 1e-6 * std::max(std::abs(threshold), 1.0);
+}
+
+inline bool clearlyBelow(double bound, double threshold) {
+    return bound < threshold - 1e-6 * std::max(std::abs(threshold), 1.0);
+}
+
+// Jumlah kuadrat selisih n piksel terhadap rata-rata mereka sendiri. Nilai ini
+// minimum untuk titik acuan mana pun, jadi batas bawah kontribusi piksel ini
+// pada error terhadap rata-rata blok.
+inline double hitungPartialSSE(unsigned long long sumSq, unsigned long long sum, long long n) {
+    if (n <= 0) return 0.0;
+    return std::max(0.0, (double)sumSq - (double)sum * (double)sum / n);
+}
+
+// Jumlah |v - median| histogram; minimum jumlah selisih absolut ke titik mana pun
+inline double hitungMedianDeviation(const int* hist, long long n) {
+    long long half = (n + 1) / 2, seen = 0;
+    int median = 0;
+    while (median < 255 && seen + hist[median] < half) seen += hist[median++];
+    double deviation = 0.0;
+    for (int value = 0; value < 256; ++value) {
+        if (hist[value]) deviation += (double)hist[value] * std::abs(value - median);
+    }
+    return deviation;
+}
+
+// Taksiran error dari sampel; valid = false jika metrik tidak bisa ditaksir
+struct ErrorEstimate {
+    bool valid = false;
+    double value = 0.0;
+    double standardError = 0.0;
+};
+
+// Sampel terstratifikasi sekitar sampleSize piksel: blok dibagi grid sel
+// seukuran sama (rasio mengikuti bentuk blok) dan dari tiap sel diambil satu
+// piksel di posisi hash posisi sel, jadi hasilnya deterministik.
+inline void sampleBlock(const ImageBlock& block, int sampleSize, std::vector<Color>& sample) {
+    sample.clear();
+    if (block.count() <= 0 || sampleSize <= 0) return;
+    int cols = (int)std::lround(std::sqrt((double)sampleSize * block.panjang / block.lebar));
+    cols = std::max(1, std::min(cols, block.panjang));
+    int rows = std::max(1, std::min(sampleSize / cols, block.lebar));
+    sample.reserve((size_t)rows * cols);
+    for (int i = 0; i < rows; ++i) {
+        int y0 = block.y + (int)((long long)i * block.lebar / rows);
+        int y1 = block.y + (int)((long long)(i + 1) * block.lebar / rows);
+        for (int j = 0; j < cols; ++j) {
+            int x0 = block.x + (int)((long long)j * block.panjang / cols);
+            int x1 = block.x + (int)((long long)(j + 1) * block.panjang / cols);
+            unsigned int hash = (unsigned int)(x0 * 73856093) ^ (unsigned int)(y0 * 19349663);
+            hash ^= hash >> 13;
+            hash *= 0x5bd1e995u;
+            hash ^= hash >> 15;
+            sample.push_back(block.image[y0 + hash % (y1 - y0)][x0 + (hash >> 16) % (x1 - x0)]);
+        }
+    }
+}
+
+// Rata-rata dan standard error rata-rata q(piksel) atas sampel. Rumus sampel
+// acak sederhana; untuk sampel terstratifikasi nilainya tidak pernah lebih
+// kecil dari yang sebenarnya, jadi pita keyakinannya konservatif.
+template <typename Fn>
+inline ErrorEstimate estimateMean(const std::vector<Color>& sample, Fn&& q) {
+    ErrorEstimate estimate;
+    size_t n = sample.size();
+    if (n < 2) return estimate;
+    double sum = 0.0, sumSq = 0.0;
+    for (const Color& pixel : sample) {
+        double value = q(pixel);
+        sum += value;
+        sumSq += value * value;
+    }
+    double mean = sum / n;
+    double variance = std::max(0.0, (sumSq - sum * mean) / (n - 1));
+    estimate.valid = true;
+    estimate.value = mean;
+    estimate.standardError = std::sqrt(variance / n);
+    return estimate;
+}
+
+inline void sampleMean(const std::vector<Color>& sample, double mean[3]) {
+    double sum[3] = {0.0, 0.0, 0.0};
+    for (const Color& pixel : sample) {
+        sum[0] += pixel.r;
+        sum[1] += pixel.g;
+        sum[2] += pixel.b;
+    }
+    for (int channel = 0; channel < 3; ++channel) mean[channel] = sum[channel] / sample.size();
+}
+
+// Statistik satu blok yang dibaca sekali untuk beberapa metrik sekaligus (lihat
+// QuadTree::buildMulti). Metrik yang punya hitungError(stats, avg) memberi hasil
+// sama persis dengan hitungError(block, avg): semua selisih dijumlah sebagai
+// integer, sama dengan penjumlahan double per piksel yang tidak pernah dibulatkan.
+
+// jumlah, jumlah kuadrat, min dan max per channel (variance, MPD, SSIM)
+struct BlockMoments {
+    int count = 0;
+    unsigned long long sum[3] = {0, 0, 0};
+    unsigned long long sumSq[3] = {0, 0, 0};
+    int minValue[3] = {255, 255, 255};
+    int maxValue[3] = {0, 0, 0};
+
+    void build(const ImageBlock& block) {
+        unsigned long long sumR = 0, sumG = 0, sumB = 0, sqR = 0, sqG = 0, sqB = 0;
+        int minR = 255, minG = 255, minB = 255, maxR = 0, maxG = 0, maxB = 0;
+        block.forEach([&](const Color& pixel) {
+            sumR += pixel.r;
+            sumG += pixel.g;
+            sumB += pixel.b;
+            sqR += pixel.r * pixel.r;
+            sqG += pixel.g * pixel.g;
+            sqB += pixel.b * pixel.b;
+            minR = std::min<int>(minR, pixel.r);
+            minG = std::min<int>(minG, pixel.g);
+            minB = std::min<int>(minB, pixel.b);
+            maxR = std::max<int>(maxR, pixel.r);
+            maxG = std::max<int>(maxG, pixel.g);
+            maxB = std::max<int>(maxB, pixel.b);
+        });
+        count = block.count();
+        sum[0] = sumR;
+        sum[1] = sumG;
+        sum[2] = sumB;
+        sumSq[0] = sqR;
+        sumSq[1] = sqG;
+        sumSq[2] = sqB;
+        minValue[0] = minR;
+        minValue[1] = minG;
+        minValue[2] = minB;
+        maxValue[0] = maxR;
+        maxValue[1] = maxG;
+        maxValue[2] = maxB;
+    }
+
+    void merge(const BlockMoments& other) {
+        count += other.count;
+        for (int channel = 0; channel < 3; ++channel) {
+            sum[channel] += other.sum[channel];
+            sumSq[channel] += other.sumSq[channel];
+            minValue[channel] = std::min(minValue[channel], other.minValue[channel]);
+            maxValue[channel] = std::max(maxValue[channel], other.maxValue[channel]);
+        }
+    }
+
+    Color average() const {
+        if (count <= 0) return Color(0, 0, 0);
+        return Color(sum[0] / count, sum[1] / count, sum[2] / count);
+    }
+
+    // jumlah (v - center)^2 satu channel
+    double sumSqrDiff(int channel, int center) const {
+        long long total = (long long)sumSq[channel] - 2LL * center * (long long)sum[channel] +
+                          (long long)count * center * center;
+        return (double)total;
+    }
+};
+
+// histogram per channel (MAD, entropy); blok besar dibaca sekali ke sini dan
+// momennya diturunkan dari histogram
+struct BlockHistogram {
+    int count = 0;
+    int hist[3][256];
+
+    void clear() {
+        count = 0;
+        std::fill(&hist[0][0], &hist[0][0] + 3 * 256, 0);
+    }
+
+    void build(const ImageBlock& block) {
+        clear();
+        block.forEach([&](const Color& pixel) {
+            hist[0][pixel.r]++;
+            hist[1][pixel.g]++;
+            hist[2][pixel.b]++;
+        });
+        count = block.count();
+    }
+
+    void merge(const BlockHistogram& other) {
+        count += other.count;
+        for (int channel = 0; channel < 3; ++channel) {
+            for (int value = 0; value < 256; ++value) hist[channel][value] += other.hist[channel][value];
+        }
+    }
+
+    BlockMoments moments() const {
+        BlockMoments moments;
+        moments.count = count;
+        for (int channel = 0; channel < 3; ++channel) {
+            for (int value = 0; value < 256; ++value) {
+                unsigned long long n = hist[channel][value];
+                if (n == 0) continue;
+                moments.sum[channel] += n * value;
+                moments.sumSq[channel] += n * value * value;
+                moments.minValue[channel] = std::min(moments.minValue[channel], value);
+                moments.maxValue[channel] = value;
+            }
+        }
+        return moments;
+    }
+
+    // jumlah |v - center| satu channel
+    double sumAbsDiff(int channel, int center) const {
+        long long total = 0;
+        for (int value = 0; value < 256; ++value) {
+            total += (long long)hist[channel][value] * std::abs(value - center);
+        }
+        return (double)total;
+    }
+};
+
+// Blok kecil diperiksa tanpa histogram (overhead memset dan cek O(256) tidak sebanding)
+const int kHistogramBoundMinPixels = 1024;
+
+// Policy metrik error untuk QuadTree::buildWith dan buildBestFirstWith.
+// Metrik lain (termasuk buatan pemanggil) diturunkan dari MetricPolicy dan
+// menyediakan anggota yang sama:
+//   higherIsBetter        true jika nilai besar = mirip (seperti SSIM, rentang 0-1);
+//                         blok dipecah saat nilainya di bawah threshold
+//   hitungError(block, avg)  error blok terhadap warna rata-ratanya
+//   exceedsThreshold(block, threshold, scan)  opsional, lihat MetricPolicy
+//   estimateError(sample)  opsional, taksiran error dari sampleBlock untuk
+//                         QuadTreeSampling, dipakai jika canEstimate true
+//   usesIntegral, blockSums(block, scan)  opsional; usesIntegral true = build
+//                         menyiapkan IntegralImage di block.integral dulu
+// Metrik bawaan 1-5 menghasilkan nilai yang sama persis dengan hitung* di op.h.
+// Tiap metrik mendefinisikan higherIsBetter (arah threshold: true = blok
+// dipecah jika error < threshold) dan maxThreshold (threshold valid 0-maxThreshold).
+struct MetricPolicy {
+    // Scan blok sambil memeriksa batas parsial error. true = blok pasti
+    // dipecah, scan berhenti lebih awal dan scan.errorBound terisi. false =
+    // scan selesai dengan jumlah channel lengkap, keputusan lewat hitungError.
+    // Versi dasar selalu scan penuh.
+    static bool exceedsThreshold(const ImageBlock& block, double, BlockScan& scan) {
+        hitungBlockSums(block, scan);
+        return false;
+    }
+
+    static constexpr bool canEstimate = false;
+    static ErrorEstimate estimateError(const std::vector<Color>&) { return ErrorEstimate(); }
+
+    // jumlah channel blok untuk warna rata-rata
+    static constexpr bool usesIntegral = false;
+    static void blockSums(const ImageBlock& block, BlockScan& scan) { hitungBlockSums(block, scan); }
+};
+
+struct VarianceMetric : MetricPolicy {
+    static constexpr bool higherIsBetter = false;
+    static constexpr double maxThreshold = 128 * 128;
+    static constexpr bool canEstimate = true;
+
+    // batas bawah: SSE piksel yang sudah dibaca terhadap rata-rata mereka sendiri
+    static bool exceedsThreshold(const ImageBlock& block, double threshold, BlockScan& scan) {
+        unsigned long long sqR = 0, sqG = 0, sqB = 0;
+        double count = block.count();
+        return scanUntilExceeded(block, scan, [&](const Color& pixel) {
+            sqR += pixel.r * pixel.r;
+            sqG += pixel.g * pixel.g;
+            sqB += pixel.b * pixel.b;
+        }, [&]() {
+            scan.errorBound = (hitungPartialSSE(sqR, scan.sumR, scan.scanned) +
+                               hitungPartialSSE(sqG, scan.sumG, scan.scanned) +
+                               hitungPartialSSE(sqB, scan.sumB, scan.scanned)) / (3.0 * count);
+            return clearlyAbove(scan.errorBound, threshold);
+        });
+    }
+
+    static double hitungError(const ImageBlock& block, const Color& avgColor) {
+        int count = block.count();
+        if (count <= 0) return 0.0;
+
+        double sumSqrDiffR = 0.0, sumSqrDiffG = 0.0, sumSqrDiffB = 0.0;
+        block.forEach([&](const Color& pixel) {
+            double diffR = pixel.r - avgColor.r;
+            double diffG = pixel.g - avgColor.g;
+            double diffB = pixel.b - avgColor.b;
+            sumSqrDiffR += diffR * diffR;
+            sumSqrDiffG += diffG * diffG;
+            sumSqrDiffB += diffB * diffB;
+        });
+        return (sumSqrDiffR / count + sumSqrDiffG / count + sumSqrDiffB / count) / 3.0;
+    }
+
+    static double hitungError(const BlockMoments& moments, const Color& avgColor) {
+        int count = moments.count;
+        if (count <= 0) return 0.0;
+        return (moments.sumSqrDiff(0, avgColor.r) / count + moments.sumSqrDiff(1, avgColor.g) / count +
+                moments.sumSqrDiff(2, avgColor.b) / count) / 3.0;
+    }
+
+    // rata-rata kuadrat selisih per piksel, dikoreksi n / (n - 1) karena
+    // rata-ratanya juga diambil dari sampel
+    static ErrorEstimate estimateError(const std::vector<Color>& sample) {
+        double mean[3];
+        sampleMean(sample, mean);
+        ErrorEstimate estimate = estimateMean(sample, [&](const Color& pixel) {
+            double diffR = pixel.r - mean[0], diffG = pixel.g - mean[1], diffB = pixel.b - mean[2];
+            return (diffR * diffR + diffG * diffG + diffB * diffB) / 3.0;
+        });
+        double correction = sample.size() / (sample.size() - 1.0);
+        estimate.value *= correction;
+        estimate.standardError *= correction;
+        return estimate;
+    }
+};
+
+struct MADMetric : MetricPolicy {
+    static constexpr bool higherIsBetter = false;
+    static constexpr double maxThreshold = 255;
+    static constexpr bool canEstimate = true;
+
+    // batas bawah: jumlah |x - median| piksel yang sudah dibaca
+    static bool exceedsThreshold(const ImageBlock& block, double threshold, BlockScan& scan) {
+        int count = block.count();
+        if (count < kHistogramBoundMinPixels) return MetricPolicy::exceedsThreshold(block, threshold, scan);
+
+        int hist[3][256] = {{0}};
+        long long nextCheck = std::max<long long>(256, count / 16);
+        return scanUntilExceeded(block, scan, [&](const Color& pixel) {
+            hist[0][pixel.r]++;
+            hist[1][pixel.g]++;
+            hist[2][pixel.b]++;
+        }, [&]() {
+            if (scan.scanned < nextCheck) return false;
+            nextCheck = scan.scanned * 2;
+            scan.errorBound = (hitungMedianDeviation(hist[0], scan.scanned) +
+                               hitungMedianDeviation(hist[1], scan.scanned) +
+                               hitungMedianDeviation(hist[2], scan.scanned)) / (3.0 * count);
+            return clearlyAbove(scan.errorBound, threshold);
+        });
+    }
+
+    static double hitungError(const ImageBlock& block, const Color& avgColor) {
+        int count = block.count();
+        if (count <= 0) return 0.0;
+
+        double sumAbsDiffR = 0.0, sumAbsDiffG = 0.0, sumAbsDiffB = 0.0;
+        block.forEach([&](const Color& pixel) {
+            sumAbsDiffR += std::abs(pixel.r - avgColor.r);
+            sumAbsDiffG += std::abs(pixel.g - avgColor.g);
+            sumAbsDiffB += std::abs(pixel.b - avgColor.b);
+        });
+        return (sumAbsDiffR / count + sumAbsDiffG / count + sumAbsDiffB / count) / 3.0;
+    }
+
+    static double hitungError(const BlockHistogram& histogram, const Color& avgColor) {
+        int count = histogram.count;
+        if (count <= 0) return 0.0;
+        return (histogram.sumAbsDiff(0, avgColor.r) / count + histogram.sumAbsDiff(1, avgColor.g) / count +
+                histogram.sumAbsDiff(2, avgColor.b) / count) / 3.0;
+    }
+
+    static ErrorEstimate estimateError(const std::vector<Color>& sample) {
+        double mean[3];
+        sampleMean(sample, mean);
+        return estimateMean(sample, [&](const Color& pixel) {
+            return (std::abs(pixel.r - mean[0]) + std::abs(pixel.g - mean[1]) + std::abs(pixel.b - mean[2])) / 3.0;
+        });
+    }
+};
+
+struct MaxDifferenceMetric : MetricPolicy {
+    static constexpr bool higherIsBetter = false;
+    static constexpr double maxThreshold = 255;
+
+    // max - min hanya bisa naik, jadi nilai parsial sudah batas bawah yang persis
+    static bool exceedsThreshold(const ImageBlock& block, double threshold, BlockScan& scan) {
+        unsigned char minR = 255, minG = 255, minB = 255;
+        unsigned char maxR = 0, maxG = 0, maxB = 0;
+        return scanUntilExceeded(block, scan, [&](const Color& pixel) {
+            minR = std::min(minR, pixel.r);
+            minG = std::min(minG, pixel.g);
+            minB = std::min(minB, pixel.b);
+            maxR = std::max(maxR, pixel.r);
+            maxG = std::max(maxG, pixel.g);
+            maxB = std::max(maxB, pixel.b);
+        }, [&]() {
+            double diffR = maxR - minR;
+            double diffG = maxG - minG;
+            double diffB = maxB - minB;
+            scan.errorBound = (diffR + diffG + diffB) / 3.0;
+            return scan.errorBound > threshold;
+        });
+    }
+
+    // max - min tidak bisa ditaksir dari sampel (piksel ekstrem mudah
+    // terlewat); exceedsThreshold sudah berhenti begitu rentangnya terlampaui
+    static double hitungError(const ImageBlock& block, const Color&) {
+        if (block.count() <= 0) return 0.0;
+
+        unsigned char minR = 255, minG = 255, minB = 255;
+        unsigned char maxR = 0, maxG = 0, maxB = 0;
+        block.forEach([&](const Color& pixel) {
+            minR = std::min(minR, pixel.r);
+            minG = std::min(minG, pixel.g);
+            minB = std::min(minB, pixel.b);
+            maxR = std::max(maxR, pixel.r);
+            maxG = std::max(maxG, pixel.g);
+            maxB = std::max(maxB, pixel.b);
+        });
+        double diffR = maxR - minR;
+        double diffG = maxG - minG;
+        double diffB = maxB - minB;
+        return (diffR + diffG + diffB) / 3.0;
+    }
+
+    static double hitungError(const BlockMoments& moments, const Color&) {
+        if (moments.count <= 0) return 0.0;
+        double diffR = moments.maxValue[0] - moments.minValue[0];
+        double diffG = moments.maxValue[1] - moments.minValue[1];
+        double diffB = moments.maxValue[2] - moments.minValue[2];
+        return (diffR + diffG + diffB) / 3.0;
+    }
+};
+
+struct EntropyMetric : MetricPolicy {
+    static constexpr bool higherIsBetter = false;
+    static constexpr double maxThreshold = 8;
+    static constexpr bool canEstimate = true;
+
+    // batas bawah: entropy terkecil yang mungkin, yaitu jika semua piksel yang
+    // belum dibaca jatuh ke nilai yang paling sering muncul
+    static bool exceedsThreshold(const ImageBlock& block, double threshold, BlockScan& scan) {
+        int count = block.count();
+        if (count < kHistogramBoundMinPixels) return MetricPolicy::exceedsThreshold(block, threshold, scan);
+
+        int hist[3][256] = {{0}};
+        long long nextCheck = std::max<long long>(256, count / 16);
+        return scanUntilExceeded(block, scan, [&](const Color& pixel) {
+            hist[0][pixel.r]++;
+            hist[1][pixel.g]++;
+            hist[2][pixel.b]++;
+        }, [&]() {
+            if (scan.scanned < nextCheck) return false;
+            nextCheck = scan.scanned * 2;
+            int remaining = count - (int)scan.scanned;
+            scan.errorBound = (minimumEntropy(hist[0], remaining, count) + minimumEntropy(hist[1], remaining, count) +
+                               minimumEntropy(hist[2], remaining, count)) / 3.0;
+            return clearlyAbove(scan.errorBound, threshold);
+        });
+    }
+
+    static double hitungError(const ImageBlock& block, const Color&) {
+        int count = block.count();
+        if (count <= 0) return 0.0;
+        if (count <= kSortedEntropyMaxPixels) return sortedEntropy(block);
+
+        // histogram array menggantikan std::map; dijumlah dengan urutan nilai
+        // naik yang sama
+        int histR[256] = {0}, histG[256] = {0}, histB[256] = {0};
+        block.forEach([&](const Color& pixel) {
+            histR[pixel.r]++;
+            histG[pixel.g]++;
+            histB[pixel.b]++;
+        });
+        return (channelEntropy(histR, count) + channelEntropy(histG, count) + channelEntropy(histB, count)) / 3.0;
+    }
+
+    // sortedEntropy juga menjumlah per nilai naik, jadi sama untuk blok kecil
+    static double hitungError(const BlockHistogram& histogram, const Color&) {
+        int count = histogram.count;
+        if (count <= 0) return 0.0;
+        return (channelEntropy(histogram.hist[0], count) + channelEntropy(histogram.hist[1], count) +
+                channelEntropy(histogram.hist[2], count)) / 3.0;
+    }
+
+    // Entropy plug-in histogram sampel ditambah koreksi Miller-Madow
+    // (bin terisi - 1) / 2n, standard error lewat metode delta
+    static ErrorEstimate estimateError(const std::vector<Color>& sample) {
+        ErrorEstimate estimate;
+        int n = (int)sample.size();
+        if (n < 2) return estimate;
+        int hist[3][256] = {{0}};
+        for (const Color& pixel : sample) {
+            hist[0][pixel.r]++;
+            hist[1][pixel.g]++;
+            hist[2][pixel.b]++;
+        }
+        double variance = 0.0;
+        for (int channel = 0; channel < 3; ++channel) {
+            double entropy = 0.0, sumSq = 0.0;
+            int occupied = 0;
+            for (int value = 0; value < 256; ++value) {
+                if (hist[channel][value] == 0) continue;
+                double probability = static_cast<double>(hist[channel][value]) / n;
+                double bits = std::log2(probability);
+                entropy -= probability * bits;
+                sumSq += probability * bits * bits;
+                occupied++;
+            }
+            estimate.value += entropy + (occupied - 1) / (2.0 * n * std::log(2.0));
+            variance += std::max(0.0, sumSq - entropy * entropy) / n;
+        }
+        estimate.valid = true;
+        estimate.value /= 3.0;
+        // channel bisa berkorelasi; akar rata-rata kuadrat se channel tidak
+        // lebih kecil dari se rata-rata untuk korelasi apa pun
+        estimate.standardError = std::sqrt(variance / 3.0);
+        return estimate;
+    }
+
+private:
+    // blok kecil: nilai diurutkan lalu dihitung per run, tanpa memset dan scan
+    // histogram 3 x 256; urutan penjumlahan tetap nilai naik
+    static const int kSortedEntropyMaxPixels = 64;
+
+    static double sortedEntropy(const ImageBlock& block) {
+        int count = block.count();
+        unsigned char values[3][kSortedEntropyMaxPixels];
+        int n = 0;
+        block.forEach([&](const Color& pixel) {
+            values[0][n] = pixel.r;
+            values[1][n] = pixel.g;
+            values[2][n] = pixel.b;
+            n++;
+        });
+        double total = 0.0;
+        for (int channel = 0; channel < 3; ++channel) {
+            unsigned char* v = values[channel];
+            std::sort(v, v + n);
+            double entropy = 0.0;
+            for (int i = 0; i < n;) {
+                int j = i + 1;
+                while (j < n && v[j] == v[i]) j++;
+                double probability = static_cast<double>(j - i) / count;
+                entropy -= probability * std::log2(probability);
+                i = j;
+            }
+            total += entropy;
+        }
+        return total / 3.0;
+    }
+
+    static double minimumEntropy(const int* hist, int remaining, int count) {
+        int mode = 0;
+        for (int value = 1; value < 256; ++value) {
+            if (hist[value] > hist[mode]) mode = value;
+        }
+        double entropy = 0.0;
+        for (int value = 0; value < 256; ++value) {
+            int n = hist[value] + (value == mode ? remaining : 0);
+            if (n == 0) continue;
+            double probability = static_cast<double>(n) / count;
+            entropy -= probability * std::log2(probability);
+        }
+        return entropy;
+    }
+
+    static double channelEntropy(const int* hist, int count) {
+        double entropy = 0.0;
+        for (int value = 0; value < 256; ++value) {
+            if (hist[value] == 0) continue;
+            double probability = static_cast<double>(hist[value]) / count;
+            entropy -= probability * std::log2(probability);
+        }
+        return entropy;
+    }
+};
+
+struct SSIMMetric : MetricPolicy {
+    static constexpr bool higherIsBetter = true;
+    static constexpr double maxThreshold = 1;
+    static constexpr bool canEstimate = true;
+
+    // batas atas: SSIM dengan variance diganti batas bawahnya (lihat VarianceMetric)
+    static bool exceedsThreshold(const ImageBlock& block, double threshold, BlockScan& scan) {
+        double C1 = (0.03 * 255) * (0.03 * 255);
+        unsigned long long sqR = 0, sqG = 0, sqB = 0;
+        double count = block.count();
+        return scanUntilExceeded(block, scan, [&](const Color& pixel) {
+            sqR += pixel.r * pixel.r;
+            sqG += pixel.g * pixel.g;
+            sqB += pixel.b * pixel.b;
+        }, [&]() {
+            double ssimR = C1 / (hitungPartialSSE(sqR, scan.sumR, scan.scanned) / count + C1);
+            double ssimG = C1 / (hitungPartialSSE(sqG, scan.sumG, scan.scanned) / count + C1);
+            double ssimB = C1 / (hitungPartialSSE(sqB, scan.sumB, scan.scanned) / count + C1);
+            scan.errorBound = (ssimR + ssimG + ssimB) / 3.0;
+            return clearlyBelow(scan.errorBound, threshold);
+        });
+    }
+
+    static double hitungError(const ImageBlock& block, const Color& avgColor) {
+        int count = block.count();
+        if (count <= 0) return 0.0;
+
+        double L = 255;
+        double C1 = (0.03 * L) * (0.03 * L);
+
+        double sumSqrDiffR = 0.0, sumSqrDiffG = 0.0, sumSqrDiffB = 0.0;
+        block.forEach([&](const Color& pixel) {
+            double diffR = pixel.r - avgColor.r;
+            double diffG = pixel.g - avgColor.g;
+            double diffB = pixel.b - avgColor.b;
+            sumSqrDiffR += diffR * diffR;
+            sumSqrDiffG += diffG * diffG;
+            sumSqrDiffB += diffB * diffB;
+        });
+        double ssimR = C1 / (sumSqrDiffR / count + C1);
+        double ssimG = C1 / (sumSqrDiffG / count + C1);
+        double ssimB = C1 / (sumSqrDiffB / count + C1);
+        return (ssimR + ssimG + ssimB) / 3.0;
+    }
+
+    static double hitungError(const BlockMoments& moments, const Color& avgColor) {
+        int count = moments.count;
+        if (count <= 0) return 0.0;
+
+        double C1 = (0.03 * 255) * (0.03 * 255);
+        double ssimR = C1 / (moments.sumSqrDiff(0, avgColor.r) / count + C1);
+        double ssimG = C1 / (moments.sumSqrDiff(1, avgColor.g) / count + C1);
+        double ssimB = C1 / (moments.sumSqrDiff(2, avgColor.b) / count + C1);
+        return (ssimR + ssimG + ssimB) / 3.0;
+    }
+
+    // variance tiap channel ditaksir seperti VarianceMetric, lalu diturunkan
+    // lewat d/dv C1 / (v + C1) = -C1 / (v + C1)^2
+    static ErrorEstimate estimateError(const std::vector<Color>& sample) {
+        ErrorEstimate estimate;
+        if (sample.size() < 2) return estimate;
+        double C1 = (0.03 * 255) * (0.03 * 255);
+        double mean[3];
+        sampleMean(sample, mean);
+        double correction = sample.size() / (sample.size() - 1.0);
+        for (int channel = 0; channel < 3; ++channel) {
+            ErrorEstimate variance = estimateMean(sample, [&](const Color& pixel) {
+                double diff = (channel == 0 ? pixel.r : channel == 1 ? pixel.g : pixel.b) - mean[channel];
+                return diff * diff;
+            });
+            double v = variance.value * correction;
+            double ssim = C1 / (v + C1);
+            estimate.value += ssim / 3.0;
+            estimate.standardError += ssim / (v + C1) * variance.standardError * correction / 3.0;
+        }
+        estimate.valid = true;
+        return estimate;
+    }
+};
+
+// SSIM sebenarnya antara blok dan rekonstruksinya (blok rata warna avgColor),
+// per channel lalu dirata-rata. Rekonstruksi datar tidak punya variance dan
+// kovarians, jadi SSIM = (2 mu_x c + C1) / (mu_x^2 + c^2 + C1) x C2 / (var_x + C2).
+// Karena c = rata-rata blok yang dibulatkan, suku luminance hampir 1 dan nilainya
+// praktis sama dengan SSIMMetric (C2 = C1 SSIMMetric, var_x vs simpangan kuadrat
+// terhadap c): urutan dan keputusan pecah blok hampir identik. Bedanya kecepatan:
+// rata-rata dan variance diambil dari IntegralImage, jadi tiap blok O(1)
+// setelah satu pass pembentukan tabel.
+struct BlockSSIMMetric : MetricPolicy {
+    static constexpr bool higherIsBetter = true;
+    static constexpr double maxThreshold = 1;
+    static constexpr bool usesIntegral = true;
+
+    static void blockSums(const ImageBlock& block, BlockScan& scan) {
+        if (!block.integral) return hitungBlockSums(block, scan);
+        unsigned long long sum[3], sumSq[3];
+        block.integral->blockSums(block.x, block.y, block.panjang, block.lebar, sum, sumSq);
+        scan.sumR += sum[0];
+        scan.sumG += sum[1];
+        scan.sumB += sum[2];
+    }
+
+    // keputusan langsung lewat hitungError yang juga O(1), tanpa scan
+    static bool exceedsThreshold(const ImageBlock& block, double, BlockScan& scan) {
+        blockSums(block, scan);
+        return false;
+    }
+
+    static double hitungError(const ImageBlock& block, const Color& avgColor) {
+        int count = block.count();
+        if (count <= 0) return 0.0;
+
+        unsigned long long sum[3] = {0, 0, 0}, sumSq[3] = {0, 0, 0};
+        if (block.integral) {
+            block.integral->blockSums(block.x, block.y, block.panjang, block.lebar, sum, sumSq);
+        } else {
+            block.forEach([&](const Color& pixel) {
+                sum[0] += pixel.r;
+                sum[1] += pixel.g;
+                sum[2] += pixel.b;
+                sumSq[0] += pixel.r * pixel.r;
+                sumSq[1] += pixel.g * pixel.g;
+                sumSq[2] += pixel.b * pixel.b;
+            });
+        }
+        return hitungFlatSSIM(sum, sumSq, count, avgColor);
+    }
+
+    static double hitungError(const BlockMoments& moments, const Color& avgColor) {
+        if (moments.count <= 0) return 0.0;
+        return hitungFlatSSIM(moments.sum, moments.sumSq, moments.count, avgColor);
+    }
+
+    static double hitungFlatSSIM(const unsigned long long sum[3], const unsigned long long sumSq[3], int count,
+                                 const Color& avgColor) {
+        double L = 255;
+        double C1 = (0.01 * L) * (0.01 * L);
+        double C2 = (0.03 * L) * (0.03 * L);
+        double flat[3] = {(double)avgColor.r, (double)avgColor.g, (double)avgColor.b};
+        double total = 0.0;
+        for (int channel = 0; channel < 3; ++channel) {
+            double mean = (double)sum[channel] / count;
+            double variance = std::max(0.0, (double)sumSq[channel] / count - mean * mean);
+            double luminance = (2.0 * mean * flat[channel] + C1) / (mean * mean + flat[channel] * flat[channel] + C1);
+            total += luminance * C2 / (variance + C2);
+        }
+        return total / 3.0;
+    }
+};
+
+// panggil fn dengan policy metrik untuk errorMethod (1-6, selain itu variance);
+// pilihan dibuat sekali, kode di dalam fn sudah terspesialisasi penuh. Sifat
+// metrik dibaca lewat policy, misalnya
+// withMetric(m, [](auto metric) { return decltype(metric)::higherIsBetter; })
+template <typename Fn>
+auto withMetric(int errorMethod, Fn&& fn) {
+    switch (errorMethod) {
+        case 2: return fn(MADMetric());
+        case 3: return fn(MaxDifferenceMetric());
+        case 4: return fn(EntropyMetric());
+        case 5: return fn(SSIMMetric());
+        case 6: return fn(BlockSSIMMetric());
+        default: return fn(VarianceMetric());
+    }
+}
+
+#endif
@@ -4,6 +4,8 @@
 #include <vector>
 #include <string>
 
+class GifEncoder;
+
 Color hitungAverageColor(const std::vector<Color>& pixels);
 
 // Variance
@@ -21,22 +23,92 @@ double hitungEntropy(const std::vector<Color>& pixels);
 // SSIM
 double hitungSSIM(const std::vector<Color>& pixels, const Color& avgColor);
 
+// PSNR (dB) gambar hasil terhadap gambar asli, MSE dirata-rata atas semua
+// channel; ukuran harus sama. Gambar identik = infinity.
+double hitungPSNR(const std::vector<std::vector<Color>>& original, const std::vector<std::vector<Color>>& result);
+// sama dengan hitungPSNR terhadap reconstructImage tree, langsung dari daun
+double hitungPSNR(const std::vector<std::vector<Color>>& original, const QuadTree& tree);
+
+// Jendela SSIM gambar: kotak 8x8 (jumlah berjalan, O(1) per jendela) atau
+// Gaussian 11x11 sigma 1.5 seperti SSIM Wang dkk. Gambar yang lebih kecil dari
+// jendela memakai kotak seukuran sisi terpendeknya.
+enum SSIMWindow { SSIM_WINDOW_BOX, SSIM_WINDOW_GAUSSIAN };
+
+// mean SSIM semua jendela (tanpa padding) per channel dan rata-ratanya
+struct ImageSSIMReport {
+    double ssim = 0.0;
+    double channel[3] = {0.0, 0.0, 0.0};
+    long long windows = 0;      // 0 = ukuran gambar tidak sama atau kosong
+};
+
+// threads: 1 = serial, 0 = semua thread pool global; hasil sama untuk semua nilai
+ImageSSIMReport hitungImageSSIM(const std::vector<std::vector<Color>>& original,
+                                const std::vector<std::vector<Color>>& result,
+                                SSIMWindow window = SSIM_WINDOW_BOX, int threads = 0);
+// hasil langsung dari daun tree lewat ScanlineRenderer, tanpa rekonstruksi penuh
+ImageSSIMReport hitungImageSSIM(const std::vector<std::vector<Color>>& original, const QuadTree& tree,
+                                SSIMWindow window = SSIM_WINDOW_BOX, int threads = 0);
+
 // konversi format
 std::string getFileExtension(const std::string& filename);
+bool isSupportedImageFormat(const std::string& extension);
+
 //image
+// data: buffer piksel interleaved dengan 1-4 channel (alpha diabaikan)
+void pixelsToImage(const unsigned char* data, int width, int height, int channels, std::vector<std::vector<Color>>& image);
+
+// hasil: buffer RGB interleaved, ukuran width * height * 3
+void imageToPixels(const std::vector<std::vector<Color>>& image, std::vector<unsigned char>& pixels);
+
 bool readImage(const std::string& filename, std::vector<std::vector<Color>>& image, int& width, int& height);
 
+// decode gambar (png, jpg, bmp, tga, ...) dari buffer byte di memori
+bool readImageFromMemory(const unsigned char* bytes, size_t size, std::vector<std::vector<Color>>& image, int& width, int& height);
+
+// alasan gagal readImage/readImageFromMemory terakhir di thread ini: file
+// tidak bisa dibuka (strerror) atau pesan decoder stb_image
+const char* imageLoadFailureReason();
+
 bool writeImage(const std::string& filename, const std::vector<std::vector<Color>>& image);
 
+// level deflate (0-9) untuk png yang ditulis lewat stbi_write_png (default stb: 8)
+void setPngCompressionLevel(int level);
+
+// encode gambar ke buffer milik pemanggil (isi lama diganti, kapasitasnya dipakai ulang)
+bool writeImageToMemory(const std::string& extension, const std::vector<std::vector<Color>>& image,
+                        std::vector<unsigned char>& out, int jpgQuality = 90);
+
+// encode buffer RGB ke format sesuai ekstensi (png, jpg, jpeg, bmp, tga), hasil ditulis ke out
+bool encodeImage(const std::string& extension, const unsigned char* pixels, int width, int height,
+                 std::vector<unsigned char>& out, int jpgQuality = 90);
+
+// Threshold yang rasio kompresi JPEG tree-nya paling dekat targetCompression
+// (toleransi 1%). Arah dan rentang threshold diambil dari policy metrik.
+// Serial (threads 1) hanya mengevaluasi tebakan secant per putaran, paling
+// banyak 8 build + encode; dengan >= 3 thread tiap putaran 3 kandidat paralel,
+// paling banyak 4 putaran. threads 0 = semua thread pool global.
 double estimateThresholdForTargetCompression(
     const std::vector<std::vector<Color>>& image, 
     int errorMethod, 
     int minBlockSize, 
     double targetCompression,
-    int originalSize
+    int originalSize,
+    int threads = 0
+);
+
+// GIF animasi rekonstruksi per kedalaman; false jika gagal menulis
+bool createQuadtreeGIF(
+    const std::string& outputGifPath,
+    const std::vector<std::vector<Color>>& originalImage,
+    QuadTree& quadtree,
+    int errorMethod,
+    double threshold,
+    int minBlockSize
 );
 
-void createQuadtreeGIF(
+// versi yang memakai ulang GifEncoder milik pemanggil (buffer tidak dialokasi ulang)
+bool createQuadtreeGIF(
+    GifEncoder& encoder,
     const std::string& outputGifPath,
     const std::vector<std::vector<Color>>& originalImage,
     QuadTree& quadtree,
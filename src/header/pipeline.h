@@ -0,0 +1,70 @@
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "encoder.h"
+#include "op.h"
+#include <vector>
+#include <string>
+
+// Satu pasangan metode/threshold dari gambar yang sama; minBlockSize dan opsi
+// encode ikut PipelineJob::options
+struct PipelineVariant {
+    int errorMethod = 1;
+    double threshold = 0.0;
+    std::string outputPath;
+    std::string gifPath;            // kosong = tanpa GIF
+};
+
+struct PipelineJob {
+    std::string inputPath;
+    std::string outputPath;
+    std::string gifPath;            // kosong = tanpa GIF
+    QtEncodeOptions options;        // options.format diabaikan, format ikut ekstensi outputPath
+    // Tidak kosong = gambar di-decode sekali lalu semua variant dibangun dalam
+    // satu QuadTree::buildMulti, menggantikan errorMethod/threshold dan
+    // outputPath/gifPath job. Budget, deadline, target kompresi, dan sampling
+    // tidak didukung di mode ini.
+    std::vector<PipelineVariant> variants;
+};
+
+struct PipelineResult {
+    std::string inputPath;
+    std::string outputPath;
+    QtStatus status = QT_OK;
+    int errorMethod = 0;
+    int totalNodes = 0;
+    int maxDepth = 0;
+    double threshold = 0.0;
+    QtBuildStop buildStop = QT_STOP_CONVERGED;
+    int leaves = 0;
+    double residualError = 0.0;     // rata-rata error daun dibobot luas
+    double quality = 0.0;           // PSNR/SSIM blok tree, hanya jika options.targetQuality aktif
+    bool qualityReached = true;
+    QuadTreeScanStats scanStats;
+    double buildMillis = 0.0;       // build quadtree, tanpa SSIM; 0 untuk job dengan variants
+    double totalMillis = 0.0;       // sejak reader mengambil job sampai file output ditulis (GIF tidak ikut)
+    bool deadlineMet = true;        // selalu true jika options.deadlineMillis 0
+    ImageSSIMReport ssim;           // hanya diisi jika PipelineOptions::ssimReport
+    size_t originalSize = 0;
+    size_t compressedSize = 0;
+};
+
+struct PipelineOptions {
+    int computeThreads = 0;         // 0 = jumlah core dikurangi thread reader dan writer
+    int writerThreads = 1;
+    size_t queueCapacity = 4;       // gambar yang boleh menunggu di tiap antrian
+    bool ssimReport = false;        // hitung SSIM hasil terhadap gambar asli di tahap compute
+    SSIMWindow ssimWindow = SSIM_WINDOW_BOX;
+};
+
+// Pipeline batch tiga tahap: reader (mmap + decode), compute (build quadtree
+// dan rekonstruksi), writer (encode, tulis file dan GIF). Antar tahap dihubungkan
+// antrian lock-free berkapasitas tetap, jadi gambar k+1 di-decode sementara
+// gambar k diproses dan gambar k-1 ditulis. Hasil urut sesuai jobs: satu per
+// job, atau satu per variant (berurutan) untuk job dengan variants.
+// options.deadlineMillis per job dihitung sejak reader mengambil job, jadi baca,
+// decode, waktu antri, build, encode, dan tulis file ikut; budget build memakai
+// waktu yang sudah terpakai saat gambar diambil tahap compute.
+std::vector<PipelineResult> runPipeline(const std::vector<PipelineJob>& jobs, const PipelineOptions& options = PipelineOptions());
+
+#endif
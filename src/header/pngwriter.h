@@ -0,0 +1,23 @@
+#ifndef PNGWRITER_H
+#define PNGWRITER_H
+
+#include "quadtree.h"
+#include <vector>
+#include <string>
+
+// Encoder PNG yang membaca daun quadtree secara langsung. Baris yang tidak
+// memuat tepi atas daun mana pun identik dengan baris sebelumnya, sehingga
+// ditulis sebagai filter Up bernilai nol tanpa dihitung ulang; baris lain
+// memilih filter Sub atau Up. Hasil di-deflate dengan DeflateEncoder.
+struct PngWriteOptions {
+    int level = 1;      // level deflate 0-9, lihat DeflateEncoder
+    int threads = 1;    // > 1: pita baris di-deflate paralel, 0 = semua thread pool global
+};
+
+bool encodeQuadtreePNG(const QuadTree& tree, std::vector<unsigned char>& out,
+                       const PngWriteOptions& options = PngWriteOptions());
+
+bool writeQuadtreePNG(const std::string& filename, const QuadTree& tree,
+                      const PngWriteOptions& options = PngWriteOptions());
+
+#endif
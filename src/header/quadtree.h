@@ -3,6 +3,7 @@
 
 #include <vector>
 #include <string>
+#include <utility>
 
 struct Color {
     unsigned char r, g, b;
@@ -11,6 +12,122 @@ struct Color {
     Color(unsigned char red, unsigned char green, unsigned char blue) : r(red), g(green), b(blue) {}
 };
 
+// blok daun hasil kompresi: posisi, ukuran, dan warna rata-rata
+struct QuadTreeLeaf {
+    int x, y;
+    int panjang, lebar;
+    Color color;
+};
+
+// Indeks daun urut baris, dibentuk setelah build. Gambar dibagi menjadi pita
+// baris [awal, akhir) yang hanya memuat tepi atas daun di baris awalnya,
+// sehingga semua baris dalam satu pita identik. Daun diurutkan menurut (y, x)
+// dan daun tiap pita bersebelahan, jadi baris pita = baris pita sebelumnya
+// yang ditimpa daun-daun pita itu dari kiri ke kanan. Hanya dibaca setelah
+// dibentuk, aman dipakai bersama oleh beberapa thread.
+class LeafRowIndex {
+public:
+    // leaves dalam urutan collectLeaves
+    void build(const std::vector<QuadTreeLeaf>& leaves, int width, int height);
+    void clear();
+
+    int getWidth() const { return width; }
+    int getHeight() const { return height; }
+    const std::vector<QuadTreeLeaf>& getLeaves() const { return leaves; }
+
+    size_t getBandCount() const { return bandRows.empty() ? 0 : bandRows.size() - 1; }
+    int bandStart(size_t band) const { return bandRows[band]; }
+    int bandEnd(size_t band) const { return bandRows[band + 1]; }
+    // daun yang dimulai di baris awal pita: [bandFirstLeaf, bandEndLeaf)
+    size_t bandFirstLeaf(size_t band) const { return bandLeaves[band]; }
+    size_t bandEndLeaf(size_t band) const { return bandLeaves[band + 1]; }
+    // pita yang memuat baris y
+    size_t bandOfRow(int y) const;
+
+private:
+    int width = 0;
+    int height = 0;
+    std::vector<QuadTreeLeaf> leaves;
+    std::vector<int> bandRows;        // baris awal tiap pita + height
+    std::vector<size_t> bandLeaves;   // daun pertama tiap pita + leaves.size()
+};
+
+// Batas build best-first; 0 = tidak dibatasi
+struct QuadTreeBudget {
+    int maxNodes = 0;           // total simpul
+    int maxLeaves = 0;          // total daun
+    size_t maxBytes = 0;        // estimasi ukuran kompresi (hitungCompressedSize)
+    double maxMillis = 0.0;     // waktu build
+    double millisPerLeaf = 0.0; // waktu yang dicadangkan dari maxMillis per daun (encode setelah build)
+    bool weightByArea = false;  // prioritas pecah = error x luas blok, bukan error saja
+
+    bool isLimited() const { return maxNodes > 0 || maxLeaves > 0 || maxBytes > 0 || maxMillis > 0; }
+};
+
+// alasan build berhenti
+enum QtBuildStop {
+    QT_STOP_CONVERGED = 0,  // semua daun sudah memenuhi threshold/minBlockSize
+    QT_STOP_NODES,
+    QT_STOP_LEAVES,
+    QT_STOP_BYTES,
+    QT_STOP_TIME
+};
+
+// Mode metrik aproksimasi untuk buildfrImage: error blok besar ditaksir dari
+// sampel terstratifikasi beserta standard error-nya. Blok dipecah atau
+// dijadikan daun berdasarkan taksiran jika threshold berada di luar pita
+// taksiran +- confidenceZ x standard error, selain itu tetap di-scan persis.
+struct QuadTreeSampling {
+    bool enabled = false;
+    int sampleSize = 1024;      // piksel sampel per blok; blok < 16 x sampleSize selalu persis
+    double confidenceZ = 3.0;   // lebar pita keyakinan; makin kecil makin agresif (dan makin sering salah)
+
+    int minBlockPixels() const { return 16 * sampleSize; }
+};
+
+// statistik scan piksel build terakhir
+struct QuadTreeScanStats {
+    long long scannedPixels = 0;    // piksel yang dibaca untuk keputusan pecah
+    long long skippedPixels = 0;    // piksel yang tidak perlu dibaca karena keputusan sudah pasti
+    int earlyExits = 0;             // simpul yang diputuskan dipecah sebelum scan selesai
+    long long sampledPixels = 0;    // piksel sampel mode aproksimasi
+    int sampledDecisions = 0;       // simpul yang diputuskan dari sampel
+    int exactFallbacks = 0;         // blok besar yang taksirannya terlalu dekat threshold
+};
+
+// satu pasangan metode/threshold untuk QuadTree::buildMulti
+struct QuadTreeConfig {
+    int errorMethod = 1;
+    double threshold = 0.0;
+    int minBlockSize = 1;
+};
+
+// Target kualitas untuk QuadTree::buildForQuality
+enum QtQualityMetric {
+    QT_QUALITY_NONE = 0,
+    QT_QUALITY_PSNR,    // dB, persis sama dengan hitungPSNR hasil rekonstruksi
+    QT_QUALITY_SSIM     // SSIM blok (metode 6) rata-rata dibobot luas daun, 0-1
+};
+
+struct QuadTreeQualityTarget {
+    QtQualityMetric metric = QT_QUALITY_NONE;
+    double minimum = 0.0;
+
+    bool isActive() const { return metric != QT_QUALITY_NONE; }
+};
+
+// hasil buildForQuality
+struct QuadTreeQuality {
+    bool reached = false;       // false = tree terhalus (minBlockSize) pun belum memenuhi target
+    double threshold = 0.0;     // buildfrImage dengan threshold ini menghasilkan tree yang sama
+    double value = 0.0;         // kualitas tree yang dihasilkan (PSNR/SSIM blok)
+};
+
+struct BlockScan;
+struct QtMultiBuild;
+class IntegralImage;
+class QuadTreeNodePool;
+
 class QuadTreeNode {
 private:
     int x, y;            
@@ -24,12 +141,9 @@ private:
     QuadTreeNode* bottomRight;
 
 public:
-    // ctor
+    // ctor; simpul dibuat lewat QuadTreeNodePool, anak tidak dimiliki induknya
     QuadTreeNode(int x, int y, int lebar, int panjang);
     
-    // dtor
-    ~QuadTreeNode();
-    
     int getX() const { return x; }
     int getY() const { return y; }
     int getlebar() const { return lebar; }
@@ -45,7 +159,8 @@ public:
     QuadTreeNode* getBottomLeft() const { return bottomLeft; }
     QuadTreeNode* getBottomRight() const { return bottomRight; }
     
-    void split();
+    // empat anak diambil dari pool milik tree
+    void split(QuadTreeNodePool& nodes);
     
     bool hasChildren() const;
 
@@ -53,13 +168,55 @@ public:
     double getError() const;
 };
 
+// Penyimpanan simpul satu QuadTree, dialokasikan per blok. reset() membuat
+// semua simpul tersedia lagi tanpa membebaskan memori, jadi membangun ulang
+// tree tidak melepas lalu mengalokasikan jutaan simpul satu per satu (free
+// massal allocator juga bisa menunda biaya ke alokasi besar berikutnya,
+// di tengah build yang dibatasi waktu). Memori dilepas di dtor.
+class QuadTreeNodePool {
+public:
+    QuadTreeNode* create(int x, int y, int panjang, int lebar);
+    void reset();
+
+private:
+    static const size_t kBlockNodes = 4096;
+    std::vector<std::vector<QuadTreeNode>> blocks;  // kapasitas tetap kBlockNodes, alamat simpul stabil
+    size_t current = 0;                             // blok yang sedang diisi
+};
+
 class QuadTree {
 private:
+    QuadTreeNodePool nodes;
     QuadTreeNode* root;
     int totalN;     
     int maxDepth;
     int realWidth;
     int realHeight;
+    double leafErrorSum;    // jumlah error x luas semua daun, diperbarui saat build
+    QuadTreeScanStats scanStats;
+    LeafRowIndex rowIndex;
+    const IntegralImage* sharedIntegral;    // dari useIntegralImage
+    IntegralImage* ownIntegral;             // dibentuk sendiri, dipakai ulang antar build
+    const IntegralImage* integral;          // tabel build yang sedang berjalan
+
+    void buildRowIndex();
+    // clear lalu buat root seukuran gambar; false jika gambar kosong
+    bool beginBuild(const std::vector<std::vector<Color>>& image);
+    template <typename Metric>
+    void evaluateNodeWith(QuadTreeNode* node, const std::vector<std::vector<Color>>& image);
+    // sums diisi jumlah channel blok node (untuk warna rata-rata induknya)
+    template <typename Metric>
+    void buildNodeWith(QuadTreeNode* node, const std::vector<std::vector<Color>>& image, double threshold,
+                       int minBlockSize, int depth, const QuadTreeSampling& sampling, BlockScan& sums);
+    // satu simpul gabungan buildMulti; active = (indeks config, simpul tree itu)
+    // untuk tree yang memuat blok ini, semuanya berukuran sama. stats = indeks
+    // statistik blok ini di piramida, -1 untuk blok kecil
+    static void buildMultiNode(QtMultiBuild& build, const std::vector<std::pair<int, QuadTreeNode*>>& active,
+                               int stats, int depth);
+    template <typename Metric>
+    void copyCutWith(const QuadTreeNode* source, QuadTreeNode* node, double threshold, int minBlockSize, int depth);
+    // isi baris [y0, y1) dari result (panjang piksel per baris)
+    void renderRows(std::vector<std::vector<Color>>& result, int panjang, int y0, int y1) const;
     
 public:
     // ctor
@@ -67,19 +224,103 @@ public:
     
     // dtor
     ~QuadTree();
-    std::vector<std::vector<Color>> reconstructImage(int lebar, int panjang);
+
+    // size per node: posisi (2 int) + ukuran (2 int) + warna (3 byte) + flag (1 byte)
+    static constexpr size_t bytesPerNode = (2 * sizeof(int)) + (2 * sizeof(int)) + (3 * sizeof(char)) + sizeof(bool);
+
+    QuadTree(const QuadTree&) = delete;
+    QuadTree& operator=(const QuadTree&) = delete;
+
+    // kosongkan tree supaya objek bisa dipakai ulang (blok simpul dan tabel
+    // integral metode 6 disimpan untuk build berikutnya, dilepas di dtor)
+    void clear();
+
+    // threads: 1 = serial, 0 = semua thread pool global; hasil sama untuk semua nilai
+    std::vector<std::vector<Color>> reconstructImage(int lebar, int panjang, int threads = 0);
+    // versi yang mengisi buffer milik pemanggil (kapasitas lama dipakai ulang)
+    void reconstructImage(std::vector<std::vector<Color>>& result, int lebar, int panjang, int threads = 0);
     
     QuadTreeNode* getRoot() const { return root; }
     int getTotalNodes() const { return totalN; }
     int getMaxDepth() const { return maxDepth; }
+    int getWidth() const { return realWidth; }
+    int getHeight() const { return realHeight; }
+    int getLeafCount() const { return (int)rowIndex.getLeaves().size(); }
+    const QuadTreeScanStats& getScanStats() const { return scanStats; }
+    // indeks daun urut baris, tersedia setelah buildfrImage
+    const LeafRowIndex& getRowIndex() const { return rowIndex; }
+
+    // Tabel milik pemanggil untuk metrik yang memakai IntegralImage (metode 6),
+    // harus dibentuk dari gambar yang sama dengan build berikutnya dan hidup
+    // selama build. Berguna jika satu gambar dibangun berkali-kali; nullptr =
+    // tabel dibentuk ulang tiap build.
+    void useIntegralImage(const IntegralImage* table) { sharedIntegral = table; }
+
+    // sampling: mode aproksimasi (lihat QuadTreeSampling), default persis
+    void buildfrImage(const std::vector<std::vector<Color>>& image, int errorMethod, double threshold, int minBlockSize,
+                      const QuadTreeSampling& sampling = QuadTreeSampling());
+    // Build best-first: daun dengan error terbesar (SSIM: 1 - ssim) selalu
+    // dipecah lebih dulu lewat max-heap, sampai tidak ada daun yang perlu
+    // dipecah menurut threshold/minBlockSize atau salah satu batas budget
+    // tercapai. Tanpa batas, tree yang dihasilkan sama dengan buildfrImage.
+    QtBuildStop buildBestFirst(const std::vector<std::vector<Color>>& image, int errorMethod, double threshold,
+                               int minBlockSize, const QuadTreeBudget& budget);
+    // buildBestFirst jika budget dibatasi, selain itu buildfrImage (sampling
+    // hanya berlaku di sini; best-first butuh error persis untuk prioritas)
+    QtBuildStop build(const std::vector<std::vector<Color>>& image, int errorMethod, double threshold,
+                      int minBlockSize, const QuadTreeBudget& budget,
+                      const QuadTreeSampling& sampling = QuadTreeSampling());
+    // Bangun trees[i] untuk configs[i] sekaligus dalam satu traversal. Statistik
+    // blok (jumlah, kuadrat, min/max, histogram jika MAD/entropy dipakai)
+    // dihitung sekali untuk seluruh gambar dalam satu pass lalu dijumlah ke atas,
+    // blok terkecil yang dipakai minimal satu tree dibaca sekali; semua metrik
+    // yang diminta dihitung dari statistik itu. Tiap tree sama dengan buildfrImage
+    // config-nya (error simpul internal selalu persis). trees harus objek yang
+    // berbeda-beda dan sebanyak configs.
+    static void buildMulti(const std::vector<std::vector<Color>>& image, const std::vector<QuadTreeConfig>& configs,
+                           const std::vector<QuadTree*>& trees);
+    // Tree paling kasar yang kualitasnya >= target, di antara tree buildfrImage
+    // errorMethod/minBlockSize untuk semua threshold. Simpul dipecah best-first
+    // urut threshold terbesar yang masih memecahnya (error terkecil simpul dan
+    // leluhurnya; SSIM: terbesar), sementara distorsi daun diperbarui dari momen
+    // blok yang dipecah dan anak-anaknya, tanpa rekonstruksi gambar. Berhenti
+    // begitu target tercapai, jadi biayanya sebanding dengan ukuran tree hasil.
+    QuadTreeQuality buildForQuality(const std::vector<std::vector<Color>>& image, int errorMethod,
+                                    const QuadTreeQualityTarget& target, int minBlockSize);
+    // Tree dari prefix source tanpa membaca gambar: simpul source disalin dan
+    // dipecah lagi selama error tersimpannya masih perlu dipecah menurut
+    // threshold/minBlockSize. Jika source dibangun dengan metode sama, threshold
+    // yang sama atau lebih ketat, minBlockSize sama atau lebih kecil, dan error
+    // simpul persis (buildMulti, buildBestFirst), hasilnya sama dengan buildfrImage.
+    void buildfrTree(const QuadTree& source, int errorMethod, double threshold, int minBlockSize);
 
-    void buildfrImage(const std::vector<std::vector<Color>>& image, int errorMethod, double threshold, int minBlockSize);
+    // Versi build dengan metrik sebagai policy template (lihat metric.h), jadi
+    // evaluasi blok dan arah threshold di-inline per metrik. Versi errorMethod di
+    // atas memilih template sekali di awal. Definisi ada di quadtreebuild.h,
+    // include header itu untuk memakai metrik sendiri.
+    // buildWith memakai exceedsThreshold metrik: blok yang pasti dipecah
+    // berhenti di-scan lebih awal, warna rata-ratanya dijumlah dari anak, dan
+    // errornya hanya batas (scan.errorBound). Daun tetap persis sama, kecuali
+    // dengan sampling aktif (simpul yang diputuskan dari sampel menyimpan taksiran).
+    template <typename Metric>
+    void buildWith(const std::vector<std::vector<Color>>& image, double threshold, int minBlockSize,
+                   const QuadTreeSampling& sampling = QuadTreeSampling());
+    template <typename Metric>
+    QtBuildStop buildBestFirstWith(const std::vector<std::vector<Color>>& image, double threshold,
+                                   int minBlockSize, const QuadTreeBudget& budget);
+    template <typename Metric>
+    QuadTreeQuality buildForQualityWith(const std::vector<std::vector<Color>>& image,
+                                        const QuadTreeQualityTarget& target, int minBlockSize);
     
     void buildNode(QuadTreeNode* node, const std::vector<std::vector<Color>>& image, int errorMethod, double threshold, int minBlockSize, int depth);
         
     void fillImage(std::vector<std::vector<Color>>& image, QuadTreeNode* node);
     int hitungCompressedSize();
-    std::vector<std::vector<Color>> reconstructImageForGIF(int depth);
+    // rata-rata error daun dibobot luas blok (SSIM: rata-rata kemiripan)
+    double hitungResidualError() const;
+    // semua daun, urutan sama dengan traversal fillImage
+    void collectLeaves(std::vector<QuadTreeLeaf>& leaves) const;
+    std::vector<std::vector<Color>> reconstructImageForGIF(int depth, int threads = 0);
     void fillImageLimited(std::vector<std::vector<Color>>& image, QuadTreeNode* node, int maxDepth, int currentDepth);
 };
 
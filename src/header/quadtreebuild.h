@@ -0,0 +1,343 @@
+#ifndef QUADTREEBUILD_H
+#define QUADTREEBUILD_H
+
+#include "quadtree.h"
+#include "metric.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <queue>
+
+// Definisi build quadtree yang diparameterkan metrik. Metrik bawaan sudah
+// di-instansiasi di quadtree.cpp; header ini hanya perlu di-include untuk
+// membangun tree dengan metrik sendiri, misalnya tree.buildWith<MyMetric>(...).
+
+// true jika node perlu dipecah: belum mencapai minBlockSize dan error belum
+// memenuhi threshold
+template <typename Metric>
+inline bool qtNeedsSplit(const QuadTreeNode* node, double threshold, int minBlockSize) {
+    if (node->getpanjang() <= minBlockSize || node->getlebar() <= minBlockSize) return false;
+    double error = node->getError();
+    return Metric::higherIsBetter ? error < threshold : error > threshold;
+}
+
+template <typename Metric>
+inline double qtSplitPriority(const QuadTreeNode* node, bool weightByArea) {
+    double priority = Metric::higherIsBetter ? 1.0 - node->getError() : node->getError();
+    if (weightByArea) priority *= (double)node->getpanjang() * node->getlebar();
+    return priority;
+}
+
+inline ImageBlock qtNodeBlock(const QuadTreeNode* node, const std::vector<std::vector<Color>>& image,
+                              const IntegralImage* integral = nullptr) {
+    // potong ke batas gambar
+    int panjang = std::max(0, std::min(node->getpanjang(), (int)image[0].size() - node->getX()));
+    int lebar = std::max(0, std::min(node->getlebar(), (int)image.size() - node->getY()));
+    return ImageBlock{image, node->getX(), node->getY(), panjang, lebar, integral};
+}
+
+// Tabel integral untuk build metrik usesIntegral: milik pemanggil jika ada,
+// selain itu dibentuk di own (satu pass gambar, dihitung sebagai piksel dibaca)
+template <typename Metric>
+inline const IntegralImage* qtPrepareIntegral(const IntegralImage* shared, IntegralImage*& own,
+                                              const std::vector<std::vector<Color>>& image,
+                                              QuadTreeScanStats& stats) {
+    if (!Metric::usesIntegral) return nullptr;
+    if (shared && !shared->empty()) return shared;
+    if (!own) own = new IntegralImage();
+    own->build(image);
+    stats.scannedPixels += (long long)own->getWidth() * own->getHeight();
+    return own;
+}
+
+// keputusan mode aproksimasi untuk satu blok
+enum QtSampledDecision { QT_SAMPLED_SPLIT, QT_SAMPLED_LEAF, QT_SAMPLED_UNSURE };
+
+// Taksir error blok dari sampel; UNSURE jika threshold berada dalam pita
+// taksiran +- confidenceZ x standard error atau metrik tidak bisa ditaksir
+template <typename Metric>
+inline QtSampledDecision qtSampledDecision(const ImageBlock& block, double threshold, const QuadTreeSampling& sampling,
+                                           std::vector<Color>& sample, ErrorEstimate& estimate) {
+    sampleBlock(block, sampling.sampleSize, sample);
+    estimate = Metric::estimateError(sample);
+    if (!estimate.valid) return QT_SAMPLED_UNSURE;
+    double low = estimate.value - sampling.confidenceZ * estimate.standardError;
+    double high = estimate.value + sampling.confidenceZ * estimate.standardError;
+    if (Metric::higherIsBetter ? high < threshold : low > threshold) return QT_SAMPLED_SPLIT;
+    if (Metric::higherIsBetter ? low >= threshold : high <= threshold) return QT_SAMPLED_LEAF;
+    return QT_SAMPLED_UNSURE;
+}
+
+template <typename Metric>
+void QuadTree::evaluateNodeWith(QuadTreeNode* node, const std::vector<std::vector<Color>>& image) {
+    ImageBlock block = qtNodeBlock(node, image, integral);
+    BlockScan scan;
+    Metric::blockSums(block, scan);
+    Color avgColor = scan.average(block.count());
+    node->setAvgColor(avgColor);
+    node->setError(Metric::hitungError(block, avgColor));
+    if (!integral) scanStats.scannedPixels += block.count();
+}
+
+template <typename Metric>
+void QuadTree::buildNodeWith(QuadTreeNode* node, const std::vector<std::vector<Color>>& image, double threshold,
+                             int minBlockSize, int currentDepth, const QuadTreeSampling& sampling,
+                             BlockScan& sums) {
+    if (!node) return;
+
+    this->maxDepth = std::max(this->maxDepth, currentDepth);
+    ImageBlock block = qtNodeBlock(node, image, integral);
+    BlockScan scan;
+
+    // Ini pengecekan minBlockSize dan threshold-nya
+    bool canSplit = node->getpanjang() > minBlockSize && node->getlebar() > minBlockSize;
+    bool earlySplit = false;
+    QtSampledDecision sampled = QT_SAMPLED_UNSURE;
+    ErrorEstimate estimate;
+    if (Metric::canEstimate && canSplit && sampling.enabled && block.count() >= sampling.minBlockPixels()) {
+        std::vector<Color> sample;
+        sampled = qtSampledDecision<Metric>(block, threshold, sampling, sample, estimate);
+        scanStats.sampledPixels += (long long)sample.size();
+        if (sampled == QT_SAMPLED_UNSURE) scanStats.exactFallbacks++;
+        else scanStats.sampledDecisions++;
+    }
+    if (sampled == QT_SAMPLED_SPLIT) {
+        earlySplit = true;
+        scan.errorBound = estimate.value;
+    } else if (sampled == QT_SAMPLED_LEAF || !canSplit) {
+        Metric::blockSums(block, scan);
+    } else {
+        earlySplit = Metric::exceedsThreshold(block, threshold, scan);
+    }
+    scanStats.scannedPixels += scan.scanned;
+
+    if (sampled == QT_SAMPLED_LEAF) {
+        // warna rata-rata tetap persis, hanya error yang ditaksir
+        node->setAvgColor(scan.average(block.count()));
+        node->setError(estimate.value);
+        node->setLeaf(true);
+        leafErrorSum += estimate.value * node->getpanjang() * node->getlebar();
+        sums.sumR += scan.sumR;
+        sums.sumG += scan.sumG;
+        sums.sumB += scan.sumB;
+        return;
+    }
+
+    if (earlySplit) {
+        scanStats.skippedPixels += block.count() - scan.scanned;
+        scanStats.earlyExits++;
+        node->setError(scan.errorBound);
+    } else {
+        Color avgColor = scan.average(block.count());
+        node->setAvgColor(avgColor);
+        node->setError(Metric::hitungError(block, avgColor));
+        if (!qtNeedsSplit<Metric>(node, threshold, minBlockSize)) {
+            node->setLeaf(true);
+            leafErrorSum += node->getError() * node->getpanjang() * node->getlebar();
+            sums.sumR += scan.sumR;
+            sums.sumG += scan.sumG;
+            sums.sumB += scan.sumB;
+            return;
+        }
+    }
+
+    node->split(nodes);
+    totalN += 4;
+
+    BlockScan childSums;
+    buildNodeWith<Metric>(node->getTopLeft(), image, threshold, minBlockSize, currentDepth + 1, sampling, childSums);
+    buildNodeWith<Metric>(node->getTopRight(), image, threshold, minBlockSize, currentDepth + 1, sampling, childSums);
+    buildNodeWith<Metric>(node->getBottomLeft(), image, threshold, minBlockSize, currentDepth + 1, sampling, childSums);
+    buildNodeWith<Metric>(node->getBottomRight(), image, threshold, minBlockSize, currentDepth + 1, sampling, childSums);
+    // anak menutup blok tepat sekali, jadi jumlahnya = jumlah blok ini
+    if (earlySplit) node->setAvgColor(childSums.average(block.count()));
+    sums.sumR += childSums.sumR;
+    sums.sumG += childSums.sumG;
+    sums.sumB += childSums.sumB;
+}
+
+template <typename Metric>
+void QuadTree::buildWith(const std::vector<std::vector<Color>>& image, double threshold, int minBlockSize,
+                         const QuadTreeSampling& sampling) {
+    if (!beginBuild(image)) return;
+    integral = qtPrepareIntegral<Metric>(sharedIntegral, ownIntegral, image, scanStats);
+    BlockScan sums;
+    buildNodeWith<Metric>(root, image, threshold, minBlockSize, 0, sampling, sums);
+    integral = nullptr;
+    buildRowIndex();
+}
+
+template <typename Metric>
+QtBuildStop QuadTree::buildBestFirstWith(const std::vector<std::vector<Color>>& image, double threshold,
+                                         int minBlockSize, const QuadTreeBudget& budget) {
+    // jam budget mulai setelah tree sebelumnya dikosongkan
+    if (!beginBuild(image)) return QT_STOP_CONVERGED;
+    auto start = std::chrono::steady_clock::now();
+
+    // max-heap daun yang masih perlu dipecah; prioritas sama dipecah sesuai
+    // urutan masuk supaya hasilnya deterministik
+    struct Candidate {
+        double priority;
+        size_t order;
+        QuadTreeNode* node;
+        int depth;
+        bool operator<(const Candidate& other) const {
+            return priority != other.priority ? priority < other.priority : order > other.order;
+        }
+    };
+    std::priority_queue<Candidate> heap;
+    size_t order = 0;
+    double evaluatedPixels = 0.0;
+    integral = qtPrepareIntegral<Metric>(sharedIntegral, ownIntegral, image, scanStats);
+    auto evalStart = std::chrono::steady_clock::now();  // tanpa waktu membentuk tabel integral
+    auto addLeaf = [&](QuadTreeNode* node, int depth) {
+        maxDepth = std::max(maxDepth, depth);
+        evaluatedPixels += (double)node->getpanjang() * node->getlebar();
+        evaluateNodeWith<Metric>(node, image);
+        leafErrorSum += node->getError() * node->getpanjang() * node->getlebar();
+        if (qtNeedsSplit<Metric>(node, threshold, minBlockSize)) {
+            heap.push({qtSplitPriority<Metric>(node, budget.weightByArea), order++, node, depth});
+        }
+    };
+    addLeaf(root, 0);
+
+    QtBuildStop stop = QT_STOP_CONVERGED;
+    while (!heap.empty()) {
+        // satu pemecahan menambah 4 simpul dan 3 daun
+        int leaves = (totalN - 1) / 4 * 3 + 1;
+        if (budget.maxNodes > 0 && totalN + 4 > budget.maxNodes) {
+            stop = QT_STOP_NODES;
+            break;
+        }
+        if (budget.maxLeaves > 0 && leaves + 3 > budget.maxLeaves) {
+            stop = QT_STOP_LEAVES;
+            break;
+        }
+        if (budget.maxBytes > 0 && (size_t)(totalN + 4) * bytesPerNode > budget.maxBytes) {
+            stop = QT_STOP_BYTES;
+            break;
+        }
+        Candidate worst = heap.top();
+        if (budget.maxMillis > 0) {
+            // waktu evaluasi sebanding dengan piksel blok, jadi biaya pemecahan
+            // berikutnya diperkirakan dari laju evaluasi sejauh ini
+            auto now = std::chrono::steady_clock::now();
+            double elapsed = std::chrono::duration<double, std::milli>(now - start).count();
+            double evalMillis = std::chrono::duration<double, std::milli>(now - evalStart).count();
+            double splitMillis = evalMillis / evaluatedPixels * worst.node->getpanjang() * worst.node->getlebar();
+            if (elapsed + splitMillis + (leaves + 3) * budget.millisPerLeaf >= budget.maxMillis) {
+                stop = QT_STOP_TIME;
+                break;
+            }
+        }
+
+        heap.pop();
+        worst.node->split(nodes);
+        totalN += 4;
+        leafErrorSum -= worst.node->getError() * worst.node->getpanjang() * worst.node->getlebar();
+        addLeaf(worst.node->getTopLeft(), worst.depth + 1);
+        addLeaf(worst.node->getTopRight(), worst.depth + 1);
+        addLeaf(worst.node->getBottomLeft(), worst.depth + 1);
+        addLeaf(worst.node->getBottomRight(), worst.depth + 1);
+    }
+
+    integral = nullptr;
+    buildRowIndex();
+    return stop;
+}
+
+// distorsi satu daun untuk target kualitas dari momen bloknya: jumlah selisih
+// kuadrat semua channel (PSNR) atau SSIM blok x jumlah piksel
+inline double qtQualityDistortion(QtQualityMetric metric, const BlockMoments& moments, const Color& avgColor) {
+    if (metric == QT_QUALITY_SSIM) return BlockSSIMMetric::hitungError(moments, avgColor) * moments.count;
+    return moments.sumSqrDiff(0, avgColor.r) + moments.sumSqrDiff(1, avgColor.g) + moments.sumSqrDiff(2, avgColor.b);
+}
+
+template <typename Metric>
+QuadTreeQuality QuadTree::buildForQualityWith(const std::vector<std::vector<Color>>& image,
+                                              const QuadTreeQualityTarget& target, int minBlockSize) {
+    QuadTreeQuality result;
+    if (!beginBuild(image)) return result;
+
+    // buildfrImage(threshold t) memecah simpul tepat jika simpul dan semua
+    // leluhurnya melewati t, yaitu jika cut = error terkecil di jalur itu > t
+    // (SSIM: terbesar < t). Heap urut cut dari yang paling longgar, jadi setelah
+    // semua simpul dengan cut sama dipecah, tree = buildfrImage(cut teratas heap)
+    struct Candidate {
+        double cut;
+        size_t order;
+        QuadTreeNode* node;
+        int depth;
+        double distortion;
+        bool operator<(const Candidate& other) const {
+            if (cut != other.cut) return Metric::higherIsBetter ? cut > other.cut : cut < other.cut;
+            return order > other.order;
+        }
+    };
+    std::priority_queue<Candidate> heap;
+    size_t order = 0;
+    // threshold paling ketat; simpul yang tidak terpecah di sini tidak masuk heap
+    const double finest = Metric::higherIsBetter ? 1.0 : 0.0;
+    double pixels = (double)realWidth * realHeight;
+    double distortion = 0.0;    // jumlah distorsi semua daun (qtQualityDistortion)
+
+    auto quality = [&]() {
+        if (target.metric == QT_QUALITY_SSIM) return distortion / pixels;
+        // sama dengan hitungPSNR
+        if (distortion == 0.0) return (double)INFINITY;
+        double mse = distortion / (pixels * 3);
+        return 10.0 * std::log10(255.0 * 255.0 / mse);
+    };
+
+    integral = qtPrepareIntegral<Metric>(sharedIntegral, ownIntegral, image, scanStats);
+    auto addLeaf = [&](QuadTreeNode* node, int depth, double parentCut) {
+        maxDepth = std::max(maxDepth, depth);
+        ImageBlock block = qtNodeBlock(node, image, integral);
+        BlockMoments moments;
+        moments.build(block);
+        scanStats.scannedPixels += block.count();
+        Color avgColor = moments.average();
+        node->setAvgColor(avgColor);
+        node->setError(Metric::hitungError(block, avgColor));
+        leafErrorSum += node->getError() * node->getpanjang() * node->getlebar();
+        double part = qtQualityDistortion(target.metric, moments, avgColor);
+        distortion += part;
+
+        double cut = Metric::higherIsBetter ? std::max(parentCut, node->getError())
+                                            : std::min(parentCut, node->getError());
+        bool canSplit = node->getpanjang() > minBlockSize && node->getlebar() > minBlockSize;
+        if (canSplit && (Metric::higherIsBetter ? cut < finest : cut > finest)) {
+            heap.push({cut, order++, node, depth, part});
+        }
+    };
+    addLeaf(root, 0, Metric::higherIsBetter ? -INFINITY : INFINITY);
+
+    bool splitAny = false;
+    double lastCut = 0.0;
+    while (!heap.empty()) {
+        Candidate next = heap.top();
+        // simpul dengan cut sama ikut dipecah, satu threshold memecah semuanya
+        if (quality() >= target.minimum && !(splitAny && next.cut == lastCut)) break;
+
+        heap.pop();
+        next.node->split(nodes);
+        totalN += 4;
+        leafErrorSum -= next.node->getError() * next.node->getpanjang() * next.node->getlebar();
+        distortion -= next.distortion;
+        addLeaf(next.node->getTopLeft(), next.depth + 1, next.cut);
+        addLeaf(next.node->getTopRight(), next.depth + 1, next.cut);
+        addLeaf(next.node->getBottomLeft(), next.depth + 1, next.cut);
+        addLeaf(next.node->getBottomRight(), next.depth + 1, next.cut);
+        splitAny = true;
+        lastCut = next.cut;
+    }
+
+    result.value = quality();
+    result.reached = result.value >= target.minimum;
+    result.threshold = heap.empty() ? finest : heap.top().cut;
+    integral = nullptr;
+    buildRowIndex();
+    return result;
+}
+
+#endif
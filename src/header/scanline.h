@@ -0,0 +1,36 @@
+#ifndef SCANLINE_H
+#define SCANLINE_H
+
+#include "quadtree.h"
+#include <vector>
+#include <cstddef>
+
+// Iterator baris RGB dari LeafRowIndex (QuadTree::getRowIndex) dengan memori
+// kerja dua baris. Beberapa renderer boleh membaca indeks yang sama dari
+// thread berbeda.
+class ScanlineRenderer {
+public:
+    // baris pertama yang dikembalikan nextRow() adalah startRow
+    explicit ScanlineRenderer(const LeafRowIndex& index, int startRow = 0);
+
+    // baris berikutnya (panjang * 3 byte), valid sampai nextRow() berikutnya
+    const unsigned char* nextRow();
+    // baris terakhir dari nextRow() berbeda dari baris sebelumnya
+    bool rowChanged() const { return changed; }
+    // isi baris sebelumnya; hanya valid jika rowChanged() dan baris > 0
+    const unsigned char* previousRow() const { return previous.data(); }
+    // nomor baris yang akan dikembalikan nextRow() berikutnya
+    int nextRowIndex() const { return y; }
+
+private:
+    void paint(const QuadTreeLeaf& leaf);
+
+    const LeafRowIndex& index;
+    size_t nextBand = 0;
+    int y = 0;
+    bool changed = false;
+    std::vector<unsigned char> row;
+    std::vector<unsigned char> previous;
+};
+
+#endif
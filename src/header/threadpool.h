@@ -0,0 +1,42 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Thread pool sederhana untuk kerja data-paralel. Pemanggil parallelFor ikut
+// mengerjakan indeks, jadi parallelFor boleh dipanggil bersarang dari worker.
+class ThreadPool {
+public:
+    // threads <= 0: sebanyak core
+    explicit ThreadPool(int threads = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // jumlah thread yang bisa bekerja bersamaan (worker + pemanggil)
+    int size() const { return (int)workers.size() + 1; }
+
+    // jalankan fn(i) untuk i di [0, count), blok sampai semuanya selesai.
+    // maxParallel membatasi banyak thread yang dipakai (0 = semua).
+    void parallelFor(size_t count, const std::function<void(size_t)>& fn, int maxParallel = 0);
+
+    static ThreadPool& global();
+
+private:
+    void workerLoop();
+
+    std::vector<std::thread> workers;
+    std::deque<std::function<void()>> tasks;
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool stopping = false;
+};
+
+#endif
@@ -0,0 +1,205 @@
+#include "header/imagewriter.h"
+#include "header/scanline.h"
+#include "header/pngwriter.h"
+#include "header/jpegwriter.h"
+#include "header/op.h"
+#include <cstdint>
+#include <cstdio>
+
+namespace {
+
+void putU16LE(unsigned char* p, uint32_t v) {
+    p[0] = (unsigned char)v;
+    p[1] = (unsigned char)(v >> 8);
+}
+
+void putU32LE(unsigned char* p, uint32_t v) {
+    putU16LE(p, v);
+    putU16LE(p + 2, v >> 16);
+}
+
+// BMP 24-bit tanpa kompresi; tinggi negatif = baris disimpan dari atas,
+// jadi baris bisa dikirim ke sink sesuai urutan render
+template <typename Sink>
+bool streamBMP(const QuadTree& tree, Sink& sink) {
+    const LeafRowIndex& index = tree.getRowIndex();
+    int width = index.getWidth();
+    int height = index.getHeight();
+    size_t rowBytes = ((size_t)width * 3 + 3) & ~(size_t)3;
+    uint64_t imageBytes = (uint64_t)rowBytes * height;
+    if (imageBytes + 54 > 0xFFFFFFFFu) return false;
+
+    unsigned char header[54] = {0};
+    header[0] = 'B';
+    header[1] = 'M';
+    putU32LE(header + 2, (uint32_t)(imageBytes + 54));
+    putU32LE(header + 10, 54);
+    putU32LE(header + 14, 40);
+    putU32LE(header + 18, (uint32_t)width);
+    putU32LE(header + 22, (uint32_t)-height);
+    putU16LE(header + 26, 1);
+    putU16LE(header + 28, 24);
+    putU32LE(header + 34, (uint32_t)imageBytes);
+    if (!sink(header, sizeof(header))) return false;
+
+    ScanlineRenderer renderer(index);
+    std::vector<unsigned char> line(rowBytes, 0);
+    for (int y = 0; y < height; y++) {
+        const unsigned char* row = renderer.nextRow();
+        if (renderer.rowChanged()) {
+            for (int x = 0; x < width; x++) {
+                line[x * 3] = row[x * 3 + 2];
+                line[x * 3 + 1] = row[x * 3 + 1];
+                line[x * 3 + 2] = row[x * 3];
+            }
+        }
+        if (!sink(line.data(), line.size())) return false;
+    }
+    return true;
+}
+
+// paket RLE TGA untuk satu baris (tidak melewati batas baris), piksel BGR
+void encodeTgaRow(const unsigned char* row, int width, std::vector<unsigned char>& packets) {
+    packets.clear();
+    auto same = [&](int a, int b) {
+        return row[a * 3] == row[b * 3] && row[a * 3 + 1] == row[b * 3 + 1] && row[a * 3 + 2] == row[b * 3 + 2];
+    };
+    auto pushPixel = [&](int i) {
+        packets.push_back(row[i * 3 + 2]);
+        packets.push_back(row[i * 3 + 1]);
+        packets.push_back(row[i * 3]);
+    };
+
+    int i = 0;
+    while (i < width) {
+        int run = 1;
+        while (i + run < width && run < 128 && same(i, i + run)) run++;
+        if (run > 1) {
+            packets.push_back((unsigned char)(0x80 | (run - 1)));
+            pushPixel(i);
+            i += run;
+            continue;
+        }
+        // paket mentah sampai bertemu dua piksel kembar berurutan
+        int count = 1;
+        while (i + count < width && count < 128 &&
+               !(i + count + 1 < width && same(i + count, i + count + 1))) {
+            count++;
+        }
+        packets.push_back((unsigned char)(count - 1));
+        for (int k = 0; k < count; k++) pushPixel(i + k);
+        i += count;
+    }
+}
+
+// TGA truecolor RLE, origin kiri atas
+template <typename Sink>
+bool streamTGA(const QuadTree& tree, Sink& sink) {
+    const LeafRowIndex& index = tree.getRowIndex();
+    int width = index.getWidth();
+    int height = index.getHeight();
+    if (width > 0xFFFF || height > 0xFFFF) return false;
+
+    unsigned char header[18] = {0};
+    header[2] = 10;     // truecolor, RLE
+    putU16LE(header + 12, (uint32_t)width);
+    putU16LE(header + 14, (uint32_t)height);
+    header[16] = 24;
+    header[17] = 0x20;  // top-down
+    if (!sink(header, sizeof(header))) return false;
+
+    ScanlineRenderer renderer(index);
+    std::vector<unsigned char> packets;
+    for (int y = 0; y < height; y++) {
+        const unsigned char* row = renderer.nextRow();
+        if (renderer.rowChanged()) encodeTgaRow(row, width, packets);
+        if (!sink(packets.data(), packets.size())) return false;
+    }
+    return true;
+}
+
+}
+
+bool encodeQuadtreeImage(const std::string& extension, const QuadTree& tree, std::vector<unsigned char>& out,
+                         const ImageWriteOptions& options) {
+    if (!tree.getRoot() || tree.getWidth() <= 0 || tree.getHeight() <= 0) return false;
+
+    if (extension == "png") {
+        PngWriteOptions pngOptions;
+        pngOptions.level = options.pngLevel;
+        pngOptions.threads = options.threads;
+        return encodeQuadtreePNG(tree, out, pngOptions);
+    }
+    if (extension == "jpg" || extension == "jpeg") {
+        JpegWriteOptions jpgOptions;
+        jpgOptions.quality = options.jpgQuality;
+        jpgOptions.threads = options.threads;
+        return encodeQuadtreeJPEG(tree, out, jpgOptions);
+    }
+
+    out.clear();
+    auto append = [&](const unsigned char* data, size_t size) {
+        out.insert(out.end(), data, data + size);
+        return true;
+    };
+    if (extension == "bmp") return streamBMP(tree, append);
+    if (extension == "tga") return streamTGA(tree, append);
+    return false;
+}
+
+bool writeQuadtreeImage(const std::string& filename, const QuadTree& tree, const ImageWriteOptions& options) {
+    std::string extension = getFileExtension(filename);
+    if (!isSupportedImageFormat(extension)) return false;
+    if (!tree.getRoot() || tree.getWidth() <= 0 || tree.getHeight() <= 0) return false;
+
+    if (extension == "bmp" || extension == "tga") {
+        FILE* f = std::fopen(filename.c_str(), "wb");
+        if (!f) return false;
+        auto write = [&](const unsigned char* data, size_t size) {
+            return std::fwrite(data, 1, size, f) == size;
+        };
+        bool ok = extension == "bmp" ? streamBMP(tree, write) : streamTGA(tree, write);
+        return std::fclose(f) == 0 && ok;
+    }
+
+    std::vector<unsigned char> data;
+    if (!encodeQuadtreeImage(extension, tree, data, options)) return false;
+
+    FILE* f = std::fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+EncodeCostEstimate estimateEncodeCost(const std::string& extension, int width, int height,
+                                      const ImageWriteOptions& options) {
+    // ns per piksel dan ns per daun, bmp/tga sebagai default
+    double nsPerPixel = 1.5;
+    double nsPerLeaf = 35.0;
+    if (extension == "png") {
+        if (options.pngLevel <= 0) {
+            nsPerPixel = 2.0;
+            nsPerLeaf = 40.0;
+        } else if (options.pngLevel == 1) {
+            nsPerPixel = 8.0;
+            nsPerLeaf = 140.0;
+        } else if (options.pngLevel <= 6) {
+            nsPerPixel = 27.0;
+            nsPerLeaf = 700.0;
+        } else {
+            nsPerPixel = 360.0;
+            nsPerLeaf = 4100.0;
+        }
+    } else if (extension == "jpg" || extension == "jpeg") {
+        nsPerPixel = 4.5;
+        nsPerLeaf = 45.0;
+    }
+    // indeks daun (collectLeaves + sort per baris) dibentuk di akhir build
+    const double nsPerLeafIndex = 120.0;
+
+    EncodeCostEstimate estimate;
+    estimate.millisFixed = (double)width * height * nsPerPixel * 1e-6;
+    estimate.millisPerLeaf = (nsPerLeaf + nsPerLeafIndex) * 1e-6;
+    estimate.millisPerLeafIndex = nsPerLeafIndex * 1e-6;
+    return estimate;
+}
@@ -0,0 +1,36 @@
+#include "header/integralimage.h"
+#include <algorithm>
+
+void IntegralImage::build(const std::vector<std::vector<Color>>& image) {
+    height = (int)image.size();
+    width = height > 0 ? (int)image[0].size() : 0;
+    size_t stride = (size_t)(width + 1) * kCellValues;
+    table.resize(stride * (height + 1));
+    // baris 0 dan kolom 0 selalu nol
+    std::fill(table.begin(), table.begin() + stride, 0);
+
+    for (int y = 0; y < height; ++y) {
+        const Color* pixel = image[y].data();
+        const uint32_t* above = table.data() + (size_t)y * stride;
+        uint32_t* row = table.data() + (size_t)(y + 1) * stride;
+        std::fill(row, row + kCellValues, 0);
+        uint32_t running[kCellValues] = {0, 0, 0, 0, 0, 0};
+        for (int x = 0; x < width; ++x) {
+            uint32_t r = pixel[x].r, g = pixel[x].g, b = pixel[x].b;
+            running[0] += r;
+            running[1] += g;
+            running[2] += b;
+            running[3] += r * r;
+            running[4] += g * g;
+            running[5] += b * b;
+            size_t at = (size_t)(x + 1) * kCellValues;
+            for (int i = 0; i < kCellValues; ++i) row[at + i] = above[at + i] + running[i];
+        }
+    }
+}
+
+void IntegralImage::clear() {
+    width = 0;
+    height = 0;
+    table.clear();
+}
@@ -0,0 +1,828 @@
+#include "header/jpegwriter.h"
+#include "header/threadpool.h"
+#include "header/scanline.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#define QUADTREE_JPEG_AVX2 1
+#include <immintrin.h>
+#else
+#define QUADTREE_JPEG_AVX2 0
+#endif
+
+namespace {
+
+const unsigned char zigzag[64] = {
+    0, 1, 5, 6, 14, 15, 27, 28, 2, 4, 7, 13, 16, 26, 29, 42, 3, 8, 12, 17, 25, 30, 41, 43, 9, 11, 18,
+    24, 31, 40, 44, 53, 10, 19, 23, 32, 39, 45, 52, 54, 20, 22, 33, 38, 46, 51, 55, 60, 21, 34, 37, 47, 50, 56, 59, 61, 35, 36, 48, 49, 57, 58, 62, 63
+};
+
+// tabel standar JPEG Annex K
+const int lumaQuant[64] = {
+    16, 11, 10, 16, 24, 40, 51, 61, 12, 12, 14, 19, 26, 58, 60, 55, 14, 13, 16, 24, 40, 57, 69, 56, 14, 17, 22, 29, 51, 87, 80, 62, 18, 22,
+    37, 56, 68, 109, 103, 77, 24, 35, 55, 64, 81, 104, 113, 92, 49, 64, 78, 87, 103, 121, 120, 101, 72, 92, 95, 98, 112, 100, 103, 99
+};
+const int chromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99, 18, 21, 26, 66, 99, 99, 99, 99, 24, 26, 56, 99, 99, 99, 99, 99, 47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99, 99
+};
+
+const unsigned char dcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const unsigned char dcLumaValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+const unsigned char acLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+const unsigned char acLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07, 0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08,
+    0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0, 0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59,
+    0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6,
+    0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa
+};
+const unsigned char dcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+const unsigned char dcChromaValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+const unsigned char acChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+const unsigned char acChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71, 0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91,
+    0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0, 0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58,
+    0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4,
+    0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa
+};
+
+// faktor skala DCT AAN
+const float aanScale[8] = {
+    1.0f * 2.828427125f, 1.387039845f * 2.828427125f, 1.306562965f * 2.828427125f, 1.175875602f * 2.828427125f,
+    1.0f * 2.828427125f, 0.785694958f * 2.828427125f, 0.541196100f * 2.828427125f, 0.275899379f * 2.828427125f
+};
+
+struct HuffmanCode {
+    uint16_t code;
+    uint8_t length;
+};
+
+void buildHuffman(const unsigned char bits[16], const unsigned char* values, HuffmanCode table[256]) {
+    int code = 0;
+    int k = 0;
+    for (int length = 1; length <= 16; length++) {
+        for (int i = 0; i < bits[length - 1]; i++) {
+            table[values[k++]] = {(uint16_t)code++, (uint8_t)length};
+        }
+        code <<= 1;
+    }
+}
+
+struct JpegTables {
+    unsigned char lumaTable[64];     // urutan zigzag, untuk segmen DQT
+    unsigned char chromaTable[64];
+    float lumaScale[64];             // 1 / (kuantisasi * skala AAN), urutan baris
+    float chromaScale[64];
+    HuffmanCode dcLuma[256], acLuma[256], dcChroma[256], acChroma[256];
+    bool subsample;
+
+    explicit JpegTables(int quality) {
+        subsample = quality <= 90;
+        quality = std::max(1, std::min(quality, 100));
+        quality = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+        for (int i = 0; i < 64; i++) {
+            int luma = (lumaQuant[i] * quality + 50) / 100;
+            int chroma = (chromaQuant[i] * quality + 50) / 100;
+            lumaTable[zigzag[i]] = (unsigned char)std::max(1, std::min(luma, 255));
+            chromaTable[zigzag[i]] = (unsigned char)std::max(1, std::min(chroma, 255));
+        }
+        for (int row = 0, k = 0; row < 8; row++) {
+            for (int col = 0; col < 8; col++, k++) {
+                lumaScale[k] = 1 / (lumaTable[zigzag[k]] * aanScale[row] * aanScale[col]);
+                chromaScale[k] = 1 / (chromaTable[zigzag[k]] * aanScale[row] * aanScale[col]);
+            }
+        }
+
+        buildHuffman(dcLumaBits, dcLumaValues, dcLuma);
+        buildHuffman(acLumaBits, acLumaValues, acLuma);
+        buildHuffman(dcChromaBits, dcChromaValues, dcChroma);
+        buildHuffman(acChromaBits, acChromaValues, acChroma);
+    }
+};
+
+// penulis bit entropy-coded segment: buffer 64 bit yang dikeluarkan per 32 bit
+// langsung ke memori out (dipesan lewat reserve), byte 0xFF diikuti 0x00
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<unsigned char>& out) : out(out), pos(out.size()) {}
+
+    // pastikan masih ada ruang untuk bytes byte lagi
+    void reserve(size_t bytes) {
+        if (pos + bytes > out.size()) out.resize(std::max(out.size() * 2, pos + bytes));
+    }
+
+    // length <= 32
+    void put(uint32_t bits, int length) {
+        buffer = (buffer << length) | bits;
+        count += length;
+        if (count >= 32) {
+            count -= 32;
+            putWord((uint32_t)(buffer >> count));
+        }
+    }
+
+    void put(const HuffmanCode& h) { put(h.code, h.length); }
+
+    // sisa bit diisi 1 sampai batas byte, out dipotong ke ukuran sebenarnya
+    void finish() {
+        int pad = (8 - count % 8) % 8;
+        if (pad) put((1u << pad) - 1, pad);
+        while (count >= 8) {
+            count -= 8;
+            putByte((unsigned char)(buffer >> count));
+        }
+        out.resize(pos);
+    }
+
+private:
+    void putByte(unsigned char c) {
+        out[pos++] = c;
+        if (c == 0xFF) out[pos++] = 0;
+    }
+
+    void putWord(uint32_t word) {
+        // tanpa byte 0xFF keempat byte bisa disalin sekaligus
+        uint32_t inverted = ~word;
+        if (((inverted - 0x01010101u) & ~inverted & 0x80808080u) == 0) {
+            unsigned char* p = out.data() + pos;
+            p[0] = (unsigned char)(word >> 24);
+            p[1] = (unsigned char)(word >> 16);
+            p[2] = (unsigned char)(word >> 8);
+            p[3] = (unsigned char)word;
+            pos += 4;
+        } else {
+            putByte((unsigned char)(word >> 24));
+            putByte((unsigned char)(word >> 16));
+            putByte((unsigned char)(word >> 8));
+            putByte((unsigned char)word);
+        }
+    }
+
+    std::vector<unsigned char>& out;
+    size_t pos;
+    uint64_t buffer = 0;
+    int count = 0;
+};
+
+// batas atas byte satu MCU (6 blok, termasuk byte stuffing)
+const size_t MAX_MCU_BYTES = 4096;
+
+// state satu komponen warna selama scan
+struct Component {
+    const float* scale;
+    const HuffmanCode* dc;
+    const HuffmanCode* ac;
+    int lastDC = 0;
+};
+
+int roundCoefficient(float v) {
+    return (int)(v < 0 ? v - 0.5f : v + 0.5f);
+}
+
+int bitLength(int value) {
+    unsigned magnitude = (unsigned)std::abs(value);
+#if defined(__GNUC__) || defined(__clang__)
+    return magnitude ? 32 - __builtin_clz(magnitude) : 0;
+#else
+    int length = 0;
+    while (magnitude) {
+        length++;
+        magnitude >>= 1;
+    }
+    return length;
+#endif
+}
+
+int lowestBit(uint64_t mask) {
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctzll(mask);
+#else
+    int i = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+#endif
+}
+
+// kode Huffman kategori lalu bit nilainya (negatif dalam komplemen satu)
+void writeValue(BitWriter& writer, const HuffmanCode& code, int value, int length) {
+    uint32_t bits = (uint32_t)(value < 0 ? value - 1 : value) & ((1u << length) - 1);
+    writer.put(((uint32_t)code.code << length) | bits, code.length + length);
+}
+
+void writeDC(BitWriter& writer, Component& comp, int dc) {
+    int diff = dc - comp.lastDC;
+    comp.lastDC = dc;
+    int length = bitLength(diff);
+    writeValue(writer, comp.dc[length], diff, length);
+}
+
+// koefisien terkuantisasi (urutan zigzag) ke Huffman; posisi AC bukan nol
+// diambil dari bitmask sehingga deretan nol tidak dipindai satu per satu
+void encodeCoefficients(BitWriter& writer, Component& comp, const int coef[64]) {
+    writeDC(writer, comp, coef[0]);
+
+    uint64_t mask = 0;
+    for (int i = 1; i < 64; i++) mask |= (uint64_t)(coef[i] != 0) << i;
+
+    int last = 0;
+    while (mask) {
+        int i = lowestBit(mask);
+        mask &= mask - 1;
+        int zeros = i - last - 1;
+        while (zeros >= 16) {
+            writer.put(comp.ac[0xF0]);
+            zeros -= 16;
+        }
+        int length = bitLength(coef[i]);
+        writeValue(writer, comp.ac[(zeros << 4) + length], coef[i], length);
+        last = i;
+    }
+    if (last != 63) writer.put(comp.ac[0x00]);   // EOB
+}
+
+// blok bernilai konstan: DCT-nya hanya DC = 64 * value, AC semua nol
+void encodeFlatBlock(BitWriter& writer, Component& comp, float value) {
+    writeDC(writer, comp, roundCoefficient(value * 64.0f * comp.scale[0]));
+    writer.put(comp.ac[0x00]);
+}
+
+struct YCbCr {
+    float y, cb, cr;
+};
+
+inline YCbCr toYCbCr(float r, float g, float b) {
+    return {+0.29900f * r + 0.58700f * g + 0.11400f * b - 128,
+            -0.16874f * r - 0.33126f * g + 0.50000f * b,
+            +0.50000f * r - 0.41869f * g - 0.08131f * b};
+}
+
+// ---- kernel skalar ----
+
+void convertRowScalar(const unsigned char* px, float* Y, float* U, float* V) {
+    for (int i = 0; i < 8; i++, px += 3) {
+        YCbCr c = toYCbCr(px[0], px[1], px[2]);
+        Y[i] = c.y;
+        U[i] = c.cb;
+        V[i] = c.cr;
+    }
+}
+
+// DCT 1D AAN (sama dengan stb_image_write), hasil belum diskalakan
+void dct8(float* d, int step) {
+    float tmp0 = d[0] + d[step * 7];
+    float tmp7 = d[0] - d[step * 7];
+    float tmp1 = d[step] + d[step * 6];
+    float tmp6 = d[step] - d[step * 6];
+    float tmp2 = d[step * 2] + d[step * 5];
+    float tmp5 = d[step * 2] - d[step * 5];
+    float tmp3 = d[step * 3] + d[step * 4];
+    float tmp4 = d[step * 3] - d[step * 4];
+
+    // bagian genap
+    float tmp10 = tmp0 + tmp3;
+    float tmp13 = tmp0 - tmp3;
+    float tmp11 = tmp1 + tmp2;
+    float tmp12 = tmp1 - tmp2;
+
+    d[0] = tmp10 + tmp11;
+    d[step * 4] = tmp10 - tmp11;
+
+    float z1 = (tmp12 + tmp13) * 0.707106781f;
+    d[step * 2] = tmp13 + z1;
+    d[step * 6] = tmp13 - z1;
+
+    // bagian ganjil
+    tmp10 = tmp4 + tmp5;
+    tmp11 = tmp5 + tmp6;
+    tmp12 = tmp6 + tmp7;
+
+    float z5 = (tmp10 - tmp12) * 0.382683433f;
+    float z2 = tmp10 * 0.541196100f + z5;
+    float z4 = tmp12 * 1.306562965f + z5;
+    float z3 = tmp11 * 0.707106781f;
+
+    float z11 = tmp7 + z3;
+    float z13 = tmp7 - z3;
+
+    d[step * 5] = z13 + z2;
+    d[step * 3] = z13 - z2;
+    d[step] = z11 + z4;
+    d[step * 7] = z11 - z4;
+}
+
+// DCT baris lalu kolom, kuantisasi, hasil dalam urutan zigzag
+void forwardDctScalar(float* data, int stride, const float* scale, int coef[64]) {
+    for (int row = 0; row < 8; row++) dct8(data + row * stride, 1);
+    for (int col = 0; col < 8; col++) dct8(data + col, stride);
+
+    for (int y = 0, k = 0; y < 8; y++) {
+        for (int x = 0; x < 8; x++, k++) {
+            coef[zigzag[k]] = roundCoefficient(data[y * stride + x] * scale[k]);
+        }
+    }
+}
+
+// ---- kernel AVX2 ----
+// Operasi per elemen sama persis dengan kernel skalar (urutan penjumlahan
+// sama, tanpa FMA), jadi hasilnya identik; bedanya 8 baris/kolom sekaligus.
+#if QUADTREE_JPEG_AVX2
+
+#define QT_AVX2 __attribute__((target("avx2")))
+
+QT_AVX2 void convertRowAvx2(const unsigned char* px, float* Y, float* U, float* V) {
+    __m128i lo = _mm_loadu_si128((const __m128i*)px);
+    __m128i hi = _mm_loadl_epi64((const __m128i*)(px + 16));
+    const char z = -1;
+    __m128i r8 = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(0, 3, 6, 9, 12, 15, z, z, z, z, z, z, z, z, z, z)),
+                              _mm_shuffle_epi8(hi, _mm_setr_epi8(z, z, z, z, z, z, 2, 5, z, z, z, z, z, z, z, z)));
+    __m128i g8 = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(1, 4, 7, 10, 13, z, z, z, z, z, z, z, z, z, z, z)),
+                              _mm_shuffle_epi8(hi, _mm_setr_epi8(z, z, z, z, z, 0, 3, 6, z, z, z, z, z, z, z, z)));
+    __m128i b8 = _mm_or_si128(_mm_shuffle_epi8(lo, _mm_setr_epi8(2, 5, 8, 11, 14, z, z, z, z, z, z, z, z, z, z, z)),
+                              _mm_shuffle_epi8(hi, _mm_setr_epi8(z, z, z, z, z, 1, 4, 7, z, z, z, z, z, z, z, z)));
+    __m256 r = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(r8));
+    __m256 g = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(g8));
+    __m256 b = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(b8));
+
+    __m256 y = _mm256_add_ps(_mm256_mul_ps(_mm256_set1_ps(0.29900f), r), _mm256_mul_ps(_mm256_set1_ps(0.58700f), g));
+    y = _mm256_add_ps(y, _mm256_mul_ps(_mm256_set1_ps(0.11400f), b));
+    y = _mm256_sub_ps(y, _mm256_set1_ps(128.0f));
+    __m256 u = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(-0.16874f), r), _mm256_mul_ps(_mm256_set1_ps(0.33126f), g));
+    u = _mm256_add_ps(u, _mm256_mul_ps(_mm256_set1_ps(0.50000f), b));
+    __m256 v = _mm256_sub_ps(_mm256_mul_ps(_mm256_set1_ps(0.50000f), r), _mm256_mul_ps(_mm256_set1_ps(0.41869f), g));
+    v = _mm256_sub_ps(v, _mm256_mul_ps(_mm256_set1_ps(0.08131f), b));
+
+    _mm256_storeu_ps(Y, y);
+    _mm256_storeu_ps(U, u);
+    _mm256_storeu_ps(V, v);
+}
+
+QT_AVX2 inline void transpose8(__m256 m[8]) {
+    __m256 t0 = _mm256_unpacklo_ps(m[0], m[1]);
+    __m256 t1 = _mm256_unpackhi_ps(m[0], m[1]);
+    __m256 t2 = _mm256_unpacklo_ps(m[2], m[3]);
+    __m256 t3 = _mm256_unpackhi_ps(m[2], m[3]);
+    __m256 t4 = _mm256_unpacklo_ps(m[4], m[5]);
+    __m256 t5 = _mm256_unpackhi_ps(m[4], m[5]);
+    __m256 t6 = _mm256_unpacklo_ps(m[6], m[7]);
+    __m256 t7 = _mm256_unpackhi_ps(m[6], m[7]);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    m[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    m[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    m[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    m[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    m[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    m[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    m[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    m[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+// dct8 untuk 8 lajur sekaligus: d[i] berisi elemen ke-i dari 8 vektor data
+QT_AVX2 inline void dct8Avx2(__m256 d[8]) {
+    __m256 tmp0 = _mm256_add_ps(d[0], d[7]);
+    __m256 tmp7 = _mm256_sub_ps(d[0], d[7]);
+    __m256 tmp1 = _mm256_add_ps(d[1], d[6]);
+    __m256 tmp6 = _mm256_sub_ps(d[1], d[6]);
+    __m256 tmp2 = _mm256_add_ps(d[2], d[5]);
+    __m256 tmp5 = _mm256_sub_ps(d[2], d[5]);
+    __m256 tmp3 = _mm256_add_ps(d[3], d[4]);
+    __m256 tmp4 = _mm256_sub_ps(d[3], d[4]);
+
+    __m256 tmp10 = _mm256_add_ps(tmp0, tmp3);
+    __m256 tmp13 = _mm256_sub_ps(tmp0, tmp3);
+    __m256 tmp11 = _mm256_add_ps(tmp1, tmp2);
+    __m256 tmp12 = _mm256_sub_ps(tmp1, tmp2);
+
+    d[0] = _mm256_add_ps(tmp10, tmp11);
+    d[4] = _mm256_sub_ps(tmp10, tmp11);
+
+    __m256 z1 = _mm256_mul_ps(_mm256_add_ps(tmp12, tmp13), _mm256_set1_ps(0.707106781f));
+    d[2] = _mm256_add_ps(tmp13, z1);
+    d[6] = _mm256_sub_ps(tmp13, z1);
+
+    tmp10 = _mm256_add_ps(tmp4, tmp5);
+    tmp11 = _mm256_add_ps(tmp5, tmp6);
+    tmp12 = _mm256_add_ps(tmp6, tmp7);
+
+    __m256 z5 = _mm256_mul_ps(_mm256_sub_ps(tmp10, tmp12), _mm256_set1_ps(0.382683433f));
+    __m256 z2 = _mm256_add_ps(_mm256_mul_ps(tmp10, _mm256_set1_ps(0.541196100f)), z5);
+    __m256 z4 = _mm256_add_ps(_mm256_mul_ps(tmp12, _mm256_set1_ps(1.306562965f)), z5);
+    __m256 z3 = _mm256_mul_ps(tmp11, _mm256_set1_ps(0.707106781f));
+
+    __m256 z11 = _mm256_add_ps(tmp7, z3);
+    __m256 z13 = _mm256_sub_ps(tmp7, z3);
+
+    d[5] = _mm256_add_ps(z13, z2);
+    d[3] = _mm256_sub_ps(z13, z2);
+    d[1] = _mm256_add_ps(z11, z4);
+    d[7] = _mm256_sub_ps(z11, z4);
+}
+
+QT_AVX2 void forwardDctAvx2(float* data, int stride, const float* scale, int coef[64]) {
+    __m256 m[8];
+    for (int row = 0; row < 8; row++) m[row] = _mm256_loadu_ps(data + row * stride);
+
+    // transpose -> DCT antar vektor = DCT tiap baris; transpose balik -> DCT kolom
+    transpose8(m);
+    dct8Avx2(m);
+    transpose8(m);
+    dct8Avx2(m);
+
+    alignas(32) int natural[64];
+    const __m256 signMask = _mm256_set1_ps(-0.0f);
+    const __m256 half = _mm256_set1_ps(0.5f);
+    for (int row = 0; row < 8; row++) {
+        __m256 v = _mm256_mul_ps(m[row], _mm256_loadu_ps(scale + row * 8));
+        // v +- 0.5 lalu dipotong, sama dengan roundCoefficient
+        __m256 rounding = _mm256_or_ps(half, _mm256_and_ps(v, signMask));
+        _mm256_store_si256((__m256i*)(natural + row * 8), _mm256_cvttps_epi32(_mm256_add_ps(v, rounding)));
+    }
+    for (int k = 0; k < 64; k++) coef[zigzag[k]] = natural[k];
+}
+
+#undef QT_AVX2
+
+#endif
+
+struct JpegKernels {
+    void (*convertRow)(const unsigned char* px, float* Y, float* U, float* V);
+    void (*forwardDct)(float* data, int stride, const float* scale, int coef[64]);
+};
+
+// dipilih sekali sesuai CPU yang menjalankan program
+const JpegKernels& selectKernels(bool simd) {
+    static const JpegKernels scalar = {convertRowScalar, forwardDctScalar};
+#if QUADTREE_JPEG_AVX2
+    static const JpegKernels avx2 = {convertRowAvx2, forwardDctAvx2};
+    static const bool hasAvx2 = __builtin_cpu_supports("avx2");
+    if (simd && hasAvx2) return avx2;
+#else
+    (void)simd;
+#endif
+    return scalar;
+}
+
+// sel 8x8 yang seluruh pikselnya (bagian yang ada di dalam gambar) satu warna
+// menyimpan FLAT_CELL | rgb, sel lain 0
+const uint32_t FLAT_CELL = 0x1000000u;
+
+inline uint32_t packColor(unsigned char r, unsigned char g, unsigned char b) {
+    return FLAT_CELL | ((uint32_t)r << 16) | ((uint32_t)g << 8) | b;
+}
+
+inline YCbCr cellYCbCr(uint32_t cell) {
+    return toYCbCr((float)((cell >> 16) & 0xFF), (float)((cell >> 8) & 0xFF), (float)(cell & 0xFF));
+}
+
+void markFlatCellsFromPixels(const unsigned char* rgb, int width, int height, int cellsX, int cellsY,
+                             std::vector<uint32_t>& cells) {
+    size_t stride = (size_t)width * 3;
+    cells.assign((size_t)cellsX * cellsY, 0);
+    for (int cy = 0; cy < cellsY; cy++) {
+        int y0 = cy * 8;
+        int y1 = std::min(y0 + 8, height);
+        for (int cx = 0; cx < cellsX; cx++) {
+            int x0 = cx * 8;
+            int x1 = std::min(x0 + 8, width);
+            const unsigned char* first = rgb + y0 * stride + (size_t)x0 * 3;
+            bool flat = true;
+            for (int y = y0; y < y1 && flat; y++) {
+                const unsigned char* p = rgb + y * stride + (size_t)x0 * 3;
+                for (int x = x0; x < x1; x++, p += 3) {
+                    if (p[0] != first[0] || p[1] != first[1] || p[2] != first[2]) {
+                        flat = false;
+                        break;
+                    }
+                }
+            }
+            if (flat) cells[(size_t)cy * cellsX + cx] = packColor(first[0], first[1], first[2]);
+        }
+    }
+}
+
+// daun menutupi sel jika seluruh bagian sel di dalam gambar ada di daun itu
+void markFlatCellsFromLeaves(const std::vector<QuadTreeLeaf>& leaves, int width, int height, int cellsX, int cellsY,
+                             std::vector<uint32_t>& cells) {
+    cells.assign((size_t)cellsX * cellsY, 0);
+    for (const QuadTreeLeaf& leaf : leaves) {
+        int x1 = std::min(leaf.x + leaf.panjang, width);
+        int y1 = std::min(leaf.y + leaf.lebar, height);
+        if (leaf.x >= x1 || leaf.y >= y1) continue;
+
+        int cx0 = (leaf.x + 7) / 8;
+        int cx1 = x1 == width ? cellsX : x1 / 8;
+        int cy0 = (leaf.y + 7) / 8;
+        int cy1 = y1 == height ? cellsY : y1 / 8;
+        uint32_t color = packColor(leaf.color.r, leaf.color.g, leaf.color.b);
+        for (int cy = cy0; cy < cy1; cy++) {
+            std::fill(cells.begin() + (size_t)cy * cellsX + cx0, cells.begin() + (size_t)cy * cellsX + std::max(cx0, cx1), color);
+        }
+    }
+}
+
+// blok 8x8 piksel mulai (x, y) ke bidang Y, Cb, Cr dengan jarak baris stride;
+// piksel di luar gambar memakai piksel tepi terakhir
+void loadBlock(const JpegKernels& kernels, const unsigned char* rgb, int width, int height, int x, int y,
+               float* Y, float* U, float* V, int stride) {
+    size_t rgbStride = (size_t)width * 3;
+    unsigned char clamped[24];
+    for (int row = 0; row < 8; row++) {
+        const unsigned char* line = rgb + std::min(y + row, height - 1) * rgbStride;
+        const unsigned char* px = line + (size_t)x * 3;
+        if (x + 8 > width) {
+            for (int col = 0; col < 8; col++) {
+                const unsigned char* p = line + (size_t)std::min(x + col, width - 1) * 3;
+                clamped[col * 3] = p[0];
+                clamped[col * 3 + 1] = p[1];
+                clamped[col * 3 + 2] = p[2];
+            }
+            px = clamped;
+        }
+        kernels.convertRow(px, Y + row * stride, U + row * stride, V + row * stride);
+    }
+}
+
+void fillBlock(const YCbCr& c, float* Y, float* U, float* V, int stride) {
+    for (int row = 0; row < 8; row++) {
+        std::fill(Y + row * stride, Y + row * stride + 8, c.y);
+        std::fill(U + row * stride, U + row * stride + 8, c.cb);
+        std::fill(V + row * stride, V + row * stride + 8, c.cr);
+    }
+}
+
+void encodeBlock(const JpegKernels& kernels, BitWriter& writer, Component& comp, float* data, int stride) {
+    int coef[64];
+    kernels.forwardDct(data, stride, comp.scale, coef);
+    encodeCoefficients(writer, comp, coef);
+}
+
+void writeMarker(std::vector<unsigned char>& out, unsigned char marker, uint16_t length) {
+    out.push_back(0xFF);
+    out.push_back(marker);
+    out.push_back((unsigned char)(length >> 8));
+    out.push_back((unsigned char)length);
+}
+
+void writeHuffmanTable(std::vector<unsigned char>& out, unsigned char id, const unsigned char bits[16],
+                       const unsigned char* values, size_t count) {
+    out.push_back(id);
+    out.insert(out.end(), bits, bits + 16);
+    out.insert(out.end(), values, values + count);
+}
+
+// restartInterval > 0 menambahkan segmen DRI (jumlah MCU per restart interval)
+void writeHeaders(std::vector<unsigned char>& out, const JpegTables& tables, int width, int height,
+                  int restartInterval) {
+    static const unsigned char jfif[] = {0xFF, 0xD8, 0xFF, 0xE0, 0, 0x10, 'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    out.insert(out.end(), jfif, jfif + sizeof(jfif));
+
+    writeMarker(out, 0xDB, 2 + 2 * 65);
+    out.push_back(0);
+    out.insert(out.end(), tables.lumaTable, tables.lumaTable + 64);
+    out.push_back(1);
+    out.insert(out.end(), tables.chromaTable, tables.chromaTable + 64);
+
+    writeMarker(out, 0xC0, 17);
+    const unsigned char frame[] = {8, (unsigned char)(height >> 8), (unsigned char)height,
+                                   (unsigned char)(width >> 8), (unsigned char)width, 3,
+                                   1, (unsigned char)(tables.subsample ? 0x22 : 0x11), 0,
+                                   2, 0x11, 1,
+                                   3, 0x11, 1};
+    out.insert(out.end(), frame, frame + sizeof(frame));
+
+    writeMarker(out, 0xC4, 2 + 2 * (17 + 12) + 2 * (17 + 162));
+    writeHuffmanTable(out, 0x00, dcLumaBits, dcLumaValues, sizeof(dcLumaValues));
+    writeHuffmanTable(out, 0x10, acLumaBits, acLumaValues, sizeof(acLumaValues));
+    writeHuffmanTable(out, 0x01, dcChromaBits, dcChromaValues, sizeof(dcChromaValues));
+    writeHuffmanTable(out, 0x11, acChromaBits, acChromaValues, sizeof(acChromaValues));
+
+    if (restartInterval > 0) {
+        writeMarker(out, 0xDD, 4);
+        out.push_back((unsigned char)(restartInterval >> 8));
+        out.push_back((unsigned char)restartInterval);
+    }
+
+    writeMarker(out, 0xDA, 12);
+    static const unsigned char scan[] = {3, 1, 0x00, 2, 0x11, 3, 0x11, 0, 0x3F, 0};
+    out.insert(out.end(), scan, scan + sizeof(scan));
+}
+
+// data yang dibaca bersama oleh semua potongan scan; piksel berasal dari
+// buffer rgb penuh atau, jika index diisi, dibangkitkan per baris dari daun
+struct ScanInput {
+    const unsigned char* rgb;
+    const LeafRowIndex* index;
+    int width, height;
+    const std::vector<uint32_t>* cells;
+    int cellsX, cellsY;
+    const JpegTables* tables;
+    const JpegKernels* kernels;
+};
+
+// encode baris MCU [row0, row1) sebagai entropy-coded segment mandiri
+// (prediksi DC mulai dari 0, diakhiri padding ke batas byte), ditambahkan ke out
+void encodeMcuRows(const ScanInput& in, int row0, int row1, std::vector<unsigned char>& out) {
+    const JpegTables& tables = *in.tables;
+    const JpegKernels& kernels = *in.kernels;
+    const std::vector<uint32_t>& cells = *in.cells;
+    int width = in.width;
+    int height = in.height;
+    int mcuSize = tables.subsample ? 16 : 8;
+    size_t stride = (size_t)width * 3;
+
+    // mode daun: satu baris MCU dirender ke strip, bukan gambar penuh
+    std::unique_ptr<ScanlineRenderer> renderer;
+    std::vector<unsigned char> strip;
+    if (in.index) {
+        renderer.reset(new ScanlineRenderer(*in.index, row0 * mcuSize));
+        strip.resize(stride * mcuSize);
+    }
+    // baris MCU mulai y: pointer ke baris pertamanya dan banyak baris valid
+    auto mcuRowPixels = [&](int y, int& rows) {
+        rows = std::min(mcuSize, height - y);
+        if (!renderer) return in.rgb + y * stride;
+        for (int r = 0; r < rows; r++) std::memcpy(strip.data() + r * stride, renderer->nextRow(), stride);
+        return (const unsigned char*)strip.data();
+    };
+
+    BitWriter writer(out);
+    Component luma{tables.lumaScale, tables.dcLuma, tables.acLuma};
+    Component cb{tables.chromaScale, tables.dcChroma, tables.acChroma};
+    Component cr{tables.chromaScale, tables.dcChroma, tables.acChroma};
+
+    // sel di luar gambar berisi salinan piksel tepi, jadi ikut status sel tepi
+    auto cellAt = [&](int cx, int cy) {
+        return cells[(size_t)std::min(cy, in.cellsY - 1) * in.cellsX + std::min(cx, in.cellsX - 1)];
+    };
+
+    int y1 = std::min(height, row1 * mcuSize);
+    if (tables.subsample) {
+        float Y[256], U[256], V[256], subU[64], subV[64];
+        for (int y = row0 * 16; y < y1; y += 16) {
+            int rows;
+            const unsigned char* rgb = mcuRowPixels(y, rows);
+            for (int x = 0; x < width; x += 16) {
+                writer.reserve(MAX_MCU_BYTES);
+                uint32_t cell[4] = {cellAt(x / 8, y / 8), cellAt(x / 8 + 1, y / 8),
+                                    cellAt(x / 8, y / 8 + 1), cellAt(x / 8 + 1, y / 8 + 1)};
+                if (cell[0] && cell[0] == cell[1] && cell[0] == cell[2] && cell[0] == cell[3]) {
+                    // seluruh MCU satu warna: 6 blok DC saja
+                    YCbCr c = cellYCbCr(cell[0]);
+                    for (int i = 0; i < 4; i++) encodeFlatBlock(writer, luma, c.y);
+                    encodeFlatBlock(writer, cb, c.cb);
+                    encodeFlatBlock(writer, cr, c.cr);
+                    continue;
+                }
+
+                // sel seragam cukup diisi konstanta untuk rata-rata chroma
+                static const int offsets[4] = {0, 8, 128, 136};
+                for (int i = 0; i < 4; i++) {
+                    float* Yi = Y + offsets[i];
+                    if (cell[i]) {
+                        YCbCr c = cellYCbCr(cell[i]);
+                        fillBlock(c, Yi, U + offsets[i], V + offsets[i], 16);
+                        encodeFlatBlock(writer, luma, c.y);
+                    } else {
+                        loadBlock(kernels, rgb, width, rows, x + (i & 1) * 8, (i >> 1) * 8, Yi, U + offsets[i], V + offsets[i], 16);
+                        encodeBlock(kernels, writer, luma, Yi, 16);
+                    }
+                }
+                for (int yy = 0, pos = 0; yy < 8; yy++) {
+                    for (int xx = 0; xx < 8; xx++, pos++) {
+                        int j = yy * 32 + xx * 2;
+                        subU[pos] = (U[j] + U[j + 1] + U[j + 16] + U[j + 17]) * 0.25f;
+                        subV[pos] = (V[j] + V[j + 1] + V[j + 16] + V[j + 17]) * 0.25f;
+                    }
+                }
+                encodeBlock(kernels, writer, cb, subU, 8);
+                encodeBlock(kernels, writer, cr, subV, 8);
+            }
+        }
+    } else {
+        float Y[64], U[64], V[64];
+        for (int y = row0 * 8; y < y1; y += 8) {
+            int rows;
+            const unsigned char* rgb = mcuRowPixels(y, rows);
+            for (int x = 0; x < width; x += 8) {
+                writer.reserve(MAX_MCU_BYTES);
+                uint32_t cell = cellAt(x / 8, y / 8);
+                if (cell) {
+                    YCbCr c = cellYCbCr(cell);
+                    encodeFlatBlock(writer, luma, c.y);
+                    encodeFlatBlock(writer, cb, c.cb);
+                    encodeFlatBlock(writer, cr, c.cr);
+                    continue;
+                }
+                loadBlock(kernels, rgb, width, rows, x, 0, Y, U, V, 8);
+                encodeBlock(kernels, writer, luma, Y, 8);
+                encodeBlock(kernels, writer, cb, U, 8);
+                encodeBlock(kernels, writer, cr, V, 8);
+            }
+        }
+    }
+
+    writer.finish();
+}
+
+bool encodeWithCells(const unsigned char* rgb, const LeafRowIndex* index, int width, int height,
+                     const std::vector<uint32_t>& cells, int cellsX, int cellsY,
+                     std::vector<unsigned char>& out, const JpegWriteOptions& options) {
+    JpegTables tables(options.quality);
+    ScanInput in{rgb, index, width, height, &cells, cellsX, cellsY, &tables, &selectKernels(options.simd)};
+
+    int mcuSize = tables.subsample ? 16 : 8;
+    int mcusPerRow = (width + mcuSize - 1) / mcuSize;
+    int mcuRows = (height + mcuSize - 1) / mcuSize;
+
+    ThreadPool& pool = ThreadPool::global();
+    int parallel = options.threads <= 0 ? pool.size() : options.threads;
+
+    out.clear();
+    out.reserve((size_t)width * height / 8 + MAX_MCU_BYTES);
+    if (parallel <= 1 || mcuRows < 2) {
+        writeHeaders(out, tables, width, height, 0);
+        encodeMcuRows(in, 0, mcuRows, out);
+    } else {
+        // pita beberapa baris MCU, satu restart interval per pita; pita lebih
+        // banyak dari thread supaya beban tetap rata
+        int stripRows = std::max(1, (mcuRows + parallel * 4 - 1) / (parallel * 4));
+        stripRows = std::min(stripRows, 65535 / mcusPerRow);
+        int strips = (mcuRows + stripRows - 1) / stripRows;
+
+        std::vector<std::vector<unsigned char>> parts(strips);
+        pool.parallelFor(strips, [&](size_t i) {
+            int row0 = (int)i * stripRows;
+            encodeMcuRows(in, row0, std::min(mcuRows, row0 + stripRows), parts[i]);
+        }, parallel);
+
+        writeHeaders(out, tables, width, height, mcusPerRow * stripRows);
+        for (int i = 0; i < strips; i++) {
+            out.insert(out.end(), parts[i].begin(), parts[i].end());
+            if (i + 1 < strips) {
+                out.push_back(0xFF);
+                out.push_back((unsigned char)(0xD0 + i % 8));   // RSTn
+            }
+        }
+    }
+
+    out.push_back(0xFF);
+    out.push_back(0xD9);
+    return true;
+}
+}
+
+bool encodeJPEG(const unsigned char* rgb, int width, int height, std::vector<unsigned char>& out,
+                const JpegWriteOptions& options) {
+    if (!rgb || width <= 0 || height <= 0 || width > 65535 || height > 65535) return false;
+
+    int cellsX = (width + 7) / 8;
+    int cellsY = (height + 7) / 8;
+    std::vector<uint32_t> cells;
+    markFlatCellsFromPixels(rgb, width, height, cellsX, cellsY, cells);
+    return encodeWithCells(rgb, nullptr, width, height, cells, cellsX, cellsY, out, options);
+}
+
+bool encodeQuadtreeJPEG(const QuadTree& tree, std::vector<unsigned char>& out, const JpegWriteOptions& options) {
+    int width = tree.getWidth();
+    int height = tree.getHeight();
+    if (!tree.getRoot() || width <= 0 || height <= 0 || width > 65535 || height > 65535) return false;
+
+    const LeafRowIndex& index = tree.getRowIndex();
+
+    int cellsX = (width + 7) / 8;
+    int cellsY = (height + 7) / 8;
+    std::vector<uint32_t> cells;
+    markFlatCellsFromLeaves(index.getLeaves(), width, height, cellsX, cellsY, cells);
+    return encodeWithCells(nullptr, &index, width, height, cells, cellsX, cellsY, out, options);
+}
+
+bool writeQuadtreeJPEG(const std::string& filename, const QuadTree& tree, const JpegWriteOptions& options) {
+    std::vector<unsigned char> data;
+    if (!encodeQuadtreeJPEG(tree, data, options)) return false;
+
+    FILE* f = std::fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    return std::fclose(f) == 0 && ok;
+}
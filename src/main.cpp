@@ -1,5 +1,9 @@
 #include "header/quadtree.h"
 #include "header/op.h"
+#include "header/pipeline.h"
+#include "header/gridsearch.h"
+#include "header/imagewriter.h"
+#include "header/metric.h"
 #include <iostream>
 #include <string>
 #include <chrono>
@@ -7,6 +11,9 @@
 #include <algorithm>
 #include <fstream>
 #include <cstdlib>
+#include <sstream>
+#include <filesystem>
+#include <vector>
 
 #define RESET   "\033[0m"
 #define RED     "\033[31m"
@@ -38,7 +45,373 @@ bool validateOutputPath(const std::string& path) {
     return true;
 }
 
-int main() {
+// Opsi output yang bisa diberikan lewat argumen, baik mode interaktif maupun batch
+struct OutputSettings {
+    int pngLevel = 1;   // level deflate png 0-9
+    int jpgQuality = 90; // kualitas jpg 1-100
+    int threads = 0;    // thread encode output, 0 = semua core
+    QuadTreeBudget budget; // batas build best-first, 0 = tanpa batas
+    double deadlineMillis = 0.0; // batas waktu baca + build + tulis gambar, 0 = nonaktif
+    bool stats = false;  // tampilkan statistik scan piksel build
+    QuadTreeSampling sampling; // mode metrik aproksimasi untuk blok besar
+    bool ssimReport = false;   // hitung SSIM gambar hasil terhadap gambar asli
+    SSIMWindow ssimWindow = SSIM_WINDOW_BOX;
+    QuadTreeQualityTarget targetQuality; // --target-psnr/--target-ssim, threshold dicari otomatis
+};
+
+// baca satu opsi output di argv[i]; true jika dikenali (i maju ke nilai opsinya)
+bool parseOutputOption(int argc, char** argv, int& i, OutputSettings& settings) {
+    std::string arg = argv[i];
+    if (arg == "--png-level" && i + 1 < argc) {
+        settings.pngLevel = std::max(0, std::min(std::atoi(argv[++i]), 9));
+        return true;
+    }
+    if (arg == "--jpg-quality" && i + 1 < argc) {
+        settings.jpgQuality = std::max(1, std::min(std::atoi(argv[++i]), 100));
+        return true;
+    }
+    if (arg == "--encode-threads" && i + 1 < argc) {
+        settings.threads = std::max(0, std::atoi(argv[++i]));
+        return true;
+    }
+    if (arg == "--max-nodes" && i + 1 < argc) {
+        settings.budget.maxNodes = std::max(0, std::atoi(argv[++i]));
+        return true;
+    }
+    if (arg == "--max-leaves" && i + 1 < argc) {
+        settings.budget.maxLeaves = std::max(0, std::atoi(argv[++i]));
+        return true;
+    }
+    if (arg == "--max-bytes" && i + 1 < argc) {
+        settings.budget.maxBytes = std::strtoull(argv[++i], nullptr, 10);
+        return true;
+    }
+    if (arg == "--budget-ms" && i + 1 < argc) {
+        settings.budget.maxMillis = std::max(0.0, std::atof(argv[++i]));
+        return true;
+    }
+    if (arg == "--deadline-ms" && i + 1 < argc) {
+        settings.deadlineMillis = std::max(0.0, std::atof(argv[++i]));
+        return true;
+    }
+    if (arg == "--stats") {
+        settings.stats = true;
+        return true;
+    }
+    if (arg == "--budget-area") {
+        settings.budget.weightByArea = true;
+        return true;
+    }
+    if (arg == "--ssim") {
+        settings.ssimReport = true;
+        return true;
+    }
+    if (arg == "--ssim-gaussian") {
+        settings.ssimReport = true;
+        settings.ssimWindow = SSIM_WINDOW_GAUSSIAN;
+        return true;
+    }
+    if (arg == "--approx") {
+        settings.sampling.enabled = true;
+        return true;
+    }
+    if (arg == "--target-psnr" && i + 1 < argc) {
+        settings.targetQuality.metric = QT_QUALITY_PSNR;
+        settings.targetQuality.minimum = std::atof(argv[++i]);
+        return true;
+    }
+    if (arg == "--target-ssim" && i + 1 < argc) {
+        settings.targetQuality.metric = QT_QUALITY_SSIM;
+        settings.targetQuality.minimum = std::atof(argv[++i]);
+        return true;
+    }
+    if (arg == "--sample-size" && i + 1 < argc) {
+        settings.sampling.enabled = true;
+        settings.sampling.sampleSize = std::max(16, std::atoi(argv[++i]));
+        return true;
+    }
+    if (arg == "--approx-z" && i + 1 < argc) {
+        settings.sampling.enabled = true;
+        double z = std::atof(argv[++i]);
+        settings.sampling.confidenceZ = z > 0 ? z : settings.sampling.confidenceZ;
+        return true;
+    }
+    return false;
+}
+
+// Mode batch non-interaktif, gambar diproses lewat pipeline reader/compute/writer:
+//   main --batch <metode> <threshold> <minBlock> <dirOutput> [--gif] [--threads N] [--png-level N] [--jpg-quality N]
+//        [--max-nodes N] [--max-leaves N] [--max-bytes N] [--budget-ms N] [--budget-area] [--deadline-ms N] [--stats]
+//        [--approx] [--sample-size N] [--approx-z Z] [--ssim | --ssim-gaussian] [--variant M:T]...
+//        [--target-psnr DB | --target-ssim S] gambar...
+// --variant menambah pasangan metode:threshold; semua pasangan (termasuk metode
+// dan threshold utama) dibangun dari satu decode dan satu pass statistik per gambar.
+// --target-psnr/--target-ssim: threshold dicari per gambar, argumen threshold diabaikan.
+int runBatch(int argc, char** argv) {
+    if (argc < 7) {
+        std::cerr << "Pemakaian: " << argv[0]
+                  << " --batch <metode 1-6> <threshold> <minBlock> <dirOutput> [--gif] [--threads N] [--png-level N] [--jpg-quality N]"
+                  << " [--max-nodes N] [--max-leaves N] [--max-bytes N] [--budget-ms N] [--budget-area] [--deadline-ms N] [--stats]"
+                  << " [--approx] [--sample-size N] [--approx-z Z] [--ssim | --ssim-gaussian] [--variant M:T]..."
+                  << " [--target-psnr DB | --target-ssim S] gambar..." << std::endl;
+        return 1;
+    }
+
+    QtEncodeOptions options;
+    options.errorMethod = std::atoi(argv[2]);
+    options.threshold = std::atof(argv[3]);
+    options.minBlockSize = std::atoi(argv[4]);
+    std::filesystem::path outputDir = argv[5];
+
+    bool withGif = false;
+    PipelineOptions pipelineOptions;
+    OutputSettings settings;
+    settings.threads = 1; // paralelisme batch sudah di level gambar
+    std::vector<PipelineJob> jobs;
+    std::vector<PipelineVariant> variants;
+    for (int i = 6; i < argc; i++) {
+        std::string arg = argv[i];
+        if (parseOutputOption(argc, argv, i, settings)) {
+            continue;
+        } else if (arg == "--variant" && i + 1 < argc) {
+            std::string value = argv[++i];
+            size_t colon = value.find(':');
+            if (colon == std::string::npos) {
+                std::cerr << RED << "Format --variant harus metode:threshold, misalnya 2:10" << RESET << std::endl;
+                return 1;
+            }
+            PipelineVariant variant;
+            variant.errorMethod = std::atoi(value.substr(0, colon).c_str());
+            variant.threshold = std::atof(value.substr(colon + 1).c_str());
+            variants.push_back(variant);
+        } else if (arg == "--gif") {
+            withGif = true;
+        } else if (arg == "--threads" && i + 1 < argc) {
+            pipelineOptions.computeThreads = std::atoi(argv[++i]);
+        } else {
+            std::filesystem::path input = arg;
+            PipelineJob job;
+            job.inputPath = arg;
+            job.outputPath = (outputDir / (input.stem().string() + "_quadtree" + input.extension().string())).string();
+            job.options = options;
+            jobs.push_back(job);
+        }
+    }
+    for (auto& job : jobs) {
+        job.options.pngLevel = settings.pngLevel;
+        job.options.jpgQuality = settings.jpgQuality;
+        job.options.threads = settings.threads;
+        job.options.budget = settings.budget;
+        job.options.deadlineMillis = settings.deadlineMillis;
+        job.options.sampling = settings.sampling;
+        job.options.targetQuality = settings.targetQuality;
+    }
+    pipelineOptions.ssimReport = settings.ssimReport;
+    pipelineOptions.ssimWindow = settings.ssimWindow;
+    if (withGif) {
+        for (auto& job : jobs) {
+            job.gifPath = std::filesystem::path(job.outputPath).replace_extension(".gif").string();
+        }
+    }
+    if (!variants.empty()) {
+        if (settings.budget.isLimited() || settings.deadlineMillis > 0 || settings.sampling.enabled ||
+            settings.targetQuality.isActive()) {
+            std::cerr << RED << "--variant tidak bisa digabung dengan budget, deadline, --approx, atau target kualitas"
+                      << RESET << std::endl;
+            return 1;
+        }
+        PipelineVariant primary;
+        primary.errorMethod = options.errorMethod;
+        primary.threshold = options.threshold;
+        variants.insert(variants.begin(), primary);
+        // nama output: <nama>_quadtree_m<metode>_t<threshold>.<ekstensi>
+        for (auto& job : jobs) {
+            std::filesystem::path output = job.outputPath;
+            for (PipelineVariant variant : variants) {
+                std::ostringstream name;
+                name << output.stem().string() << "_m" << variant.errorMethod << "_t" << variant.threshold;
+                std::filesystem::path variantOutput = output.parent_path() / (name.str() + output.extension().string());
+                variant.outputPath = variantOutput.string();
+                if (withGif) variant.gifPath = std::filesystem::path(variantOutput).replace_extension(".gif").string();
+                job.variants.push_back(variant);
+            }
+        }
+    }
+
+    std::error_code ec;
+    std::filesystem::create_directories(outputDir, ec);
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    std::vector<PipelineResult> results = runPipeline(jobs, pipelineOptions);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+
+    int failed = 0;
+    for (const auto& result : results) {
+        if (result.status != QT_OK) {
+            std::cerr << RED << result.inputPath << ": " << qtStatusMessage(result.status) << " :(" << RESET << std::endl;
+            failed++;
+            continue;
+        }
+        double compressionPercentage = (1.0 - static_cast<double>(result.compressedSize) / result.originalSize) * 100.0;
+        std::cout << result.outputPath << " | simpul " << result.totalNodes
+                  << " | kedalaman " << result.maxDepth
+                  << " | " << result.originalSize << " -> " << result.compressedSize << " bytes ("
+                  << std::fixed << std::setprecision(2) << compressionPercentage << " %)";
+        if (settings.targetQuality.isActive()) {
+            std::cout << " | threshold " << std::setprecision(4) << result.threshold
+                      << (settings.targetQuality.metric == QT_QUALITY_PSNR ? ", PSNR " : ", SSIM blok ")
+                      << result.quality << (result.qualityReached ? "" : " (target tidak tercapai)")
+                      << std::setprecision(2);
+        }
+        if (result.buildStop != QT_STOP_CONVERGED) {
+            std::cout << " | " << qtBuildStopMessage(result.buildStop) << ", daun " << result.leaves
+                      << ", error residual " << result.residualError;
+        }
+        if (settings.deadlineMillis > 0) {
+            std::cout << " | deadline " << std::setprecision(0) << result.totalMillis << " / " << settings.deadlineMillis
+                      << " ms" << (result.deadlineMet ? "" : " terlewat") << std::setprecision(2);
+        }
+        if (settings.stats) {
+            std::cout << " | piksel dibaca " << result.scanStats.scannedPixels << ", dilewati "
+                      << result.scanStats.skippedPixels << ", early exit " << result.scanStats.earlyExits;
+            if (settings.sampling.enabled) {
+                std::cout << ", keputusan sampel " << result.scanStats.sampledDecisions << ", scan persis "
+                          << result.scanStats.exactFallbacks;
+            }
+        }
+        if (settings.ssimReport) {
+            std::cout << " | SSIM " << std::setprecision(4) << result.ssim.ssim << std::setprecision(2);
+        }
+        std::cout << std::endl;
+    }
+    std::cout << GREEN << results.size() - failed << "/" << results.size() << " gambar selesai dalam "
+              << duration << " ms" << RESET << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+// daftar angka dipisah koma, misalnya "10,20,50"; false jika ada bagian kosong
+template <typename T, typename Parse>
+bool parseList(const std::string& text, std::vector<T>& values, Parse parse) {
+    std::stringstream stream(text);
+    std::string part;
+    while (std::getline(stream, part, ',')) {
+        if (part.empty()) return false;
+        values.push_back(parse(part.c_str()));
+    }
+    return !values.empty();
+}
+
+// Grid search parameter pada satu gambar, semua kombinasi dievaluasi paralel:
+//   main --grid <gambar> <metode,...> <threshold,...> <minBlock,...> [--threads N] [--ssim-gaussian] [--csv file]
+int runGridSearchCommand(int argc, char** argv) {
+    GridSearchOptions options;
+    if (argc < 6 || !parseList(argv[3], options.methods, std::atoi) ||
+        !parseList(argv[4], options.thresholds, std::atof) || !parseList(argv[5], options.minBlockSizes, std::atoi)) {
+        std::cerr << "Pemakaian: " << argv[0]
+                  << " --grid <gambar> <metode,...> <threshold,...> <minBlock,...> [--threads N] [--ssim-gaussian] [--csv file]"
+                  << std::endl;
+        return 1;
+    }
+    std::string csvPath;
+    for (int i = 6; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads" && i + 1 < argc) {
+            options.threads = std::max(0, std::atoi(argv[++i]));
+        } else if (arg == "--ssim-gaussian") {
+            options.ssimWindow = SSIM_WINDOW_GAUSSIAN;
+        } else if (arg == "--csv" && i + 1 < argc) {
+            csvPath = argv[++i];
+        } else {
+            std::cerr << "Opsi tidak dikenal: " << arg << std::endl;
+            return 1;
+        }
+    }
+
+    std::vector<std::vector<Color>> image;
+    int width, height;
+    if (!validateInputFile(argv[2]) || !readImage(argv[2], image, width, height)) {
+        std::cerr << RED << "Gagal membaca gambar: " << argv[2] << " :(" << RESET << std::endl;
+        return 1;
+    }
+
+    auto startTime = std::chrono::high_resolution_clock::now();
+    GridSearchReport report = runGridSearch(image, options);
+    auto endTime = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+    if (report.status != QT_OK) {
+        std::cerr << RED << "Tidak ada kombinasi valid: minBlock minimal 1, threshold sesuai rentang metode"
+                  << " (variance 0-16384, MAD/MPD 0-255, entropy 0-8, SSIM 0-1) :(" << RESET << std::endl;
+        return 1;
+    }
+
+    std::cout << BOLD << "Grid search " << argv[2] << " (" << width << "x" << height << "): "
+              << report.results.size() << " kombinasi" << RESET << std::endl;
+    std::cout << std::left << std::setw(7) << "metode" << std::right << std::setw(11) << "threshold"
+              << std::setw(9) << "minBlock" << std::setw(11) << "simpul" << std::setw(11) << "daun"
+              << std::setw(10) << "kedalaman" << std::setw(14) << "estimasi (B)" << std::setw(10) << "PSNR"
+              << std::setw(9) << "SSIM" << std::setw(11) << "waktu (ms)" << std::endl;
+    for (const auto& result : report.results) {
+        std::cout << std::left << std::setw(7) << result.errorMethod << std::right << std::setw(11)
+                  << result.threshold << std::setw(9) << result.minBlockSize << std::setw(11) << result.totalNodes
+                  << std::setw(11) << result.leaves << std::setw(10) << result.maxDepth << std::setw(14)
+                  << result.estimatedSize << std::fixed << std::setprecision(2) << std::setw(10) << result.psnr
+                  << std::setprecision(4) << std::setw(9) << result.ssim << std::setprecision(1) << std::setw(11)
+                  << result.millis << std::defaultfloat << std::setprecision(6) << std::endl;
+    }
+    std::cout << GREEN << "Tree terhalus dibangun sekali (" << report.sharedNodes << " simpul, " << std::fixed
+              << std::setprecision(1) << report.sharedBuildMillis << " ms), total " << duration << " ms" << RESET
+              << std::defaultfloat << std::endl;
+
+    if (!csvPath.empty()) {
+        std::ofstream csv(csvPath);
+        csv << "method,threshold,min_block,nodes,leaves,depth,estimated_bytes,psnr,ssim,ms\n";
+        for (const auto& result : report.results) {
+            csv << result.errorMethod << ',' << result.threshold << ',' << result.minBlockSize << ','
+                << result.totalNodes << ',' << result.leaves << ',' << result.maxDepth << ','
+                << result.estimatedSize << ',' << result.psnr << ',' << result.ssim << ',' << result.millis << '\n';
+        }
+        if (!csv) {
+            std::cerr << RED << "Gagal menulis " << csvPath << " :(" << RESET << std::endl;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    if (argc > 1 && std::string(argv[1]) == "--batch") {
+        return runBatch(argc, argv);
+    }
+    if (argc > 1 && std::string(argv[1]) == "--grid") {
+        return runGridSearchCommand(argc, argv);
+    }
+
+    OutputSettings settings;
+    for (int i = 1; i < argc; i++) {
+        if (!parseOutputOption(argc, argv, i, settings)) {
+            std::cerr << "Opsi tidak dikenal: " << argv[i] << std::endl;
+            std::cerr << "Pemakaian: " << argv[0] << " [--png-level 0-9] [--jpg-quality 1-100] [--encode-threads N]"
+                      << " [--max-nodes N] [--max-leaves N] [--max-bytes N] [--budget-ms N] [--budget-area] [--deadline-ms N] [--stats]"
+                      << " [--approx] [--sample-size N] [--approx-z Z] [--ssim | --ssim-gaussian]"
+                      << " [--target-psnr DB | --target-ssim S]" << std::endl;
+            return 1;
+        }
+    }
+    bool isQualityTarget = settings.targetQuality.isActive();
+    if (isQualityTarget) {
+        QtEncodeOptions qualityOptions;
+        qualityOptions.targetQuality = settings.targetQuality;
+        qualityOptions.budget = settings.budget;
+        qualityOptions.deadlineMillis = settings.deadlineMillis;
+        if (qtValidateOptions(qualityOptions) != QT_OK) {
+            std::cerr << "Target kualitas harus > 0 (SSIM maksimal 1) dan tidak bisa digabung dengan budget atau"
+                      << " --deadline-ms :(" << std::endl;
+            return 1;
+        }
+    }
+    setPngCompressionLevel(settings.pngLevel);
+
     std::string inputFile;
     int errorMethod;
     double threshold;
@@ -56,22 +429,23 @@ int main() {
         }
     } while (!validateInputFile(inputFile));
     
+    const char* methodNames[] = {"Variance", "Mean Absolute Deviation", "Max Pixel Difference", "Entropy",
+                                 "Structural Similarity Index (SSIM)", "SSIM blok terhadap hasil kompresi"};
     std::cout << "Pilih metode perhitungan error yang diinginkan:" << std::endl;
-    std::cout << "1 - Variance" << std::endl;
-    std::cout << "2 - Mean Absolute Deviation" << std::endl;
-    std::cout << "3 - Max Pixel Difference" << std::endl;
-    std::cout << "4 - Entropy" << std::endl;
-    std::cout << "5 - Structural Similarity Index (SSIM)" << std::endl;
+    for (int method = 1; method <= 6; method++) {
+        std::cout << method << " - " << methodNames[method - 1] << std::endl;
+    }
     do {
-    std::cout << "Pilihan kamu (1-5): ";
+    std::cout << "Pilihan kamu (1-6): ";
     std::cin >> errorMethod;
-    if (errorMethod < 1 || errorMethod > 5) {
-        std::cerr << "Pilihan tidak valid, seharusnya antara 1-5 :(\n";
+    if (errorMethod < 1 || errorMethod > 6) {
+        std::cerr << "Pilihan tidak valid, seharusnya antara 1-6 :(\n";
     }
-    } while (errorMethod < 1 || errorMethod > 5);
+    } while (errorMethod < 1 || errorMethod > 6);
     
-    bool validThreshold = false;
-    do {
+    // dengan target kualitas threshold dicari otomatis setelah gambar dibaca
+    bool validThreshold = isQualityTarget;
+    while (!validThreshold) {
         std::cout << "Masukkan ambang batas (threshold): ";
         std::cin >> threshold;
 
@@ -81,27 +455,14 @@ int main() {
             std::cerr << "Threshold tidak bisa negatif :(" << std::endl;
             validThreshold = false;
         }
-        if (errorMethod == 1 && threshold > (128*128)) {
-            std::cerr << "Threshold metode Variance harus dari 0-128*128 :(" << std::endl;
+        // rentang threshold dari policy metrik (metric.h)
+        double maxThreshold = withMetric(errorMethod, [](auto metric) { return decltype(metric)::maxThreshold; });
+        if (threshold > maxThreshold) {
+            std::cerr << "Threshold metode " << methodNames[errorMethod - 1] << " harus dari 0-" << maxThreshold
+                      << " :(" << std::endl;
             validThreshold = false;
         }
-        if (errorMethod == 2 && threshold > 255) {
-            std::cerr << "Threshold metode Mean Absolute Deviation harus dari 0-255 :(" << std::endl;
-            validThreshold = false;
-        }
-        if (errorMethod == 3 && threshold > 255) {
-            std::cerr << "Threshold metode Max Pixel Difference harus dari 0-255 :(" << std::endl;
-            validThreshold = false;
-        }
-        if (errorMethod == 4 && threshold > 8) {
-            std::cerr << "Threshold metode Entropy gabisa di atas 8 :(" << std::endl;
-            validThreshold = false;
-        }
-        if (errorMethod == 5 && threshold > 1) {
-            std::cerr << "Threshold metode SSIM harus 0-1 yah :(" << std::endl;
-            validThreshold = false;
-        }
-    } while (!validThreshold);
+    }
 
     do {
         std::cout << "Masukkan ukuran blok minimum: ";
@@ -114,15 +475,20 @@ int main() {
     
     
     // [CHECK] belum implement gimmick aja duls
-    do {
+    targetCompression = isQualityTarget ? 0 : -1;
+    while (targetCompression < 0 || targetCompression > 1.0) {
         std::cout << "Masukkan target kompresi (0.0-1.0, 0 untuk menonaktifkan mode ini): ";
         std::cin >> targetCompression;
     
         if (targetCompression < 0 || targetCompression > 1.0) {
             std::cerr << "Target persentase seharusnya di antara 0.0 - 1.0" << std::endl;
         }
+        if (targetCompression > 0 && settings.deadlineMillis > 0) {
+            std::cerr << "Target kompresi tidak bisa dipakai bersama --deadline-ms :(" << std::endl;
+            targetCompression = -1;
+        }
     
-    } while (targetCompression < 0 || targetCompression > 1.0);
+    }
     bool isTarget;
     if (targetCompression == 0){
         isTarget = false;
@@ -149,6 +515,8 @@ int main() {
     std::vector<std::vector<Color>> image;
     int width, height;
     if (!readImage(inputFile, image, width, height)) {
+        std::cerr << "Gagal memuat gambar:" << inputFile << std::endl;
+        std::cerr << "Debug STB: " << imageLoadFailureReason() << std::endl;
         std::cerr << "Gagal read gambar :(" << std::endl;
         return 1;
     }
@@ -156,26 +524,71 @@ int main() {
     size_t originalSize = getFileSize(inputFile);
 
     if (isTarget) {
-        threshold = estimateThresholdForTargetCompression(image, errorMethod, minBlockSize, targetCompression, originalSize);
+        threshold = estimateThresholdForTargetCompression(image, errorMethod, minBlockSize, targetCompression, originalSize,
+                                                          settings.threads);
+    }
+
+    std::string outputExtension = getFileExtension(outputFile);
+    if (!isSupportedImageFormat(outputExtension)) {
+        std::cerr << "Format tidak didukung :(" << outputExtension << std::endl;
+        std::cerr << "Format sudah salah satu dari png, jpg, jpeg, bmp, tga belum? :)" << std::endl;
+        return 1;
+    }
+
+    // mode deadline: tree dipecah kasar ke halus sampai sisa waktu hanya cukup untuk menulis gambar
+    QuadTreeBudget budget = settings.budget;
+    if (settings.deadlineMillis > 0) {
+        QtEncodeOptions deadlineOptions;
+        deadlineOptions.format = outputExtension;
+        deadlineOptions.pngLevel = settings.pngLevel;
+        deadlineOptions.jpgQuality = settings.jpgQuality;
+        deadlineOptions.threads = settings.threads;
+        deadlineOptions.budget = settings.budget;
+        deadlineOptions.deadlineMillis = settings.deadlineMillis;
+        double elapsed = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
+        budget = qtDeadlineBudget(deadlineOptions, width, height, elapsed);
     }
 
     QuadTree quadtree;
-    quadtree.buildfrImage(image, errorMethod, threshold, minBlockSize);
-    
-    std::vector<std::vector<Color>> reconstructedImage = quadtree.reconstructImage(width, height);
-    
-    if (!writeImage(outputFile, reconstructedImage)) {
+    QtBuildStop buildStop = QT_STOP_CONVERGED;
+    QuadTreeQuality quality;
+    if (isQualityTarget) {
+        quality = quadtree.buildForQuality(image, errorMethod, settings.targetQuality, minBlockSize);
+        threshold = quality.threshold;
+    } else {
+        buildStop = quadtree.build(image, errorMethod, threshold, minBlockSize, budget, settings.sampling);
+    }
+
+    std::cout << "Memroses gambar..." << std::endl;
+    // semua format ditulis langsung dari daun quadtree, tanpa rekonstruksi penuh
+    ImageWriteOptions writeOptions;
+    writeOptions.pngLevel = settings.pngLevel;
+    writeOptions.jpgQuality = settings.jpgQuality;
+    writeOptions.threads = settings.threads;
+    if (!writeQuadtreeImage(outputFile, quadtree, writeOptions)) {
+        std::cerr << "Gagal write gambar: " << outputFile << std::endl;
         std::cerr << "Gagal write output :(" << std::endl;
         return 1;
     }
+    // GIF tidak termasuk deadline
+    double imageMillis = std::chrono::duration<double, std::milli>(std::chrono::high_resolution_clock::now() - startTime).count();
 
     if (!gifFile.empty()) {
         std::cout << "Memroses GIF..." << std::endl;
-        createQuadtreeGIF(gifFile, image, quadtree, errorMethod, threshold, minBlockSize);
+        if (!createQuadtreeGIF(gifFile, image, quadtree, errorMethod, threshold, minBlockSize)) {
+            std::cerr << "Gagal write GIF: " << gifFile << std::endl;
+            return 1;
+        }
     }
 
     auto endTime = std::chrono::high_resolution_clock::now();
     auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(endTime - startTime).count();
+
+    // laporan kualitas tidak termasuk waktu eksekusi
+    ImageSSIMReport ssimReport;
+    if (settings.ssimReport) {
+        ssimReport = hitungImageSSIM(image, quadtree, settings.ssimWindow, settings.threads);
+    }
     
     // [CHECK] 
     size_t compressedSize = getFileSize(outputFile);
@@ -217,6 +630,51 @@ int main() {
     printRow("Persentase kompresi", compressionStream.str(), MAGENTA);
     printRow("Kedalaman pohon", std::to_string(quadtree.getMaxDepth()), BLUE);
     printRow("Banyak simpul", std::to_string(quadtree.getTotalNodes()), BLUE);
+    if (settings.budget.isLimited() || settings.deadlineMillis > 0) {
+        printRow("Build berhenti", qtBuildStopMessage(buildStop), BLUE);
+        printRow("Banyak daun", std::to_string(quadtree.getLeafCount()), BLUE);
+        std::ostringstream residualStream;
+        residualStream << std::fixed << std::setprecision(4) << quadtree.hitungResidualError();
+        printRow("Error residual", residualStream.str(), BLUE);
+    }
+    if (isQualityTarget) {
+        std::ostringstream thresholdStream, qualityStream;
+        thresholdStream << std::setprecision(6) << threshold;
+        qualityStream << std::fixed << std::setprecision(4) << quality.value << " / " << settings.targetQuality.minimum;
+        printRow("Threshold hasil cari", thresholdStream.str(), BLUE);
+        printRow(settings.targetQuality.metric == QT_QUALITY_PSNR ? "PSNR (dB)" : "SSIM blok", qualityStream.str(),
+                 quality.reached ? GREEN : RED);
+    }
+    if (settings.stats) {
+        const QuadTreeScanStats& scanStats = quadtree.getScanStats();
+        long long totalPixels = scanStats.scannedPixels + scanStats.skippedPixels;
+        std::ostringstream skippedStream;
+        skippedStream << scanStats.skippedPixels << " (" << std::fixed << std::setprecision(1)
+                      << (totalPixels > 0 ? 100.0 * scanStats.skippedPixels / totalPixels : 0.0) << " %)";
+        printRow("Piksel dibaca", std::to_string(scanStats.scannedPixels), BLUE);
+        printRow("Piksel dilewati", skippedStream.str(), BLUE);
+        printRow("Simpul early exit", std::to_string(scanStats.earlyExits), BLUE);
+        if (settings.sampling.enabled) {
+            printRow("Piksel sampel", std::to_string(scanStats.sampledPixels), BLUE);
+            printRow("Keputusan dari sampel", std::to_string(scanStats.sampledDecisions), BLUE);
+            printRow("Kembali ke scan persis", std::to_string(scanStats.exactFallbacks), BLUE);
+        }
+    }
+    if (settings.deadlineMillis > 0) {
+        std::ostringstream deadlineStream;
+        deadlineStream << std::fixed << std::setprecision(0) << imageMillis << " / " << settings.deadlineMillis << " ms"
+                       << (imageMillis <= settings.deadlineMillis ? "" : " terlewat");
+        printRow("Deadline", deadlineStream.str(), imageMillis <= settings.deadlineMillis ? GREEN : RED);
+    }
+    if (settings.ssimReport) {
+        std::ostringstream ssimStream, channelStream;
+        ssimStream << std::fixed << std::setprecision(4) << ssimReport.ssim;
+        channelStream << std::fixed << std::setprecision(4) << ssimReport.channel[0] << " / "
+                      << ssimReport.channel[1] << " / " << ssimReport.channel[2];
+        printRow(settings.ssimWindow == SSIM_WINDOW_GAUSSIAN ? "SSIM gambar (Gaussian)" : "SSIM gambar (8x8)",
+                 ssimStream.str(), MAGENTA);
+        printRow("SSIM R / G / B", channelStream.str(), MAGENTA);
+    }
     printLine();
 
     printRow("Gambar tersimpan di", outputFile);
@@ -0,0 +1,79 @@
+#include "header/mappedfile.h"
+#include <cstdio>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define QUADTREE_HAS_MMAP 1
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+void MappedFile::close() {
+#ifdef QUADTREE_HAS_MMAP
+    if (mapping) munmap(mapping, length);
+#endif
+    mapping = nullptr;
+    bytes = nullptr;
+    length = 0;
+    buffer.clear();
+    buffer.shrink_to_fit();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+
+#ifdef QUADTREE_HAS_MMAP
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0) {
+        size_t fileSize = (size_t)st.st_size;
+        void* addr = mmap(nullptr, fileSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (addr != MAP_FAILED) {
+            // decoder membaca dari depan ke belakang, minta kernel readahead agresif
+            madvise(addr, fileSize, MADV_SEQUENTIAL);
+            madvise(addr, fileSize, MADV_WILLNEED);
+            ::close(fd);
+
+            mapping = addr;
+            bytes = static_cast<const unsigned char*>(addr);
+            length = fileSize;
+            return true;
+        }
+    }
+    ::close(fd);
+#endif
+
+    return readWithStdio(path);
+}
+
+bool MappedFile::readWithStdio(const std::string& path) {
+    FILE* f = std::fopen(path.c_str(), "rb");
+    if (!f) return false;
+
+    const size_t chunk = 1 << 16;
+    size_t total = 0;
+    for (;;) {
+        buffer.resize(total + chunk);
+        size_t n = std::fread(buffer.data() + total, 1, chunk, f);
+        total += n;
+        if (n < chunk) break;
+    }
+    bool ok = !std::ferror(f);
+    std::fclose(f);
+
+    if (!ok || total == 0) {
+        buffer.clear();
+        return false;
+    }
+    buffer.resize(total);
+    bytes = buffer.data();
+    length = total;
+    return true;
+}
@@ -1,18 +1,23 @@
-#define STB_IMAGE_IMPLEMENTATION
 #include "header/stb_image.h" 
 #include "header/quadtree.h"
-#define STB_IMAGE_WRITE_IMPLEMENTATION
 #include "header/stb_image_write.h" 
-#define GIF_STATIC
-#define GIF_IMPL
-#include "header/gif.h"
+#include "header/gifwriter.h"
 #include "header/op.h"
+#include "header/mappedfile.h"
+#include "header/jpegwriter.h"
+#include "header/integralimage.h"
+#include "header/metric.h"
+#include "header/scanline.h"
+#include "header/threadpool.h"
 #include <cmath>
 #include <algorithm>
 #include <map>
 #include <fstream>
-#include <iostream>
+#include <cstdio>
 #include <cstdlib>
+#include <cerrno>
+#include <climits>
+#include <cstring>
 #include <string>
 
 Color hitungAverageColor(const std::vector<Color>& pixels) {
@@ -158,6 +163,218 @@ double hitungSSIM(const std::vector<Color>& pixels, const Color& avgColor) {
     return (ssimR + ssimG + ssimB) / 3.0;
 }
 
+double hitungPSNR(const std::vector<std::vector<Color>>& original, const std::vector<std::vector<Color>>& result) {
+    unsigned long long sumSqrDiff = 0;
+    unsigned long long count = 0;
+    for (size_t y = 0; y < original.size() && y < result.size(); ++y) {
+        size_t panjang = std::min(original[y].size(), result[y].size());
+        for (size_t x = 0; x < panjang; ++x) {
+            int diffR = original[y][x].r - result[y][x].r;
+            int diffG = original[y][x].g - result[y][x].g;
+            int diffB = original[y][x].b - result[y][x].b;
+            sumSqrDiff += diffR * diffR + diffG * diffG + diffB * diffB;
+        }
+        count += panjang * 3;
+    }
+    if (count == 0 || sumSqrDiff == 0) return INFINITY;
+    double mse = (double)sumSqrDiff / count;
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+double hitungPSNR(const std::vector<std::vector<Color>>& original, const QuadTree& tree) {
+    // irisan ukuran gambar dan tree, seperti hitungPSNR
+    int lebar = std::min((int)original.size(), tree.getHeight());
+    int panjang = original.empty() ? 0 : std::min((int)original[0].size(), tree.getWidth());
+    unsigned long long sumSqrDiff = 0;
+    for (const QuadTreeLeaf& leaf : tree.getRowIndex().getLeaves()) {
+        int endY = std::min(leaf.y + leaf.lebar, lebar);
+        int endX = std::min(leaf.x + leaf.panjang, panjang);
+        for (int y = leaf.y; y < endY; ++y) {
+            const Color* row = original[y].data();
+            for (int x = leaf.x; x < endX; ++x) {
+                int diffR = row[x].r - leaf.color.r;
+                int diffG = row[x].g - leaf.color.g;
+                int diffB = row[x].b - leaf.color.b;
+                sumSqrDiff += diffR * diffR + diffG * diffG + diffB * diffB;
+            }
+        }
+    }
+    unsigned long long count = (unsigned long long)lebar * panjang * 3;
+    if (count == 0 || sumSqrDiff == 0) return INFINITY;
+    double mse = (double)sumSqrDiff / count;
+    return 10.0 * std::log10(255.0 * 255.0 / mse);
+}
+
+// per channel: asli, hasil, asli^2, hasil^2, asli x hasil
+static const int kSSIMQuantities = 15;
+
+// Jumlah SSIM jendela yang baris atasnya di [y0, y1); baris hasil dibaca
+// berurutan dari y0 lewat nextRow (RGB). Tiap baris difilter horizontal ke
+// ring buffer setinggi jendela, lalu vertikal: kotak lewat jumlah berjalan
+// (nilai integer, jadi tepat), Gaussian lewat bobot kernel.
+template <typename NextRow>
+static void ssimBand(const std::vector<std::vector<Color>>& original, NextRow&& nextRow,
+                     const std::vector<double>& kernel, bool box, int y0, int y1, double channelSum[3]) {
+    int width = (int)original[0].size();
+    int size = (int)kernel.size();
+    int validWidth = width - size + 1;
+    double norm = box ? 1.0 / ((double)size * size) : 1.0;
+    double C1 = (0.01 * 255) * (0.01 * 255);
+    double C2 = (0.03 * 255) * (0.03 * 255);
+
+    size_t planeSize = (size_t)kSSIMQuantities * validWidth;
+    std::vector<double> values((size_t)kSSIMQuantities * width);
+    std::vector<double> ring(planeSize * size);
+    std::vector<double> window(planeSize, 0.0);
+    for (int y = y0; y < y1 + size - 1; ++y) {
+        const Color* a = original[y].data();
+        const unsigned char* b = nextRow();
+        for (int x = 0; x < width; ++x) {
+            double pixelA[3] = {(double)a[x].r, (double)a[x].g, (double)a[x].b};
+            for (int channel = 0; channel < 3; ++channel) {
+                double va = pixelA[channel];
+                double vb = b[x * 3 + channel];
+                double* v = values.data() + (size_t)channel * 5 * width + x;
+                v[0] = va;
+                v[width] = vb;
+                v[2 * width] = va * va;
+                v[3 * width] = vb * vb;
+                v[4 * width] = va * vb;
+            }
+        }
+
+        double* slot = ring.data() + (size_t)((y - y0) % size) * planeSize;
+        // baris yang keluar dari jendela dikurangi sebelum slotnya ditimpa
+        if (box && y - y0 >= size) {
+            for (size_t i = 0; i < planeSize; ++i) window[i] -= slot[i];
+        }
+        for (int q = 0; q < kSSIMQuantities; ++q) {
+            const double* v = values.data() + (size_t)q * width;
+            double* h = slot + (size_t)q * validWidth;
+            if (box) {
+                double run = 0.0;
+                for (int t = 0; t < size; ++t) run += v[t];
+                h[0] = run;
+                for (int x = 1; x < validWidth; ++x) {
+                    run += v[x + size - 1] - v[x - 1];
+                    h[x] = run;
+                }
+            } else {
+                for (int x = 0; x < validWidth; ++x) {
+                    double sum = 0.0;
+                    for (int t = 0; t < size; ++t) sum += kernel[t] * v[x + t];
+                    h[x] = sum;
+                }
+            }
+        }
+        if (box) {
+            for (size_t i = 0; i < planeSize; ++i) window[i] += slot[i];
+        }
+        if (y - y0 < size - 1) continue;
+        if (!box) {
+            std::fill(window.begin(), window.end(), 0.0);
+            for (int t = 0; t < size; ++t) {
+                const double* row = ring.data() + (size_t)((y - y0 - size + 1 + t) % size) * planeSize;
+                for (size_t i = 0; i < planeSize; ++i) window[i] += kernel[t] * row[i];
+            }
+        }
+
+        for (int channel = 0; channel < 3; ++channel) {
+            const double* f = window.data() + (size_t)channel * 5 * validWidth;
+            for (int x = 0; x < validWidth; ++x) {
+                double meanA = f[x] * norm;
+                double meanB = f[validWidth + x] * norm;
+                double varianceA = f[2 * validWidth + x] * norm - meanA * meanA;
+                double varianceB = f[3 * validWidth + x] * norm - meanB * meanB;
+                double covariance = f[4 * validWidth + x] * norm - meanA * meanB;
+                channelSum[channel] += ((2 * meanA * meanB + C1) * (2 * covariance + C2)) /
+                                       ((meanA * meanA + meanB * meanB + C1) * (varianceA + varianceB + C2));
+            }
+        }
+    }
+}
+
+// makeSource(y0) membuat pembaca baris hasil mulai dari baris y0
+template <typename MakeSource>
+static ImageSSIMReport imageSSIM(const std::vector<std::vector<Color>>& original, MakeSource&& makeSource,
+                                 SSIMWindow window, int threads) {
+    ImageSSIMReport report;
+    int height = (int)original.size();
+    int width = height > 0 ? (int)original[0].size() : 0;
+    if (width <= 0) return report;
+
+    std::vector<double> kernel;
+    bool box = window == SSIM_WINDOW_BOX || width < 11 || height < 11;
+    if (box) {
+        kernel.assign(std::min(8, std::min(width, height)), 1.0);
+    } else {
+        double sigma = 1.5, total = 0.0;
+        for (int t = -5; t <= 5; ++t) {
+            kernel.push_back(std::exp(-(t * t) / (2 * sigma * sigma)));
+            total += kernel.back();
+        }
+        for (double& weight : kernel) weight /= total;
+    }
+    int size = (int)kernel.size();
+    int rows = height - size + 1;
+
+    // pita baris jendela saling lepas, masing-masing membaca size - 1 baris
+    // tambahan di bawahnya; jumlah per pita digabung urut supaya hasil tetap
+    int parallel = threads <= 0 ? ThreadPool::global().size() : threads;
+    int chunkRows = std::max(64, (rows + parallel * 4 - 1) / (parallel * 4));
+    int chunks = (rows + chunkRows - 1) / chunkRows;
+    std::vector<double> sums((size_t)chunks * 3, 0.0);
+    auto runChunk = [&](size_t i) {
+        int y0 = (int)i * chunkRows;
+        auto nextRow = makeSource(y0);
+        ssimBand(original, nextRow, kernel, box, y0, std::min(rows, y0 + chunkRows), sums.data() + i * 3);
+    };
+    if (parallel <= 1 || chunks <= 1) {
+        for (int i = 0; i < chunks; ++i) runChunk(i);
+    } else {
+        ThreadPool::global().parallelFor(chunks, runChunk, parallel);
+    }
+
+    report.windows = (long long)rows * (width - size + 1);
+    for (int i = 0; i < chunks; ++i) {
+        for (int channel = 0; channel < 3; ++channel) report.channel[channel] += sums[(size_t)i * 3 + channel];
+    }
+    for (int channel = 0; channel < 3; ++channel) report.channel[channel] /= report.windows;
+    report.ssim = (report.channel[0] + report.channel[1] + report.channel[2]) / 3.0;
+    return report;
+}
+
+ImageSSIMReport hitungImageSSIM(const std::vector<std::vector<Color>>& original,
+                                const std::vector<std::vector<Color>>& result, SSIMWindow window, int threads) {
+    if (original.empty() || result.size() != original.size()) return ImageSSIMReport();
+    for (size_t y = 0; y < original.size(); ++y) {
+        if (result[y].size() != original[y].size()) return ImageSSIMReport();
+    }
+    return imageSSIM(original, [&](int y0) {
+        return [&result, y = y0, row = std::vector<unsigned char>(original[0].size() * 3)]() mutable {
+            const std::vector<Color>& source = result[y++];
+            for (size_t x = 0; x < source.size(); ++x) {
+                row[x * 3] = source[x].r;
+                row[x * 3 + 1] = source[x].g;
+                row[x * 3 + 2] = source[x].b;
+            }
+            return (const unsigned char*)row.data();
+        };
+    }, window, threads);
+}
+
+ImageSSIMReport hitungImageSSIM(const std::vector<std::vector<Color>>& original, const QuadTree& tree,
+                                SSIMWindow window, int threads) {
+    if (original.empty() || tree.getHeight() != (int)original.size() ||
+        tree.getWidth() != (int)original[0].size()) {
+        return ImageSSIMReport();
+    }
+    const LeafRowIndex& index = tree.getRowIndex();
+    return imageSSIM(original, [&](int y0) {
+        return [renderer = ScanlineRenderer(index, y0)]() mutable { return renderer.nextRow(); };
+    }, window, threads);
+}
+
 size_t getFileSize(const std::string& filepath) {
     std::ifstream file(filepath, std::ios::binary | std::ios::ate);
     if (!file.is_open()) {
@@ -180,79 +397,158 @@ std::string getFileExtension(const std::string& filename) {
     return ext;
 }
 
-bool readImage(const std::string& filename, std::vector<std::vector<Color>>& image, int& width, int& height) {
-    int channels;
-    unsigned char* data = stbi_load(filename.c_str(), &width, &height, &channels, 3);
-    
-    if (!data) {
-        std::cerr << "Gagal memuat gambar:" << filename << std::endl;
-        std::cerr << "Debug STB: " << stbi_failure_reason() << std::endl;
-        return false;
+bool isSupportedImageFormat(const std::string& extension) {
+    return extension == "png" || extension == "jpg" || extension == "jpeg" ||
+           extension == "bmp" || extension == "tga";
+}
+
+void pixelsToImage(const unsigned char* data, int width, int height, int channels, std::vector<std::vector<Color>>& image) {
+    // resize per baris supaya kapasitas buffer lama tetap terpakai
+    image.resize(height);
+    for (int y = 0; y < height; y++) {
+        std::vector<Color>& row = image[y];
+        row.resize(width);
+        const unsigned char* src = data + (size_t)y * width * channels;
+        for (int x = 0; x < width; x++, src += channels) {
+            if (channels >= 3) {
+                row[x] = Color(src[0], src[1], src[2]);
+            } else {
+                row[x] = Color(src[0], src[0], src[0]);
+            }
+        }
     }
-    image.resize(height, std::vector<Color>(width));
-    
+}
+
+void imageToPixels(const std::vector<std::vector<Color>>& image, std::vector<unsigned char>& pixels) {
+    int height = image.size();
+    int width = height > 0 ? image[0].size() : 0;
+    pixels.resize((size_t)width * height * 3);
+
+    unsigned char* dst = pixels.data();
     for (int y = 0; y < height; y++) {
         for (int x = 0; x < width; x++) {
-            int index = (y * width + x) * 3;
-            image[y][x] = Color(data[index], data[index + 1], data[index + 2]);
+            *dst++ = image[y][x].r;
+            *dst++ = image[y][x].g;
+            *dst++ = image[y][x].b;
         }
     }
+}
+
+// alasan gagal sebelum decoder dipanggil (file tidak bisa dibuka, buffer
+// kosong); kosong = gagal di decoder, alasannya dari stbi_failure_reason
+static thread_local std::string loadFailure;
+
+bool readImage(const std::string& filename, std::vector<std::vector<Color>>& image, int& width, int& height) {
+    // file di-mmap lalu langsung diberikan ke decoder tanpa salinan lewat stdio
+    MappedFile file;
+    errno = 0;
+    if (!file.open(filename)) {
+        int error = errno;
+        loadFailure = error ? std::strerror(error) : "file kosong atau tidak bisa dibaca";
+        return false;
+    }
+    return readImageFromMemory(file.data(), file.size(), image, width, height);
+}
+
+bool readImageFromMemory(const unsigned char* bytes, size_t size, std::vector<std::vector<Color>>& image, int& width, int& height) {
+    loadFailure.clear();
+    if (!bytes || size == 0 || size > (size_t)INT_MAX) {
+        loadFailure = "buffer kosong atau terlalu besar";
+        return false;
+    }
+
+    int channels;
+    unsigned char* data = stbi_load_from_memory(bytes, (int)size, &width, &height, &channels, 3);
+    if (!data) return false;
+
+    pixelsToImage(data, width, height, 3, image);
     stbi_image_free(data);
     return true;
 }
 
-bool writeImage(const std::string& filename, const std::vector<std::vector<Color>>& image) {
-    if (image.empty() || image[0].empty()) {
-        std::cerr << "Gambarnya kosong :(" << std::endl;
-        return false;
+const char* imageLoadFailureReason() {
+    if (!loadFailure.empty()) return loadFailure.c_str();
+    const char* reason = stbi_failure_reason();
+    return reason ? reason : "";
+}
+
+static bool writeBytes(const std::string& filename, const std::vector<unsigned char>& bytes) {
+    FILE* f = std::fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+static void appendToBuffer(void* context, void* data, int size) {
+    std::vector<unsigned char>* out = static_cast<std::vector<unsigned char>*>(context);
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    out->insert(out->end(), bytes, bytes + size);
+}
+
+bool encodeImage(const std::string& extension, const unsigned char* pixels, int width, int height,
+                 std::vector<unsigned char>& out, int jpgQuality) {
+    if (!pixels || width <= 0 || height <= 0) return false;
+
+    out.clear();
+    int success = 0;
+    if (extension == "png") {
+        success = stbi_write_png_to_func(appendToBuffer, &out, width, height, 3, pixels, width * 3);
+    } else if (extension == "jpg" || extension == "jpeg") {
+        JpegWriteOptions options;
+        options.quality = jpgQuality;
+        return encodeJPEG(pixels, width, height, out, options);
+    } else if (extension == "bmp") {
+        success = stbi_write_bmp_to_func(appendToBuffer, &out, width, height, 3, pixels);
+    } else if (extension == "tga") {
+        success = stbi_write_tga_to_func(appendToBuffer, &out, width, height, 3, pixels);
     }
-    std::cout << "Memroses gambar..." << std::endl;
+    return success != 0;
+}
+
+bool writeImageToMemory(const std::string& extension, const std::vector<std::vector<Color>>& image,
+                        std::vector<unsigned char>& out, int jpgQuality) {
+    if (image.empty() || image[0].empty()) return false;
+    if (!isSupportedImageFormat(extension)) return false;
+
+    std::vector<unsigned char> data;
+    imageToPixels(image, data);
+    return encodeImage(extension, data.data(), image[0].size(), image.size(), out, jpgQuality);
+}
+
+void setPngCompressionLevel(int level) {
+    stbi_write_png_compression_level = std::max(0, std::min(level, 9));
+}
+
+bool writeImage(const std::string& filename, const std::vector<std::vector<Color>>& image) {
+    if (image.empty() || image[0].empty()) return false;
+
     int height = image.size();
     int width = image[0].size();
     std::string extension = getFileExtension(filename);
-    
-    unsigned char* data = new unsigned char[width * height * 3];
-    
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            int index = (y * width + x) * 3;
-            data[index] = image[y][x].r;
-            data[index + 1] = image[y][x].g;
-            data[index + 2] = image[y][x].b;
-        }
-    }
-    
-    bool success = false;
-    
+    if (!isSupportedImageFormat(extension)) return false;
+
+    std::vector<unsigned char> data;
+    imageToPixels(image, data);
+
+    int success = 0;
     if (extension == "png") {
-        success = stbi_write_png(filename.c_str(), width, height, 3, data, width * 3);
+        success = stbi_write_png(filename.c_str(), width, height, 3, data.data(), width * 3);
     } 
     else if (extension == "jpg" || extension == "jpeg") {
-        success = stbi_write_jpg(filename.c_str(), width, height, 3, data, 90); // 90 kualitas (0-100)
+        std::vector<unsigned char> encoded; // kualitas default 90
+        success = encodeJPEG(data.data(), width, height, encoded) && writeBytes(filename, encoded);
     }
     else if (extension == "bmp") {
-        success = stbi_write_bmp(filename.c_str(), width, height, 3, data);
+        success = stbi_write_bmp(filename.c_str(), width, height, 3, data.data());
     }
     else if (extension == "tga") {
-        success = stbi_write_tga(filename.c_str(), width, height, 3, data);
-    }
-    else {
-        std::cerr << "Format tidak didukung :(" << extension << std::endl;
-        std::cerr << "Format sudah salah satu dari png, jpg, jpeg, bmp, tga belum? :)" << std::endl;
-        delete[] data;
-        return false;
-    }
-    
-    delete[] data;
-    
-    if (!success) {
-        std::cerr << "Gagal write gambar: " << filename << std::endl;
-        return false;
+        success = stbi_write_tga(filename.c_str(), width, height, 3, data.data());
     }
-    return true;
+    return success != 0;
 }
 
-void createQuadtreeGIF(
+bool createQuadtreeGIF(
+    GifEncoder& encoder,
     const std::string& outputGifPath,
     const std::vector<std::vector<Color>>& originalImage,
     QuadTree& quadtree,
@@ -264,17 +560,15 @@ void createQuadtreeGIF(
     int width = originalImage[0].size();
     int height = originalImage.size();
         
-    GifWriter gifWriter = {};
-    GifBegin(&gifWriter, outputGifPath.c_str(), width, height, 100); // 100ms per frame
+    if (!encoder.open(outputGifPath, width, height, 100)) return false; // 100ms per frame
     
+    std::vector<uint8_t> rgbaPixels((size_t)width * height * 4);
     for (int depth = 0; depth <= maxDepth; depth++) {
         std::vector<std::vector<Color>> frameImage = quadtree.reconstructImageForGIF(depth);
         
-        std::vector<uint8_t> rgbaPixels(width * height * 4);
-        
         for (int y = 0; y < height; y++) {
             for (int x = 0; x < width; x++) {
-                int idx = (y * width + x) * 4;
+                size_t idx = ((size_t)y * width + x) * 4;
                 
                 if (y < frameImage.size() && x < frameImage[y].size()) {
                     Color c = frameImage[y][x];
@@ -290,62 +584,183 @@ void createQuadtreeGIF(
                 }
             }
         }
-        GifWriteFrame(&gifWriter, rgbaPixels.data(), width, height, 100);
+        if (!encoder.writeFrame(rgbaPixels.data(), 100)) {
+            encoder.finish();
+            return false;
+        }
     }
+    return encoder.finish();
+}
+
+bool createQuadtreeGIF(
+    const std::string& outputGifPath,
+    const std::vector<std::vector<Color>>& originalImage,
+    QuadTree& quadtree,
+    int errorMethod,
+    double threshold,
+    int minBlockSize
+) {
+    GifEncoder encoder;
+    return createQuadtreeGIF(encoder, outputGifPath, originalImage, quadtree, errorMethod, threshold, minBlockSize);
 }
 
+// Satu titik kurva ukuran pencarian threshold. Posisi 0 = threshold terhalus
+// (0, SSIM: maxThreshold), 1 = error root: threshold di luar itu semuanya
+// menghasilkan root saja, jadi rentang pencarian dipotong di sana.
+struct CompressionSample {
+    double position;
+    double ratio;
+    bool known;     // false = ujung rentang yang belum dievaluasi
+};
+
+// sifat metrik yang dipakai pencarian threshold, dibaca dari policy-nya
+struct ThresholdRange {
+    double limit;           // threshold valid 0-limit
+    bool higherIsBetter;    // true = threshold makin besar makin halus
+    bool usesIntegral;
+};
+
 double estimateThresholdForTargetCompression(
     const std::vector<std::vector<Color>>& image, 
     int errorMethod, 
     int minBlockSize, 
     double targetCompression,
-    int originalSize
+    int originalSize,
+    int threads
 ) {
-    double low = 0.0;
-    double high = (errorMethod == 1) ? 128 * 128 : 1.0; // max threshold tergantung metode
-    if (errorMethod == 2 || errorMethod == 3) high = 255;
-    if (errorMethod == 4) high = 8.0;
+    ThresholdRange range = withMetric(errorMethod, [](auto metric) {
+        using Metric = decltype(metric);
+        return ThresholdRange{Metric::maxThreshold, Metric::higherIsBetter, Metric::usesIntegral};
+    });
+    double fineThreshold = range.higherIsBetter ? range.limit : 0.0;
+    double coarseThreshold = range.higherIsBetter ? 0.0 : range.limit;
 
-    double tolerance = 0.01; // 1% toleransi
-    double bestThreshold = (errorMethod == 5) ? high / 2 : low;
+    const double tolerance = 0.01; // 1% toleransi
+    // serial: tiap putaran hanya satu tebakan; paralel: tebakan plus dua titik
+    // di kiri dan kanannya, dievaluasi bersamaan
+    int parallel = threads <= 0 ? ThreadPool::global().size() : threads;
+    int candidatesPerRound = parallel >= 3 ? 3 : 1;
+    // batas total build + encode, bukan batas putaran: ujung kasar + 7 tebakan
+    // serial atau + 4 putaran paralel
+    const int maxEvaluations = candidatesPerRound == 3 ? 13 : 8;
 
-    for (int i = 0; i < 20; i++) {
-        // std::cout << "Mencari threshold... " << (i+1) << std::endl;
-        double mid = (low + high) / 2.0;
+    // tree dan buffer tiap kandidat dipakai ulang antar putaran, hasil encode
+    // tidak pernah ditulis ke disk
+    std::vector<QuadTree> trees(candidatesPerRound);
+    std::vector<std::vector<unsigned char>> encoded(candidatesPerRound);
+    // metrik dengan tabel integral: cukup dibentuk sekali untuk semua kandidat
+    IntegralImage integral;
+    if (range.usesIntegral) {
+        integral.build(image);
+        for (QuadTree& tree : trees) tree.useIntegralImage(&integral);
+    }
+    auto evaluate = [&](size_t slot, double threshold) {
+        trees[slot].buildfrImage(image, errorMethod, threshold, minBlockSize);
+        // ukuran jpg langsung dari daun, tanpa rekonstruksi gambar
+        encodeQuadtreeJPEG(trees[slot], encoded[slot]);
+        return 1.0 - static_cast<double>(encoded[slot].size()) / originalSize;
+    };
 
-        QuadTree qt;
-        qt.buildfrImage(image, errorMethod, mid, minBlockSize);
-        std::vector<std::vector<Color>> reconstructed = qt.reconstructImage(image[0].size(), image.size());
+    // Ujung kasar (root saja) murah dan dievaluasi lebih dulu: jika target tidak
+    // di bawah rasionya, tree paling kasar sudah jawaban terbaik. Error root
+    // menjadi ujung rentang. Ujung halus mahal dan tidak dievaluasi.
+    double coarseRatio = evaluate(0, coarseThreshold);
+    int evaluations = 1;
+    double bestThreshold = coarseThreshold;
+    double bestDistance = std::abs(coarseRatio - targetCompression);
+    if (!trees[0].getRoot() || coarseRatio <= targetCompression + tolerance) return bestThreshold;
+    double rootError = trees[0].getRoot()->getError();
+    // gambar rata: semua threshold menghasilkan root saja
+    if (rootError == fineThreshold) return bestThreshold;
+    auto thresholdAt = [&](double position) { return fineThreshold + position * (rootError - fineThreshold); };
 
-        std::string tempOut = "temp.jpg";
-        writeImage(tempOut, reconstructed);
-        int compressedSize = getFileSize(tempOut);
-        std::remove(tempOut.c_str());
+    // Rasio tidak monoton terhadap threshold (tree sangat halus bisa lebih besar
+    // dari aslinya lalu mengecil lagi), tetapi naik monoton dari titik terendahnya
+    // ke ujung kasar. Titik di bawah target selalu menggantikan ujung halus,
+    // jadi pencarian mengikuti cabang kasar itu.
+    CompressionSample fine{0.0, 0.0, false};
+    CompressionSample coarse{1.0, coarseRatio, true};
+    // titik sebelum ujung kasar, untuk secant selama ujung halus belum diketahui
+    CompressionSample outer{0.0, 0.0, false};
+    // Illinois: ujung yang bertahan dua kali berturut-turut bobotnya dibagi dua,
+    // supaya regula falsi tidak macet di satu sisi kurva yang melengkung
+    double fineScale = 1.0, coarseScale = 1.0;
+    int lastReplaced = 0;
 
-        double compressionRatio = 1.0 - static_cast<double>(compressedSize) / originalSize;
+    while (evaluations < maxEvaluations) {
+        double width = coarse.position - fine.position;
+        // rasio melompat di antara dua threshold yang hampir sama (mis. root
+        // saja vs root terpecah): target di celah itu tidak bisa didekati lagi
+        if (width < 1e-3) break;
 
-        // std::cout << "Threshold: " << mid << std::endl;
+        // tebakan: regula falsi antara kedua ujung jika keduanya diketahui,
+        // selain itu secant lewat ujung kasar dan titik sebelumnya, selain itu
+        // tengah rentang. Dijaga di dalam rentang supaya rentang tetap menyempit.
+        auto guessAt = [&](double fineWeight, double coarseWeight) {
+            double t = 0.5;
+            if (fine.known) {
+                double fineGap = (fine.ratio - targetCompression) * fineWeight;
+                double coarseGap = (coarse.ratio - targetCompression) * coarseWeight;
+                t = -fineGap / (coarseGap - fineGap);
+            } else if (outer.known && outer.ratio != coarse.ratio) {
+                double secant = coarse.position + (targetCompression - coarse.ratio) *
+                                                      (outer.position - coarse.position) / (outer.ratio - coarse.ratio);
+                t = (secant - fine.position) / width;
+            }
+            return fine.position + std::min(0.9, std::max(0.1, t)) * width;
+        };
 
-        if (std::abs(compressionRatio - targetCompression) <= tolerance) {
-            bestThreshold = mid;
-            break;
-        }
-        
-        if (errorMethod==5) {
-            if (compressionRatio < targetCompression) {
-                low = mid;
+        int count = std::min(candidatesPerRound, maxEvaluations - evaluations) == 3 ? 3 : 1;
+        double guess = guessAt(fineScale, coarseScale);
+        double positions[3] = {guess, guess, guess};
+        if (count == 3) {
+            // kurva melengkung ke arah yang belum diketahui: kandidat lain memakai
+            // bobot ujung halus atau ujung kasar yang dibagi dua, tanpa secant
+            // keduanya titik tengah di kiri dan kanan tebakan
+            if (fine.known) {
+                positions[0] = guessAt(fineScale * 0.5, coarseScale);
+                positions[2] = guessAt(fineScale, coarseScale * 0.5);
             } else {
-                high = mid;
+                positions[0] = (fine.position + guess) / 2;
+                positions[2] = (guess + coarse.position) / 2;
             }
+        }
+        double ratios[3];
+        // urutan kandidat tetap, jadi hasilnya sama untuk semua jumlah thread
+        if (count == 1) {
+            ratios[0] = evaluate(0, thresholdAt(positions[0]));
         } else {
-            if (compressionRatio < targetCompression) {
-                high = mid;
-            } else {
-                low = mid;
+            ThreadPool::global().parallelFor(3, [&](size_t i) {
+                ratios[i] = evaluate(i, thresholdAt(positions[i]));
+            }, parallel);
+        }
+        evaluations += count;
+
+        // yang terdekat ke target disimpan, bukan kandidat terakhir
+        for (int i = 0; i < count; i++) {
+            double distance = std::abs(ratios[i] - targetCompression);
+            if (distance < bestDistance) {
+                bestDistance = distance;
+                bestThreshold = thresholdAt(positions[i]);
             }
         }
-        bestThreshold = mid;
+        if (bestDistance <= tolerance) break;
+
+        // rentang baru = pasangan titik bersebelahan yang mengapit target
+        CompressionSample samples[5];
+        samples[0] = fine;
+        for (int i = 0; i < count; i++) samples[i + 1] = {positions[i], ratios[i], true};
+        samples[count + 1] = coarse;
+        int next = 1;
+        while (next < count + 1 && samples[next].ratio < targetCompression) next++;
+        // ujung yang diganti: 1 kasar, -1 halus, 0 keduanya (kandidat paralel)
+        int replaced = next == 1 ? 1 : next == count + 1 ? -1 : 0;
+        fineScale = replaced == 1 && lastReplaced == 1 ? fineScale * 0.5 : 1.0;
+        coarseScale = replaced == -1 && lastReplaced == -1 ? coarseScale * 0.5 : 1.0;
+        lastReplaced = replaced;
+        if (!samples[next - 1].known) outer = samples[next + 1];
+        fine = samples[next - 1];
+        coarse = samples[next];
     }
-    // std::cout << "Final threshold" << bestThreshold << std::endl;
     return bestThreshold;
 }
\ No newline at end of file
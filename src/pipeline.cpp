@@ -0,0 +1,257 @@
+#include "header/pipeline.h"
+#include "header/boundedqueue.h"
+#include "header/mappedfile.h"
+#include "header/op.h"
+#include "header/imagewriter.h"
+#include "header/gifwriter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <thread>
+
+namespace {
+
+struct PipelineItem {
+    size_t index = 0;
+    std::chrono::steady_clock::time_point start;    // reader mengambil job, awal jam deadline
+    std::vector<std::vector<Color>> image;
+    int width = 0;
+    int height = 0;
+    QuadTree tree;
+    std::vector<std::unique_ptr<QuadTree>> variantTrees;  // satu per PipelineJob::variants
+};
+
+using ItemPtr = std::unique_ptr<PipelineItem>;
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+bool writeFile(const std::string& path, const std::vector<unsigned char>& bytes) {
+    FILE* f = std::fopen(path.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(bytes.data(), 1, bytes.size(), f) == bytes.size();
+    return std::fclose(f) == 0 && ok;
+}
+
+// mode variants hanya build persis tanpa batas (lihat PipelineJob::variants)
+QtStatus validateVariants(const PipelineJob& job) {
+    const QtEncodeOptions& opt = job.options;
+    if (opt.budget.isLimited() || opt.deadlineMillis > 0 || opt.targetCompression > 0 || opt.sampling.enabled ||
+        opt.targetQuality.isActive()) {
+        return QT_ERR_INVALID_ARGUMENT;
+    }
+    for (const auto& variant : job.variants) {
+        QtEncodeOptions variantOptions = opt;
+        variantOptions.errorMethod = variant.errorMethod;
+        variantOptions.threshold = variant.threshold;
+        QtStatus status = qtValidateOptions(variantOptions);
+        if (status != QT_OK) return status;
+    }
+    return QT_OK;
+}
+
+void fillResult(PipelineResult& result, const QuadTree& tree) {
+    result.totalNodes = tree.getTotalNodes();
+    result.maxDepth = tree.getMaxDepth();
+    result.leaves = tree.getLeafCount();
+    result.residualError = tree.hitungResidualError();
+    result.scanStats = tree.getScanStats();
+}
+
+}
+
+std::vector<PipelineResult> runPipeline(const std::vector<PipelineJob>& jobs, const PipelineOptions& options) {
+    // hasil job i mulai di resultStart[i], satu per variant jika ada
+    std::vector<size_t> resultStart(jobs.size() + 1, 0);
+    for (size_t i = 0; i < jobs.size(); i++) {
+        resultStart[i + 1] = resultStart[i] + std::max<size_t>(1, jobs[i].variants.size());
+    }
+    std::vector<PipelineResult> results(resultStart.back());
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const PipelineJob& job = jobs[i];
+        for (size_t k = resultStart[i]; k < resultStart[i + 1]; k++) {
+            PipelineResult& result = results[k];
+            result.inputPath = job.inputPath;
+            if (job.variants.empty()) {
+                result.outputPath = job.outputPath;
+                result.errorMethod = job.options.errorMethod;
+            } else {
+                const PipelineVariant& variant = job.variants[k - resultStart[i]];
+                result.outputPath = variant.outputPath;
+                result.errorMethod = variant.errorMethod;
+                result.threshold = variant.threshold;
+            }
+        }
+    }
+    if (jobs.empty()) return results;
+    auto setJobStatus = [&](size_t i, QtStatus status) {
+        for (size_t k = resultStart[i]; k < resultStart[i + 1]; k++) results[k].status = status;
+    };
+
+    int writerThreads = std::max(1, options.writerThreads);
+    int computeThreads = options.computeThreads;
+    if (computeThreads <= 0) {
+        int cores = (int)std::thread::hardware_concurrency();
+        computeThreads = std::max(1, cores - 1 - writerThreads);
+    }
+    size_t capacity = std::max<size_t>(1, options.queueCapacity);
+
+    BoundedQueue<ItemPtr> decoded(capacity);
+    BoundedQueue<ItemPtr> built(capacity);
+
+    // tahap 1: baca dan decode
+    std::thread reader([&]() {
+        for (size_t i = 0; i < jobs.size(); i++) {
+            ItemPtr item(new PipelineItem());
+            item->index = i;
+            item->start = std::chrono::steady_clock::now();
+
+            MappedFile file;
+            if (!file.open(jobs[i].inputPath)) {
+                setJobStatus(i, QT_ERR_DECODE);
+                continue;
+            }
+            for (size_t k = resultStart[i]; k < resultStart[i + 1]; k++) results[k].originalSize = file.size();
+
+            QtEncodeOptions opt = jobs[i].options;
+            opt.originalSize = file.size();
+            if (qtValidateOptions(opt) != QT_OK ||
+                (!jobs[i].variants.empty() && validateVariants(jobs[i]) != QT_OK)) {
+                setJobStatus(i, QT_ERR_INVALID_ARGUMENT);
+                continue;
+            }
+            if (!readImageFromMemory(file.data(), file.size(), item->image, item->width, item->height)) {
+                setJobStatus(i, QT_ERR_DECODE);
+                continue;
+            }
+            decoded.push(std::move(item));
+        }
+        decoded.close();
+    });
+
+    // tahap 2: build quadtree
+    std::atomic<int> activeCompute(computeThreads);
+    std::vector<std::thread> computeWorkers;
+    for (int t = 0; t < computeThreads; t++) {
+        computeWorkers.emplace_back([&]() {
+            ItemPtr item;
+            while (decoded.pop(item)) {
+                const PipelineJob& job = jobs[item->index];
+                if (!job.variants.empty()) {
+                    // satu decode dan satu pass statistik untuk semua variant
+                    std::vector<QuadTreeConfig> configs;
+                    std::vector<QuadTree*> trees;
+                    for (const auto& variant : job.variants) {
+                        configs.push_back({variant.errorMethod, variant.threshold, job.options.minBlockSize});
+                        item->variantTrees.emplace_back(new QuadTree());
+                        trees.push_back(item->variantTrees.back().get());
+                    }
+                    QuadTree::buildMulti(item->image, configs, trees);
+                    for (size_t v = 0; v < trees.size(); v++) {
+                        PipelineResult& result = results[resultStart[item->index] + v];
+                        fillResult(result, *trees[v]);
+                        if (options.ssimReport) {
+                            result.ssim = hitungImageSSIM(item->image, *trees[v], options.ssimWindow, 1);
+                        }
+                    }
+                    built.push(std::move(item));
+                    continue;
+                }
+
+                PipelineResult& result = results[resultStart[item->index]];
+                QtEncodeOptions opt = job.options;
+
+                int minBlockSize = opt.minBlockSize;
+                double threshold = opt.threshold;
+                if (opt.targetCompression > 0) {
+                    minBlockSize = 1;
+                    // kandidat dievaluasi serial, tahap compute sudah paralel antar gambar
+                    threshold = estimateThresholdForTargetCompression(item->image, opt.errorMethod, minBlockSize,
+                                                                      opt.targetCompression, result.originalSize, 1);
+                }
+                // deadline dihitung sejak reader mengambil job: baca, decode, dan waktu antri ikut
+                QuadTreeBudget budget = opt.budget;
+                if (opt.deadlineMillis > 0 && !item->image.empty()) {
+                    opt.format = getFileExtension(job.outputPath);
+                    budget = qtDeadlineBudget(opt, (int)item->image[0].size(), (int)item->image.size(),
+                                              millisSince(item->start));
+                }
+                auto buildStart = std::chrono::steady_clock::now();
+                if (opt.targetQuality.isActive()) {
+                    QuadTreeQuality quality =
+                        item->tree.buildForQuality(item->image, opt.errorMethod, opt.targetQuality, minBlockSize);
+                    threshold = quality.threshold;
+                    result.quality = quality.value;
+                    result.qualityReached = quality.reached;
+                } else {
+                    result.buildStop = item->tree.build(item->image, opt.errorMethod, threshold, minBlockSize,
+                                                        budget, opt.sampling);
+                }
+
+                result.buildMillis = millisSince(buildStart);
+                result.threshold = threshold;
+                fillResult(result, item->tree);
+                if (options.ssimReport) {
+                    // satu thread per gambar, tahap compute sudah paralel antar gambar
+                    result.ssim = hitungImageSSIM(item->image, item->tree, options.ssimWindow, 1);
+                }
+                built.push(std::move(item));
+            }
+            if (activeCompute.fetch_sub(1) == 1) built.close();
+        });
+    }
+
+    // tahap 3: encode dan tulis
+    std::vector<std::thread> writers;
+    for (int t = 0; t < writerThreads; t++) {
+        writers.emplace_back([&]() {
+            std::vector<unsigned char> encoded;
+            GifEncoder gifEncoder;  // buffer dipakai ulang untuk semua GIF di thread ini
+            ItemPtr item;
+            while (built.pop(item)) {
+                const PipelineJob& job = jobs[item->index];
+                ImageWriteOptions writeOptions;
+                writeOptions.pngLevel = job.options.pngLevel;
+                writeOptions.jpgQuality = job.options.jpgQuality;
+                writeOptions.threads = job.options.threads;
+
+                size_t outputs = resultStart[item->index + 1] - resultStart[item->index];
+                for (size_t v = 0; v < outputs; v++) {
+                    PipelineResult& result = results[resultStart[item->index] + v];
+                    QuadTree& tree = job.variants.empty() ? item->tree : *item->variantTrees[v];
+                    const std::string& gifPath = job.variants.empty() ? job.gifPath : job.variants[v].gifPath;
+
+                    std::string extension = getFileExtension(result.outputPath);
+                    if (!isSupportedImageFormat(extension)) {
+                        result.status = QT_ERR_UNSUPPORTED_FORMAT;
+                        continue;
+                    }
+                    if (!encodeQuadtreeImage(extension, tree, encoded, writeOptions) ||
+                        !writeFile(result.outputPath, encoded)) {
+                        result.status = QT_ERR_ENCODE;
+                        continue;
+                    }
+                    result.compressedSize = encoded.size();
+                    // GIF tidak termasuk deadline
+                    result.totalMillis = millisSince(item->start);
+                    result.deadlineMet = job.options.deadlineMillis <= 0 ||
+                                         result.totalMillis <= job.options.deadlineMillis;
+
+                    if (!gifPath.empty() &&
+                        !createQuadtreeGIF(gifEncoder, gifPath, item->image, tree, result.errorMethod,
+                                           result.threshold, job.options.minBlockSize)) {
+                        result.status = QT_ERR_ENCODE;
+                    }
+                }
+            }
+        });
+    }
+
+    reader.join();
+    for (auto& worker : computeWorkers) worker.join();
+    for (auto& writer : writers) writer.join();
+    return results;
+}
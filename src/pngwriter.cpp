@@ -0,0 +1,194 @@
+#include "header/pngwriter.h"
+#include "header/deflate.h"
+#include "header/threadpool.h"
+#include "header/scanline.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+namespace {
+
+void putU32(std::vector<unsigned char>& out, uint32_t v) {
+    out.push_back((unsigned char)(v >> 24));
+    out.push_back((unsigned char)(v >> 16));
+    out.push_back((unsigned char)(v >> 8));
+    out.push_back((unsigned char)v);
+}
+
+void writeChunk(std::vector<unsigned char>& out, const char* type, const unsigned char* data, uint32_t size) {
+    putU32(out, size);
+    size_t start = out.size();
+    out.insert(out.end(), type, type + 4);
+    if (size) out.insert(out.end(), data, data + size);
+    putU32(out, crc32Update(0, out.data() + start, size + 4));
+}
+
+uint64_t filterCost(const unsigned char* row, size_t size) {
+    uint64_t cost = 0;
+    for (size_t i = 0; i < size; i++) cost += std::abs((int)(signed char)row[i]);
+    return cost;
+}
+
+// filter baris yang berubah (Sub atau Up, mana yang lebih murah); above
+// nullptr untuk baris pertama. Hasil di buffer sub atau up, mengembalikan byte filter
+unsigned char filterChangedRow(const unsigned char* row, const unsigned char* above, size_t stride,
+                               std::vector<unsigned char>& subRow, std::vector<unsigned char>& upRow,
+                               const unsigned char*& chosen) {
+    for (size_t i = 0; i < 3 && i < stride; i++) subRow[i] = row[i];
+    for (size_t i = 3; i < stride; i++) subRow[i] = row[i] - row[i - 3];
+
+    chosen = subRow.data();
+    if (!above) return 1;
+
+    for (size_t i = 0; i < stride; i++) upRow[i] = row[i] - above[i];
+    if (filterCost(upRow.data(), stride) < filterCost(subRow.data(), stride)) {
+        chosen = upRow.data();
+        return 2;
+    }
+    return 1;
+}
+
+// data hasil filter untuk baris [y0, y1), untuk mode paralel
+void filterRows(const LeafRowIndex& index, size_t stride, int y0, int y1, std::vector<unsigned char>& dst) {
+    std::vector<unsigned char> subRow(stride), upRow(stride);
+    ScanlineRenderer renderer(index, y0);
+    dst.clear();
+    dst.reserve((size_t)(y1 - y0) * (stride + 1));
+    for (int y = y0; y < y1; y++) {
+        const unsigned char* row = renderer.nextRow();
+        if (!renderer.rowChanged()) {
+            dst.push_back(2);
+            dst.insert(dst.end(), stride, 0);
+            continue;
+        }
+        const unsigned char* chosen;
+        dst.push_back(filterChangedRow(row, y > 0 ? renderer.previousRow() : nullptr, stride, subRow, upRow, chosen));
+        dst.insert(dst.end(), chosen, chosen + stride);
+    }
+}
+
+// stream zlib dari pita-pita baris yang di-deflate paralel lalu disambung
+void deflateBandsParallel(const LeafRowIndex& index, size_t stride, int height,
+                          const PngWriteOptions& options, int parallel, std::vector<unsigned char>& out) {
+    const size_t bandBytes = 1 << 18;
+    const size_t dictionaryBytes = 1 << 15;
+    int bandRows = (int)std::max<size_t>(1, bandBytes / (stride + 1));
+    int bands = (height + bandRows - 1) / bandRows;
+
+    std::vector<std::vector<unsigned char>> parts(bands);
+    std::vector<uint32_t> adlers(bands);
+    std::vector<size_t> sizes(bands);
+
+    ThreadPool::global().parallelFor(bands, [&](size_t b) {
+        int y0 = (int)b * bandRows;
+        int y1 = std::min(height, y0 + bandRows);
+        std::vector<unsigned char> data;
+        filterRows(index, stride, y0, y1, data);
+
+        DeflateEncoder deflate(parts[b], options.level, DEFLATE_RAW);
+        if (y0 > 0) {
+            // baris-baris terakhir pita sebelumnya menjadi dictionary
+            int dictRows = (int)std::min<size_t>(y0, (dictionaryBytes + stride) / (stride + 1));
+            std::vector<unsigned char> dictionary;
+            filterRows(index, stride, y0 - dictRows, y0, dictionary);
+            deflate.setDictionary(dictionary.data(), dictionary.size());
+        }
+        deflate.write(data.data(), data.size());
+        if ((int)b + 1 == bands) {
+            deflate.finish();
+        } else {
+            deflate.flushSync();
+        }
+        adlers[b] = adler32Update(1, data.data(), data.size());
+        sizes[b] = data.size();
+    }, parallel);
+
+    out.push_back(0x78);
+    out.push_back(zlibLevelFlag(options.level));
+    uint32_t adler = 1;
+    for (int b = 0; b < bands; b++) {
+        out.insert(out.end(), parts[b].begin(), parts[b].end());
+        adler = b == 0 ? adlers[0] : adler32Combine(adler, adlers[b], sizes[b]);
+    }
+    putU32(out, adler);
+}
+
+}
+
+bool encodeQuadtreePNG(const QuadTree& tree, std::vector<unsigned char>& out, const PngWriteOptions& options) {
+    int width = tree.getWidth();
+    int height = tree.getHeight();
+    if (!tree.getRoot() || width <= 0 || height <= 0) return false;
+
+    // baris dibangkitkan satu per satu dari daun, tanpa gambar penuh
+    const LeafRowIndex& index = tree.getRowIndex();
+
+    out.clear();
+    static const unsigned char signature[8] = {0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n'};
+    out.insert(out.end(), signature, signature + 8);
+
+    unsigned char ihdr[13];
+    ihdr[0] = (unsigned char)(width >> 24); ihdr[1] = (unsigned char)(width >> 16);
+    ihdr[2] = (unsigned char)(width >> 8);  ihdr[3] = (unsigned char)width;
+    ihdr[4] = (unsigned char)(height >> 24); ihdr[5] = (unsigned char)(height >> 16);
+    ihdr[6] = (unsigned char)(height >> 8);  ihdr[7] = (unsigned char)height;
+    ihdr[8] = 8;   // bit depth
+    ihdr[9] = 2;   // truecolor RGB
+    ihdr[10] = 0;  // deflate
+    ihdr[11] = 0;  // filter adaptif
+    ihdr[12] = 0;  // tanpa interlace
+    writeChunk(out, "IHDR", ihdr, 13);
+
+    // IDAT: panjang diisi setelah stream zlib selesai
+    size_t idatStart = out.size();
+    putU32(out, 0);
+    out.insert(out.end(), {'I', 'D', 'A', 'T'});
+
+    size_t stride = (size_t)width * 3;
+    ThreadPool& pool = ThreadPool::global();
+    int parallel = options.threads <= 0 ? pool.size() : options.threads;
+
+    if (parallel > 1 && (size_t)height * (stride + 1) >= (size_t)2 << 18) {
+        deflateBandsParallel(index, stride, height, options, parallel, out);
+    } else {
+        std::vector<unsigned char> subRow(stride), upRow(stride);
+        DeflateEncoder deflate(out, options.level);
+        ScanlineRenderer renderer(index);
+
+        for (int y = 0; y < height; y++) {
+            const unsigned char* row = renderer.nextRow();
+            // baris y berbeda dari baris y-1 hanya jika ada daun yang dimulai di y
+            if (!renderer.rowChanged()) {
+                deflate.writeRun(2, 1);      // filter Up
+                deflate.writeRun(0, stride); // selisih dengan baris atas selalu nol
+                continue;
+            }
+            const unsigned char* chosen;
+            unsigned char filter = filterChangedRow(row, y > 0 ? renderer.previousRow() : nullptr,
+                                                    stride, subRow, upRow, chosen);
+            deflate.write(&filter, 1);
+            deflate.write(chosen, stride);
+        }
+        deflate.finish();
+    }
+
+    size_t idatSize = out.size() - idatStart - 8;
+    out[idatStart] = (unsigned char)(idatSize >> 24);
+    out[idatStart + 1] = (unsigned char)(idatSize >> 16);
+    out[idatStart + 2] = (unsigned char)(idatSize >> 8);
+    out[idatStart + 3] = (unsigned char)idatSize;
+    putU32(out, crc32Update(0, out.data() + idatStart + 4, idatSize + 4));
+
+    writeChunk(out, "IEND", nullptr, 0);
+    return true;
+}
+
+bool writeQuadtreePNG(const std::string& filename, const QuadTree& tree, const PngWriteOptions& options) {
+    std::vector<unsigned char> data;
+    if (!encodeQuadtreePNG(tree, data, options)) return false;
+
+    FILE* f = std::fopen(filename.c_str(), "wb");
+    if (!f) return false;
+    bool ok = std::fwrite(data.data(), 1, data.size(), f) == data.size();
+    return std::fclose(f) == 0 && ok;
+}
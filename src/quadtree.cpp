@@ -1,27 +1,148 @@
 #include "header/quadtree.h"
-#include "header/op.h"
+#include "header/quadtreebuild.h"
+#include "header/threadpool.h"
 #include <algorithm>
 #include <cmath>
+#include <deque>
+#include <utility>
+
+namespace {
+
+// isi row dengan warna daun yang menutupi baris y, cukup menuruni node yang
+// memotong baris itu
+void paintNodeRow(const QuadTreeNode* node, int y, std::vector<Color>& row) {
+    if (!node || y < node->getY() || y >= node->getY() + node->getlebar()) return;
+    if (node->isLeafNode()) {
+        int startX = std::min(node->getX(), (int)row.size());
+        int endX = std::min(node->getX() + node->getpanjang(), (int)row.size());
+        std::fill(row.begin() + startX, row.begin() + endX, node->getAvgColor());
+        return;
+    }
+    paintNodeRow(node->getTopLeft(), y, row);
+    paintNodeRow(node->getTopRight(), y, row);
+    paintNodeRow(node->getBottomLeft(), y, row);
+    paintNodeRow(node->getBottomRight(), y, row);
+}
+
+// Piramida statistik buildMulti: momen blok >= kMultiMomentsMinPixels dan
+// histogram blok >= kMultiHistogramMinPixels. Blok lebih kecil dibaca langsung;
+// MAD dan entropy blok tanpa histogram membaca ulang pikselnya (masih di cache),
+// lebih murah daripada mengosongkan dan menelusuri histogram 3 x 256 bin
+const int kMultiMomentsMinPixels = 64;
+const int kMultiHistogramMinPixels = 1024;
+
+// metode di luar 1-6 diperlakukan seperti default withMetric (variance)
+int multiMethod(int errorMethod) {
+    return errorMethod >= 1 && errorMethod <= 6 ? errorMethod : 1;
+}
+
+// error satu metode dari statistik buildMulti; histogram nullptr untuk blok kecil
+double multiError(int method, const ImageBlock& block, const BlockMoments& moments, const BlockHistogram* histogram,
+                  const Color& avgColor) {
+    switch (method) {
+        case 2: return histogram ? MADMetric::hitungError(*histogram, avgColor) : MADMetric::hitungError(block, avgColor);
+        case 3: return MaxDifferenceMetric::hitungError(moments, avgColor);
+        case 4:
+            return histogram ? EntropyMetric::hitungError(*histogram, avgColor) : EntropyMetric::hitungError(block, avgColor);
+        case 5: return SSIMMetric::hitungError(moments, avgColor);
+        case 6: return BlockSSIMMetric::hitungError(moments, avgColor);
+        default: return VarianceMetric::hitungError(moments, avgColor);
+    }
+}
+
+int resolveThreads(int threads) {
+    return threads <= 0 ? ThreadPool::global().size() : threads;
+}
+
+}
+
+// Simpul piramida statistik buildMulti dengan geometri QuadTreeNode::split.
+// Blok yang semua anaknya masuk piramida dijumlah dari anak, selain itu dibaca
+// langsung, jadi seluruh piramida kira-kira satu pass gambar.
+struct QtMultiStats {
+    BlockMoments moments;
+    int histogram = -1;                 // indeks di QtMultiBuild::histograms, -1 = tidak ada
+    int children[4] = {-1, -1, -1, -1}; // indeks di QtMultiBuild::stats, -1 = anak terlalu kecil
+};
+
+// state bersama satu buildMulti
+struct QtMultiBuild {
+    const std::vector<std::vector<Color>>& image;
+    const std::vector<QuadTreeConfig>& configs;
+    const std::vector<QuadTree*>& trees;
+    bool withHistogram = false;         // ada config MAD/entropy
+    std::vector<QtMultiStats> stats;
+    std::vector<BlockHistogram> histograms;
+    // daftar simpul anak per kedalaman: anak ke-c simpul kedalaman d di
+    // childLists[4 * d + c], dipakai ulang supaya tidak alokasi per simpul
+    // (deque: referensi daftar level atas tetap valid saat level baru ditambah)
+    std::deque<std::vector<std::pair<int, QuadTreeNode*>>> childLists;
+
+    QtMultiBuild(const std::vector<std::vector<Color>>& image, const std::vector<QuadTreeConfig>& configs,
+                 const std::vector<QuadTree*>& trees)
+        : image(image), configs(configs), trees(trees) {}
+};
+
+namespace {
+
+// indeks statistik blok di build.stats, -1 jika blok terlalu kecil
+int buildMultiStats(QtMultiBuild& build, int x, int y, int panjang, int lebar) {
+    long long count = (long long)panjang * lebar;
+    if (count < kMultiMomentsMinPixels) return -1;
+
+    int halfPanjang = panjang / 2;
+    int halfLebar = lebar / 2;
+    int children[4] = {
+        buildMultiStats(build, x, y, halfPanjang, halfLebar),
+        buildMultiStats(build, x + halfPanjang, y, panjang - halfPanjang, halfLebar),
+        buildMultiStats(build, x, y + halfLebar, halfPanjang, lebar - halfLebar),
+        buildMultiStats(build, x + halfPanjang, y + halfLebar, panjang - halfPanjang, lebar - halfLebar),
+    };
+    bool merged = children[0] >= 0 && children[1] >= 0 && children[2] >= 0 && children[3] >= 0;
+    bool withHistogram = build.withHistogram && count >= kMultiHistogramMinPixels;
+    bool mergedHistogram = merged && withHistogram;
+    for (int c = 0; c < 4 && mergedHistogram; ++c) mergedHistogram = build.stats[children[c]].histogram >= 0;
+
+    ImageBlock block{build.image, x, y, panjang, lebar};
+    int index = (int)build.stats.size();
+    build.stats.emplace_back();
+    QtMultiStats& stats = build.stats.back();
+    std::copy(children, children + 4, stats.children);
+    if (withHistogram) {
+        stats.histogram = (int)build.histograms.size();
+        build.histograms.emplace_back();
+        BlockHistogram& histogram = build.histograms.back();
+        if (mergedHistogram) {
+            histogram.clear();
+            for (int child : children) histogram.merge(build.histograms[build.stats[child].histogram]);
+        } else {
+            histogram.build(block);
+        }
+    }
+    if (merged) {
+        for (int child : children) stats.moments.merge(build.stats[child].moments);
+    } else if (withHistogram) {
+        stats.moments = build.histograms[stats.histogram].moments();
+    } else {
+        stats.moments.build(block);
+    }
+    return index;
+}
+
+}
 
 QuadTreeNode::QuadTreeNode(int x, int y, int panjang, int lebar)
     : x(x), y(y), panjang(panjang), lebar(lebar), isLeaf(true),
       topLeft(nullptr), topRight(nullptr), bottomLeft(nullptr), bottomRight(nullptr) {}
 
-QuadTreeNode::~QuadTreeNode() {
-    if (topLeft) delete topLeft;
-    if (topRight) delete topRight;
-    if (bottomLeft) delete bottomLeft;
-    if (bottomRight) delete bottomRight;
-}
-
-void QuadTreeNode::split() {
+void QuadTreeNode::split(QuadTreeNodePool& nodes) {
     int halfPanjang = panjang / 2;
     int halfLebar = lebar / 2;
     
-    topLeft = new QuadTreeNode(x, y, halfPanjang, halfLebar);
-    topRight = new QuadTreeNode(x + halfPanjang, y, panjang - halfPanjang, halfLebar);
-    bottomLeft = new QuadTreeNode(x, y + halfLebar, halfPanjang, lebar - halfLebar);
-    bottomRight = new QuadTreeNode(x + halfPanjang, y + halfLebar, panjang - halfPanjang, lebar - halfLebar);
+    topLeft = nodes.create(x, y, halfPanjang, halfLebar);
+    topRight = nodes.create(x + halfPanjang, y, panjang - halfPanjang, halfLebar);
+    bottomLeft = nodes.create(x, y + halfLebar, halfPanjang, lebar - halfLebar);
+    bottomRight = nodes.create(x + halfPanjang, y + halfLebar, panjang - halfPanjang, lebar - halfLebar);
     
     isLeaf = false;
 }
@@ -30,90 +151,310 @@ bool QuadTreeNode::hasChildren() const {
     return !isLeaf && topLeft != nullptr;
 }
 
-QuadTree::QuadTree() : root(nullptr), totalN(0), maxDepth(0) {}
+QuadTreeNode* QuadTreeNodePool::create(int x, int y, int panjang, int lebar) {
+    if (current == blocks.size()) {
+        blocks.emplace_back();
+        blocks.back().reserve(kBlockNodes);
+    }
+    std::vector<QuadTreeNode>& block = blocks[current];
+    block.emplace_back(x, y, panjang, lebar);
+    if (block.size() == kBlockNodes) current++;
+    return &block.back();
+}
+
+void QuadTreeNodePool::reset() {
+    // blok setelah current sudah kosong; QuadTreeNode tanpa dtor, clear O(1)
+    for (size_t i = 0; i <= current && i < blocks.size(); i++) blocks[i].clear();
+    current = 0;
+}
+
+void LeafRowIndex::build(const std::vector<QuadTreeLeaf>& source, int width, int height) {
+    this->width = width;
+    this->height = height;
+
+    // counting sort stabil menurut y; daun dengan y sama sudah urut x pada
+    // traversal collectLeaves (kiri selalu dikunjungi sebelum kanan)
+    std::vector<size_t> start(height + 1, 0);
+    for (const QuadTreeLeaf& leaf : source) {
+        if (leaf.y < height) start[leaf.y + 1]++;
+    }
+    for (int y = 0; y < height; y++) start[y + 1] += start[y];
+
+    leaves.resize(start[height]);
+    std::vector<size_t> next(start.begin(), start.end() - 1);
+    for (const QuadTreeLeaf& leaf : source) {
+        if (leaf.y < height) leaves[next[leaf.y]++] = leaf;
+    }
+
+    bandRows.clear();
+    bandLeaves.clear();
+    for (int y = 0; y < height; y++) {
+        if (start[y + 1] > start[y]) {
+            bandRows.push_back(y);
+            bandLeaves.push_back(start[y]);
+        }
+    }
+    bandRows.push_back(height);
+    bandLeaves.push_back(leaves.size());
+}
+
+void LeafRowIndex::clear() {
+    width = 0;
+    height = 0;
+    leaves.clear();
+    bandRows.clear();
+    bandLeaves.clear();
+}
+
+size_t LeafRowIndex::bandOfRow(int y) const {
+    auto it = std::upper_bound(bandRows.begin(), bandRows.end() - 1, y);
+    return it == bandRows.begin() ? 0 : (it - bandRows.begin()) - 1;
+}
+
+QuadTree::QuadTree() : root(nullptr), totalN(0), maxDepth(0), realWidth(0), realHeight(0), leafErrorSum(0.0),
+                       sharedIntegral(nullptr), ownIntegral(nullptr), integral(nullptr) {}
 
 QuadTree::~QuadTree() {
-    if (root) delete root;
+    delete ownIntegral;
 }
 
-void QuadTree::buildfrImage(const std::vector<std::vector<Color>>& image, int errorMethod, double errorThreshold, int minBlockSize) {
-    if (image.empty() || image[0].empty()) return;
+void QuadTree::clear() {
+    nodes.reset();
+    root = nullptr;
+    totalN = 0;
+    maxDepth = 0;
+    realWidth = 0;
+    realHeight = 0;
+    leafErrorSum = 0.0;
+    scanStats = QuadTreeScanStats();
+    rowIndex.clear();
+}
+
+bool QuadTree::beginBuild(const std::vector<std::vector<Color>>& image) {
+    clear();
+    if (image.empty() || image[0].empty()) return false;
     int panjang = image[0].size();
     int lebar = image.size();
     
     realWidth = panjang;
     realHeight = lebar;
 
-    root = new QuadTreeNode(0, 0, panjang, lebar);
+    root = nodes.create(0, 0, panjang, lebar);
     totalN = 1;
-    // this->maxDepth = 0;
-    
-    buildNode(root, image, errorMethod, errorThreshold, minBlockSize, 0);
+    return true;
 }
 
-void QuadTree::buildNode(QuadTreeNode* node, const std::vector<std::vector<Color>>& image, int errorMethod, double errorThreshold, int minBlockSize, int currentDepth) {
-    if (!node) return;
-        
-    this->maxDepth = std::max(this->maxDepth, currentDepth);
-        
-    int nodeX = node->getX();
-    int nodeY = node->getY();
-    int nodePanjang = node->getpanjang();
-    int nodeLebar = node->getlebar();
-        
-    std::vector<Color> blockPixels;
-    for (int y = nodeY; y < nodeY + nodeLebar; ++y) {
-        for (int x = nodeX; x < nodeX + nodePanjang; ++x) {
-            if (y < image.size() && x < image[0].size())
-                blockPixels.push_back(image[y][x]);
+void QuadTree::buildfrImage(const std::vector<std::vector<Color>>& image, int errorMethod, double errorThreshold, int minBlockSize,
+                            const QuadTreeSampling& sampling) {
+    withMetric(errorMethod, [&](auto metric) {
+        buildWith<decltype(metric)>(image, errorThreshold, minBlockSize, sampling);
+    });
+}
+
+void QuadTree::buildMulti(const std::vector<std::vector<Color>>& image, const std::vector<QuadTreeConfig>& configs,
+                          const std::vector<QuadTree*>& trees) {
+    size_t count = std::min(configs.size(), trees.size());
+    std::vector<std::pair<int, QuadTreeNode*>> active;
+    for (size_t i = 0; i < count; ++i) {
+        if (trees[i]->beginBuild(image)) active.push_back({(int)i, trees[i]->root});
+    }
+    if (!active.empty()) {
+        QtMultiBuild build(image, configs, trees);
+        for (size_t i = 0; i < count; ++i) {
+            int method = multiMethod(configs[i].errorMethod);
+            build.withHistogram = build.withHistogram || method == 2 || method == 4;
         }
+        long long pixels = (long long)image.size() * image[0].size();
+        build.stats.reserve(pixels / kMultiMomentsMinPixels / 2 + 1);
+        if (build.withHistogram) build.histograms.reserve(pixels / kMultiHistogramMinPixels / 2 + 1);
+        int root = buildMultiStats(build, 0, 0, (int)image[0].size(), (int)image.size());
+        buildMultiNode(build, active, root, 0);
     }
-        
-    Color avgColor = hitungAverageColor(blockPixels);
-    node->setAvgColor(avgColor);
-
-    double error = 0.0;
-    switch (errorMethod) {
-        case 1: error = hitungVariance(blockPixels, avgColor); break;
-        case 2: error = hitungMAD(blockPixels, avgColor); break;
-        case 3: error = hitungMaxDifference(blockPixels); break;
-        case 4: error = hitungEntropy(blockPixels); break;
-        case 5: error = hitungSSIM(blockPixels, avgColor); break;
-        default: error = hitungVariance(blockPixels, avgColor); break;
-    }
-    node->setError(error);
-    
-    // Ini pengecekan minBlockSize-nya
-    if (nodePanjang <= minBlockSize || nodeLebar <= minBlockSize) {
-        node->setLeaf(true);
-        return;
+    for (size_t i = 0; i < count; ++i) trees[i]->buildRowIndex();
+}
+
+void QuadTree::buildMultiNode(QtMultiBuild& build, const std::vector<std::pair<int, QuadTreeNode*>>& active,
+                              int stats, int depth) {
+    ImageBlock block = qtNodeBlock(active[0].second, build.image);
+    int count = block.count();
+    unsigned methods = 0;
+    for (const auto& entry : active) methods |= 1u << multiMethod(build.configs[entry.first].errorMethod);
+
+    // error semua metrik yang dipakai tree aktif, dari satu bacaan blok
+    BlockMoments moments;
+    const BlockHistogram* histogram = nullptr;
+    if (stats >= 0) {
+        const QtMultiStats& blockStats = build.stats[stats];
+        moments = blockStats.moments;
+        if (blockStats.histogram >= 0) histogram = &build.histograms[blockStats.histogram];
+    } else {
+        moments.build(block);
     }
-    
-    if ((errorMethod == 5 && error >= errorThreshold) ||
-        (errorMethod != 5 && error <= errorThreshold)) {
+    Color avgColor = moments.average();
+    double errors[7] = {0.0};
+    for (int method = 1; method <= 6; ++method) {
+        if (methods & (1u << method)) errors[method] = multiError(method, block, moments, histogram, avgColor);
+    }
+
+    if (build.childLists.size() < (size_t)(4 * depth + 4)) build.childLists.resize(4 * depth + 4);
+    std::vector<std::pair<int, QuadTreeNode*>>* children[4];
+    for (int c = 0; c < 4; ++c) {
+        children[c] = &build.childLists[4 * depth + c];
+        children[c]->clear();
+    }
+    for (const auto& entry : active) {
+        const QuadTreeConfig& config = build.configs[entry.first];
+        QuadTree* tree = build.trees[entry.first];
+        QuadTreeNode* node = entry.second;
+        int method = multiMethod(config.errorMethod);
+
+        tree->maxDepth = std::max(tree->maxDepth, depth);
+        tree->scanStats.scannedPixels += count;
+        node->setAvgColor(avgColor);
+        node->setError(errors[method]);
+        bool needsSplit = withMetric(method, [&](auto metric) {
+            return qtNeedsSplit<decltype(metric)>(node, config.threshold, config.minBlockSize);
+        });
+        if (!needsSplit) {
+            node->setLeaf(true);
+            tree->leafErrorSum += node->getError() * node->getpanjang() * node->getlebar();
+            continue;
+        }
+        node->split(tree->nodes);
+        tree->totalN += 4;
+        children[0]->push_back({entry.first, node->getTopLeft()});
+        children[1]->push_back({entry.first, node->getTopRight()});
+        children[2]->push_back({entry.first, node->getBottomLeft()});
+        children[3]->push_back({entry.first, node->getBottomRight()});
+    }
+    // urutan anak sama dengan buildNodeWith, jadi daun tiap tree (dan
+    // leafErrorSum) dijumlah dengan urutan yang sama
+    for (int c = 0; c < 4; ++c) {
+        if (children[c]->empty()) continue;
+        buildMultiNode(build, *children[c], stats >= 0 ? build.stats[stats].children[c] : -1, depth + 1);
+    }
+}
+
+void QuadTree::buildfrTree(const QuadTree& source, int errorMethod, double threshold, int minBlockSize) {
+    clear();
+    if (!source.root) return;
+    realWidth = source.realWidth;
+    realHeight = source.realHeight;
+    const QuadTreeNode* sourceRoot = source.root;
+    root = nodes.create(sourceRoot->getX(), sourceRoot->getY(), sourceRoot->getpanjang(), sourceRoot->getlebar());
+    totalN = 1;
+    withMetric(errorMethod, [&](auto metric) {
+        copyCutWith<decltype(metric)>(sourceRoot, root, threshold, minBlockSize, 0);
+    });
+    buildRowIndex();
+}
+
+template <typename Metric>
+void QuadTree::copyCutWith(const QuadTreeNode* source, QuadTreeNode* node, double threshold, int minBlockSize,
+                           int depth) {
+    maxDepth = std::max(maxDepth, depth);
+    node->setAvgColor(source->getAvgColor());
+    node->setError(source->getError());
+    // daun source tidak bisa dipecah lebih jauh, meski errornya masih melewati threshold
+    if (!source->hasChildren() || !qtNeedsSplit<Metric>(node, threshold, minBlockSize)) {
         node->setLeaf(true);
+        leafErrorSum += node->getError() * node->getpanjang() * node->getlebar();
         return;
     }
-    
-    node->split();
+    node->split(nodes);
     totalN += 4;
-    
-    buildNode(node->getTopLeft(), image, errorMethod, errorThreshold, minBlockSize, currentDepth + 1);
-    buildNode(node->getTopRight(), image, errorMethod, errorThreshold, minBlockSize, currentDepth + 1);
-    buildNode(node->getBottomLeft(), image, errorMethod, errorThreshold, minBlockSize, currentDepth + 1);
-    buildNode(node->getBottomRight(), image, errorMethod, errorThreshold, minBlockSize, currentDepth + 1);
+    copyCutWith<Metric>(source->getTopLeft(), node->getTopLeft(), threshold, minBlockSize, depth + 1);
+    copyCutWith<Metric>(source->getTopRight(), node->getTopRight(), threshold, minBlockSize, depth + 1);
+    copyCutWith<Metric>(source->getBottomLeft(), node->getBottomLeft(), threshold, minBlockSize, depth + 1);
+    copyCutWith<Metric>(source->getBottomRight(), node->getBottomRight(), threshold, minBlockSize, depth + 1);
+}
+
+void QuadTree::buildRowIndex() {
+    std::vector<QuadTreeLeaf> leaves;
+    collectLeaves(leaves);
+    rowIndex.build(leaves, realWidth, realHeight);
 }
 
-std::vector<std::vector<Color>> QuadTree::reconstructImage(int panjang, int lebar) {
+void QuadTree::buildNode(QuadTreeNode* node, const std::vector<std::vector<Color>>& image, int errorMethod, double errorThreshold, int minBlockSize, int currentDepth) {
+    BlockScan sums;
+    withMetric(errorMethod, [&](auto metric) {
+        buildNodeWith<decltype(metric)>(node, image, errorThreshold, minBlockSize, currentDepth, QuadTreeSampling(), sums);
+    });
+}
+
+QtBuildStop QuadTree::buildBestFirst(const std::vector<std::vector<Color>>& image, int errorMethod, double errorThreshold,
+                                     int minBlockSize, const QuadTreeBudget& budget) {
+    return withMetric(errorMethod, [&](auto metric) {
+        return buildBestFirstWith<decltype(metric)>(image, errorThreshold, minBlockSize, budget);
+    });
+}
+
+QuadTreeQuality QuadTree::buildForQuality(const std::vector<std::vector<Color>>& image, int errorMethod,
+                                          const QuadTreeQualityTarget& target, int minBlockSize) {
+    return withMetric(errorMethod, [&](auto metric) {
+        return buildForQualityWith<decltype(metric)>(image, target, minBlockSize);
+    });
+}
+
+QtBuildStop QuadTree::build(const std::vector<std::vector<Color>>& image, int errorMethod, double errorThreshold,
+                            int minBlockSize, const QuadTreeBudget& budget, const QuadTreeSampling& sampling) {
+    if (budget.isLimited()) return buildBestFirst(image, errorMethod, errorThreshold, minBlockSize, budget);
+    buildfrImage(image, errorMethod, errorThreshold, minBlockSize, sampling);
+    return QT_STOP_CONVERGED;
+}
+
+std::vector<std::vector<Color>> QuadTree::reconstructImage(int panjang, int lebar, int threads) {
+    std::vector<std::vector<Color>> result;
+    reconstructImage(result, panjang, lebar, threads);
+    return result;
+}
+
+void QuadTree::reconstructImage(std::vector<std::vector<Color>>& result, int panjang, int lebar, int threads) {
     //buat gambar sesuai p l
-    std::vector<std::vector<Color>> result(lebar, std::vector<Color>(panjang));
-    
-    //node: root, maka isi warna hasil
-    if (root) {
-        fillImage(result, root);
+    result.resize(lebar);
+
+    // pita baris saling lepas, sekitar 4 per thread (minimal 64 baris) supaya
+    // beban rata; tiap pita mulai dari baris pertamanya sendiri, tanpa lock
+    int parallel = resolveThreads(threads);
+    int chunkRows = std::max(64, (lebar + parallel * 4 - 1) / (parallel * 4));
+    int chunks = (lebar + chunkRows - 1) / chunkRows;
+    if (parallel <= 1 || chunks <= 1) {
+        renderRows(result, panjang, 0, lebar);
+        return;
     }
-    
-    return result;
+    ThreadPool::global().parallelFor(chunks, [&](size_t i) {
+        int y0 = (int)i * chunkRows;
+        renderRows(result, panjang, y0, std::min(lebar, y0 + chunkRows));
+    }, parallel);
+}
+
+void QuadTree::renderRows(std::vector<std::vector<Color>>& result, int panjang, int y0, int y1) const {
+    // per pita: timpa baris dengan daun yang dimulai di pita itu (kiri ke
+    // kanan), lalu salin baris yang sama ke seluruh pita
+    std::vector<Color> row(panjang, Color());
+    const std::vector<QuadTreeLeaf>& leaves = rowIndex.getLeaves();
+    int treeRows = std::min(y1, realHeight);
+    int y = y0;
+    if (root && y < treeRows) {
+        // keadaan awal: semua daun yang menutupi baris y0
+        paintNodeRow(root, y, row);
+        size_t band = rowIndex.bandOfRow(y);
+        while (true) {
+            int endY = std::min(rowIndex.bandEnd(band), treeRows);
+            for (; y < endY; y++) result[y].assign(row.begin(), row.end());
+            if (y >= treeRows) break;
+            band++;
+            for (size_t i = rowIndex.bandFirstLeaf(band); i < rowIndex.bandEndLeaf(band); i++) {
+                const QuadTreeLeaf& leaf = leaves[i];
+                int endX = std::min(leaf.x + leaf.panjang, panjang);
+                if (leaf.x < endX) std::fill(row.begin() + leaf.x, row.begin() + endX, leaf.color);
+            }
+        }
+    }
+
+    // baris di luar tree tetap hitam
+    std::fill(row.begin(), row.end(), Color());
+    for (; y < y1; y++) result[y].assign(row.begin(), row.end());
 }
 
 void QuadTree::fillImage(std::vector<std::vector<Color>>& image, QuadTreeNode* node) {
@@ -140,23 +481,70 @@ void QuadTree::fillImage(std::vector<std::vector<Color>>& image, QuadTreeNode* n
     }
 }
 
+void QuadTree::collectLeaves(std::vector<QuadTreeLeaf>& leaves) const {
+    leaves.clear();
+    if (!root) return;
+
+    std::vector<const QuadTreeNode*> stack;
+    stack.push_back(root);
+    while (!stack.empty()) {
+        const QuadTreeNode* node = stack.back();
+        stack.pop_back();
+        if (node->isLeafNode()) {
+            leaves.push_back({node->getX(), node->getY(), node->getpanjang(), node->getlebar(), node->getAvgColor()});
+        } else {
+            stack.push_back(node->getBottomRight());
+            stack.push_back(node->getBottomLeft());
+            stack.push_back(node->getTopRight());
+            stack.push_back(node->getTopLeft());
+        }
+    }
+}
+
 int QuadTree::hitungCompressedSize() {
     // Compressed Size: total node dikali dengan size per node
-    // size per node: posisi (2 int) + ukuran (2 int) + warna (3 byte) + flag (1 byte)
-    int sizePerNode = (2 * sizeof(int)) + (2 * sizeof(int)) + (3 * sizeof(char)) + sizeof(bool);
-    return totalN * sizePerNode;
+    return totalN * (int)bytesPerNode;
 }
 
-std::vector<std::vector<Color>> QuadTree::reconstructImageForGIF(int depth) {
+double QuadTree::hitungResidualError() const {
+    double area = (double)realWidth * realHeight;
+    return area > 0 ? leafErrorSum / area : 0.0;
+}
+
+std::vector<std::vector<Color>> QuadTree::reconstructImageForGIF(int depth, int threads) {
     std::vector<std::vector<Color>> result(realHeight, std::vector<Color>(realWidth));
-    Color bgColor = root->getAvgColor();
-    for (int y = 0; y < realHeight; y++) {
-        for (int x = 0; x < realWidth; x++) {
-            result[y][x] = bgColor;
+    if (!root) return result;
+
+    // pecah tree melebar sampai ada cukup subtree untuk semua thread; subtree
+    // menutupi area yang saling lepas dan bersama-sama menutupi seluruh gambar
+    int parallel = resolveThreads(threads);
+    std::vector<std::pair<QuadTreeNode*, int>> tasks{{root, 0}};
+    while (parallel > 1 && tasks.size() < (size_t)parallel * 16) {
+        std::vector<std::pair<QuadTreeNode*, int>> next;
+        bool split = false;
+        for (const auto& task : tasks) {
+            QuadTreeNode* node = task.first;
+            if (node->isLeafNode() || task.second >= depth) {
+                next.push_back(task);
+                continue;
+            }
+            next.push_back({node->getTopLeft(), task.second + 1});
+            next.push_back({node->getTopRight(), task.second + 1});
+            next.push_back({node->getBottomLeft(), task.second + 1});
+            next.push_back({node->getBottomRight(), task.second + 1});
+            split = true;
         }
+        if (!split) break;
+        tasks.swap(next);
+    }
+
+    if (tasks.size() == 1) {
+        fillImageLimited(result, root, depth, 0);
+    } else {
+        ThreadPool::global().parallelFor(tasks.size(), [&](size_t i) {
+            fillImageLimited(result, tasks[i].first, depth, tasks[i].second);
+        }, parallel);
     }
-    fillImageLimited(result, root, depth, 0);
-    
     return result;
 }
 
@@ -168,10 +556,9 @@ void QuadTree::fillImageLimited(std::vector<std::vector<Color>>& image, QuadTree
         int endX = std::min(startX + node->getpanjang(), (int)image[0].size());
         int endY = std::min(startY + node->getlebar(), (int)image.size());
         
+        if (startX >= endX) return;
         for (int y = startY; y < endY; y++) {
-            for (int x = startX; x < endX; x++) {
-                image[y][x] = node->getAvgColor();
-            }
+            std::fill(image[y].begin() + startX, image[y].begin() + endX, node->getAvgColor());
         }
     } else {
         fillImageLimited(image, node->getTopLeft(), maxDepth, currentDepth + 1);
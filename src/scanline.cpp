@@ -0,0 +1,41 @@
+#include "header/scanline.h"
+#include <algorithm>
+#include <cstring>
+
+ScanlineRenderer::ScanlineRenderer(const LeafRowIndex& index, int startRow)
+    : index(index), y(startRow) {
+    size_t stride = (size_t)index.getWidth() * 3;
+    row.assign(stride, 0);
+    previous.assign(stride, 0);
+    if (index.getBandCount() == 0) return;
+
+    // keadaan baris startRow - 1: daun pita sebelumnya yang masih menutupinya
+    const std::vector<QuadTreeLeaf>& leaves = index.getLeaves();
+    nextBand = startRow > 0 ? index.bandOfRow(startRow - 1) + 1 : 0;
+    for (size_t i = 0; i < index.bandFirstLeaf(nextBand); i++) {
+        if (leaves[i].y + leaves[i].lebar >= startRow) paint(leaves[i]);
+    }
+}
+
+void ScanlineRenderer::paint(const QuadTreeLeaf& leaf) {
+    int x1 = std::min(leaf.x + leaf.panjang, index.getWidth());
+    unsigned char* p = row.data() + (size_t)leaf.x * 3;
+    for (int x = leaf.x; x < x1; x++, p += 3) {
+        p[0] = leaf.color.r;
+        p[1] = leaf.color.g;
+        p[2] = leaf.color.b;
+    }
+}
+
+const unsigned char* ScanlineRenderer::nextRow() {
+    bool startsBand = nextBand < index.getBandCount() && index.bandStart(nextBand) == y;
+    changed = y == 0 || startsBand;
+    if (startsBand) {
+        if (y > 0) std::memcpy(previous.data(), row.data(), row.size());
+        const std::vector<QuadTreeLeaf>& leaves = index.getLeaves();
+        for (size_t i = index.bandFirstLeaf(nextBand); i < index.bandEndLeaf(nextBand); i++) paint(leaves[i]);
+        nextBand++;
+    }
+    y++;
+    return row.data();
+}
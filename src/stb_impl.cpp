@@ -0,0 +1,46 @@
+// Implementasi single-header library (stb_image, stb_image_write, gif.h)
+// dikompilasi sekali di sini, supaya op.cpp tidak ikut mengkompilasi ulang.
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+// Backend deflate untuk stbi_write_png dipilih saat kompilasi (QUADTREE_DEFLATE
+// di CMake): builtin = DeflateEncoder (deflate.cpp), zlib = zlib sistem,
+// tanpa keduanya = stbi_zlib_compress bawaan stb.
+#if defined(QUADTREE_DEFLATE_BUILTIN)
+#include "header/deflate.h"
+
+static unsigned char* quadtreeZlibCompress(unsigned char* data, int dataLen, int* outLen, int quality) {
+    std::vector<unsigned char> out;
+    deflateCompress(data, dataLen, quality, out, 0);
+    unsigned char* result = (unsigned char*)std::malloc(out.size());
+    if (!result) return nullptr;
+    std::memcpy(result, out.data(), out.size());
+    *outLen = (int)out.size();
+    return result;
+}
+#define STBIW_ZLIB_COMPRESS quadtreeZlibCompress
+
+#elif defined(QUADTREE_DEFLATE_ZLIB)
+#include <zlib.h>
+
+static unsigned char* quadtreeZlibCompress(unsigned char* data, int dataLen, int* outLen, int quality) {
+    uLongf size = compressBound(dataLen);
+    unsigned char* result = (unsigned char*)std::malloc(size);
+    if (!result) return nullptr;
+    if (compress2(result, &size, data, dataLen, quality > 9 ? 9 : quality) != Z_OK) {
+        std::free(result);
+        return nullptr;
+    }
+    *outLen = (int)size;
+    return result;
+}
+#define STBIW_ZLIB_COMPRESS quadtreeZlibCompress
+#endif
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "header/stb_image.h"
+#define STB_IMAGE_WRITE_IMPLEMENTATION
+#include "header/stb_image_write.h"
+#define GIF_IMPL
+#include "header/gif.h"
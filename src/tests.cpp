@@ -0,0 +1,1084 @@
+#include "header/quadtree.h"
+#include "header/op.h"
+#include "header/deflate.h"
+#include "header/pngwriter.h"
+#include "header/jpegwriter.h"
+#include "header/imagewriter.h"
+#include "header/encoder.h"
+#include "header/gifwriter.h"
+#include "header/pipeline.h"
+#include "header/stb_image.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cmath>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+// Test regresi untuk ctest: tiap kasus satu fungsi, dipilih lewat argumen.
+// Gambar dibaca dari direktori test/ repo.
+//
+//   quadtree_tests <kasus> <direktori test/>
+
+namespace {
+
+std::string testDir;
+int failures = 0;
+
+#define CHECK(cond)                                                                   \
+    do {                                                                              \
+        if (!(cond)) {                                                                \
+            std::fprintf(stderr, "%s:%d: gagal: %s\n", __FILE__, __LINE__, #cond);   \
+            failures++;                                                               \
+        }                                                                             \
+    } while (0)
+
+bool loadImage(const char* name, std::vector<std::vector<Color>>& image) {
+    int width, height;
+    std::string path = testDir + "/" + name;
+    if (!readImage(path, image, width, height)) {
+        std::fprintf(stderr, "tidak bisa membaca %s: %s\n", path.c_str(), imageLoadFailureReason());
+        failures++;
+        return false;
+    }
+    return true;
+}
+
+// FNV-1a atas posisi, ukuran, dan warna semua daun
+uint64_t hashLeaves(const QuadTree& tree) {
+    uint64_t hash = 1469598103934665603ull;
+    auto mix = [&](long long value) {
+        for (int i = 0; i < 8; i++) {
+            hash ^= (unsigned char)(value >> (i * 8));
+            hash *= 1099511628211ull;
+        }
+    };
+    for (const QuadTreeLeaf& leaf : tree.getRowIndex().getLeaves()) {
+        mix(leaf.x);
+        mix(leaf.y);
+        mix(leaf.panjang);
+        mix(leaf.lebar);
+        mix(leaf.color.r | (leaf.color.g << 8) | (leaf.color.b << 16));
+    }
+    return hash;
+}
+
+// daun harus menutup seluruh gambar tepat sekali
+bool leavesCoverImage(const QuadTree& tree) {
+    std::vector<unsigned char> covered((size_t)tree.getWidth() * tree.getHeight(), 0);
+    for (const QuadTreeLeaf& leaf : tree.getRowIndex().getLeaves()) {
+        for (int y = leaf.y; y < leaf.y + leaf.lebar; y++) {
+            for (int x = leaf.x; x < leaf.x + leaf.panjang; x++) {
+                if (x < 0 || y < 0 || x >= tree.getWidth() || y >= tree.getHeight()) return false;
+                if (covered[(size_t)y * tree.getWidth() + x]++) return false;
+            }
+        }
+    }
+    for (unsigned char c : covered) {
+        if (!c) return false;
+    }
+    return true;
+}
+
+bool sameImage(const std::vector<std::vector<Color>>& a, const std::vector<std::vector<Color>>& b) {
+    if (a.size() != b.size()) return false;
+    for (size_t y = 0; y < a.size(); y++) {
+        if (a[y].size() != b[y].size()) return false;
+        for (size_t x = 0; x < a[y].size(); x++) {
+            if (a[y][x].r != b[y][x].r || a[y][x].g != b[y][x].g || a[y][x].b != b[y][x].b) return false;
+        }
+    }
+    return true;
+}
+
+// hasil encode harus bisa dibaca stb_image dan sama persis dengan reconstructImage
+bool decodesTo(const std::vector<unsigned char>& encoded, const std::vector<std::vector<Color>>& expected) {
+    std::vector<std::vector<Color>> decoded;
+    int width, height;
+    if (!readImageFromMemory(encoded.data(), encoded.size(), decoded, width, height)) return false;
+    return sameImage(decoded, expected);
+}
+
+// metode/threshold/minBlock yang dipakai kasus-kasus di bawah
+struct BuildCase {
+    int method;
+    double threshold;
+    int minBlock;
+};
+
+const BuildCase kBuildCases[] = {
+    {1, 100.0, 2},
+    {2, 8.0, 2},
+    {3, 30.0, 2},
+    {4, 3.0, 2},
+    {5, 0.8, 2},
+    {6, 0.8, 2},
+};
+
+// banyak simpul dan hash daun buildfrImage untuk kBuildCases pada snoopy.png;
+// berubah = tree hasil kompresi berubah
+struct BuildExpectation {
+    int nodes;
+    int leaves;
+    uint64_t hash;
+};
+
+const BuildExpectation kBuildExpected[] = {
+    {8721, 6541, 0x8ec574b21662946bull},
+    {7893, 5920, 0x64d0e2a557c2bd7eull},
+    {8901, 6676, 0xf38a5d98203d6988ull},
+    {4865, 3649, 0x28c659b45da29c13ull},
+    {11237, 8428, 0x574f06783ebdb91full},
+    {11105, 8329, 0x3057a70dd2a9d9f1ull},
+};
+
+void testBuildfrImage() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    for (size_t i = 0; i < sizeof(kBuildCases) / sizeof(kBuildCases[0]); i++) {
+        const BuildCase& c = kBuildCases[i];
+        QuadTree tree;
+        tree.buildfrImage(image, c.method, c.threshold, c.minBlock);
+        uint64_t hash = hashLeaves(tree);
+        std::printf("metode %d threshold %g: %d simpul, %d daun, hash %016llx\n", c.method, c.threshold,
+                    tree.getTotalNodes(), tree.getLeafCount(), (unsigned long long)hash);
+        CHECK(tree.getTotalNodes() == kBuildExpected[i].nodes);
+        CHECK(tree.getLeafCount() == kBuildExpected[i].leaves);
+        CHECK(hash == kBuildExpected[i].hash);
+        CHECK(leavesCoverImage(tree));
+
+        // objek yang dipakai ulang harus menghasilkan tree yang sama
+        tree.buildfrImage(image, c.method, c.threshold, c.minBlock);
+        CHECK(hashLeaves(tree) == hash);
+    }
+}
+
+void testPngOutput() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    for (const BuildCase& c : kBuildCases) {
+        QuadTree tree;
+        tree.buildfrImage(image, c.method, c.threshold, c.minBlock);
+        std::vector<std::vector<Color>> expected = tree.reconstructImage(tree.getWidth(), tree.getHeight());
+
+        std::vector<unsigned char> png;
+        CHECK(encodeQuadtreePNG(tree, png));
+        CHECK(decodesTo(png, expected));
+    }
+}
+
+std::vector<unsigned char> readFileBytes(const std::string& path) {
+    std::ifstream file(path, std::ios::binary);
+    return std::vector<unsigned char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+void testBmpTgaOutput() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    // lebar 391: baris bmp butuh padding, tinggi ganjil
+    std::vector<std::vector<Color>> cropped(image.begin(), image.end() - 2);
+    for (std::vector<Color>& row : cropped) row.pop_back();
+
+    std::vector<BuildCase> cases(std::begin(kBuildCases), std::end(kBuildCases));
+    cases.push_back({1, 0.0, 1});   // daun 1x1: tga sebagian besar paket mentah
+
+    for (const std::vector<std::vector<Color>>* source : {&image, &cropped}) {
+        for (const BuildCase& c : cases) {
+            QuadTree tree;
+            tree.buildfrImage(*source, c.method, c.threshold, c.minBlock);
+            std::vector<std::vector<Color>> expected = tree.reconstructImage(tree.getWidth(), tree.getHeight());
+
+            for (const char* extension : {"bmp", "tga"}) {
+                std::vector<unsigned char> encoded;
+                CHECK(encodeQuadtreeImage(extension, tree, encoded));
+                std::printf("%s %dx%d metode %d: %zu byte\n", extension, tree.getWidth(), tree.getHeight(),
+                            c.method, encoded.size());
+                CHECK(decodesTo(encoded, expected));
+
+                // versi file dialirkan per baris, isinya harus sama
+                std::string path = std::string("quadtree_tests_output.") + extension;
+                CHECK(writeQuadtreeImage(path, tree));
+                CHECK(readFileBytes(path) == encoded);
+                std::remove(path.c_str());
+            }
+        }
+    }
+}
+
+void testPngLevels() {
+    // cukup besar (> 2 pita 256 KB) supaya threads > 1 memakai deflate paralel
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("moana.png", image)) return;
+
+    QuadTree tree;
+    tree.buildfrImage(image, 1, 100.0, 2);
+    std::vector<std::vector<Color>> expected = tree.reconstructImage(tree.getWidth(), tree.getHeight());
+
+    // header zlib IDAT: signature 8 + chunk IHDR 25 + panjang dan tipe IDAT 8
+    const size_t zlibHeader = 41;
+    for (int level = 0; level <= 9; level++) {
+        std::vector<unsigned char> serialHeader;
+        for (int threads : {1, 4}) {
+            PngWriteOptions options;
+            options.level = level;
+            options.threads = threads;
+            std::vector<unsigned char> png;
+            CHECK(encodeQuadtreePNG(tree, png, options));
+            std::printf("level %d threads %d: %zu byte\n", level, threads, png.size());
+            CHECK(decodesTo(png, expected));
+
+            // jalur serial dan pita paralel menulis header zlib yang sama
+            std::vector<unsigned char> header(png.begin() + zlibHeader, png.begin() + zlibHeader + 2);
+            if (threads == 1) serialHeader = header;
+            CHECK(header == serialHeader);
+            CHECK(header[0] == 0x78 && header[1] == zlibLevelFlag(level));
+        }
+    }
+}
+
+// data campuran: salinan dari belakang (match), byte acak, dan run nol
+std::vector<unsigned char> deflateInput(size_t size) {
+    std::vector<unsigned char> data;
+    uint32_t state = 12345;
+    auto next = [&]() {
+        state = state * 1103515245u + 12345u;
+        return state >> 16;
+    };
+    while (data.size() < size) {
+        uint32_t kind = next() % 4;
+        size_t length = 1 + next() % 300;
+        if (kind == 0 && data.size() > 1) {
+            size_t distance = 1 + next() % std::min<size_t>(data.size(), 40000);
+            for (size_t i = 0; i < length; i++) data.push_back(data[data.size() - distance]);
+        } else if (kind == 1) {
+            data.insert(data.end(), length, 0);
+        } else {
+            for (size_t i = 0; i < length; i++) data.push_back((unsigned char)next());
+        }
+    }
+    data.resize(size);
+    return data;
+}
+
+bool inflatesTo(const std::vector<unsigned char>& stream, const std::vector<unsigned char>& expected) {
+    int size = 0;
+    char* decoded = stbi_zlib_decode_malloc((const char*)stream.data(), (int)stream.size(), &size);
+    if (!decoded) return false;
+    bool same = (size_t)size == expected.size() && std::memcmp(decoded, expected.data(), expected.size()) == 0;
+    std::free(decoded);
+    return same;
+}
+
+void testDeflateRoundTrip() {
+    std::vector<unsigned char> data = deflateInput(600000);
+    uint32_t adler = adler32Update(1, data.data(), data.size());
+
+    for (int level = 0; level <= 9; level++) {
+        std::printf("level %d\n", level);
+        // satu encoder, write dan writeRun bercampur
+        std::vector<unsigned char> serial;
+        {
+            DeflateEncoder encoder(serial, level);
+            encoder.write(data.data(), data.size() / 2);
+            encoder.writeRun(0, 5000);
+            encoder.finish();
+        }
+        std::vector<unsigned char> expected(data.begin(), data.begin() + data.size() / 2);
+        expected.insert(expected.end(), 5000, 0);
+        CHECK(inflatesTo(serial, expected));
+
+        // potongan paralel (> 1 potongan 256 KB)
+        std::vector<unsigned char> parallel;
+        deflateCompress(data.data(), data.size(), level, parallel, 4);
+        CHECK(inflatesTo(parallel, data));
+
+        // dua stream mentah disambung manual: bagian kedua memakai 32 KB
+        // terakhir bagian pertama sebagai dictionary, bagian pertama berhenti di
+        // batas byte lewat flushSync, adler32 digabung
+        size_t split = 250000;
+        std::vector<unsigned char> first, second;
+        {
+            DeflateEncoder encoder(first, level, DEFLATE_RAW);
+            encoder.write(data.data(), split);
+            encoder.flushSync();
+        }
+        {
+            DeflateEncoder encoder(second, level, DEFLATE_RAW);
+            encoder.setDictionary(data.data() + split - 32768, 32768);
+            encoder.write(data.data() + split, data.size() - split);
+            encoder.finish();
+        }
+        uint32_t combined = adler32Combine(adler32Update(1, data.data(), split),
+                                           adler32Update(1, data.data() + split, data.size() - split),
+                                           data.size() - split);
+        CHECK(combined == adler);
+
+        std::vector<unsigned char> joined = {0x78, 0x01};
+        joined.insert(joined.end(), first.begin(), first.end());
+        joined.insert(joined.end(), second.begin(), second.end());
+        for (int shift = 24; shift >= 0; shift -= 8) joined.push_back((unsigned char)(combined >> shift));
+        CHECK(inflatesTo(joined, data));
+    }
+}
+
+// <= 90 memakai chroma subsampling 4:2:0, di atasnya 4:4:4
+const int kJpegQualities[] = {50, 90, 95};
+
+void testJpegSimd() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    // kernel AVX2 dan skalar harus menghasilkan byte yang sama persis, baik
+    // dari daun quadtree maupun dari piksel gambar asli (tanpa blok seragam)
+    std::vector<unsigned char> pixels;
+    imageToPixels(image, pixels);
+    int width = (int)image[0].size();
+    int height = (int)image.size();
+
+    for (int quality : kJpegQualities) {
+        JpegWriteOptions scalar;
+        scalar.quality = quality;
+        scalar.simd = false;
+        JpegWriteOptions simd = scalar;
+        simd.simd = true;
+
+        std::vector<unsigned char> a, b;
+        CHECK(encodeJPEG(pixels.data(), width, height, a, scalar));
+        CHECK(encodeJPEG(pixels.data(), width, height, b, simd));
+        std::printf("kualitas %d gambar asli: %zu byte\n", quality, a.size());
+        CHECK(a == b);
+
+        for (const BuildCase& c : kBuildCases) {
+            QuadTree tree;
+            tree.buildfrImage(image, c.method, c.threshold, c.minBlock);
+            CHECK(encodeQuadtreeJPEG(tree, a, scalar));
+            CHECK(encodeQuadtreeJPEG(tree, b, simd));
+            std::printf("kualitas %d metode %d: %zu byte\n", quality, c.method, a.size());
+            CHECK(a == b);
+
+            std::vector<std::vector<Color>> decoded;
+            int decodedWidth, decodedHeight;
+            CHECK(readImageFromMemory(a.data(), a.size(), decoded, decodedWidth, decodedHeight));
+            CHECK(decodedWidth == width && decodedHeight == height);
+        }
+    }
+}
+
+bool hasRestartInterval(const std::vector<unsigned char>& jpeg) {
+    for (size_t i = 0; i + 1 < jpeg.size(); i++) {
+        if (jpeg[i] == 0xFF && jpeg[i + 1] == 0xDD) return true;
+        if (jpeg[i] == 0xFF && jpeg[i + 1] == 0xDA) return false;   // SOS: header selesai
+    }
+    return false;
+}
+
+void testJpegRestartStrips() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("moana.png", image)) return;
+
+    QuadTree tree;
+    tree.buildfrImage(image, 5, 0.8, 2);
+
+    // pita restart interval paralel harus didecode sama persis dengan serial
+    for (int quality : kJpegQualities) {
+        JpegWriteOptions serial;
+        serial.quality = quality;
+        serial.threads = 1;
+        std::vector<unsigned char> reference;
+        CHECK(encodeQuadtreeJPEG(tree, reference, serial));
+        CHECK(!hasRestartInterval(reference));
+
+        std::vector<std::vector<Color>> expected, decoded;
+        int width, height;
+        CHECK(readImageFromMemory(reference.data(), reference.size(), expected, width, height));
+
+        for (int threads : {2, 4, 7}) {
+            JpegWriteOptions strips = serial;
+            strips.threads = threads;
+            std::vector<unsigned char> jpeg;
+            CHECK(encodeQuadtreeJPEG(tree, jpeg, strips));
+            std::printf("kualitas %d threads %d: %zu byte (serial %zu)\n", quality, threads, jpeg.size(),
+                        reference.size());
+            CHECK(hasRestartInterval(jpeg));
+            CHECK(readImageFromMemory(jpeg.data(), jpeg.size(), decoded, width, height));
+            CHECK(sameImage(decoded, expected));
+        }
+    }
+}
+
+// frame RGBA tiap kedalaman tree, sama dengan createQuadtreeGIF
+std::vector<std::vector<uint8_t>> gifFrames(QuadTree& tree) {
+    std::vector<std::vector<uint8_t>> frames;
+    for (int depth = 0; depth <= tree.getMaxDepth(); depth++) {
+        std::vector<std::vector<Color>> image = tree.reconstructImageForGIF(depth);
+        std::vector<uint8_t> rgba;
+        for (const std::vector<Color>& row : image) {
+            for (const Color& c : row) rgba.insert(rgba.end(), {c.r, c.g, c.b, 255});
+        }
+        frames.push_back(rgba);
+    }
+    return frames;
+}
+
+std::vector<unsigned char> encodeGif(GifEncoder& encoder, const std::vector<std::vector<uint8_t>>& frames,
+                                     int width, int height) {
+    CHECK(encoder.openMemory(width, height, 100));
+    for (const std::vector<uint8_t>& frame : frames) CHECK(encoder.writeFrame(frame.data(), 100));
+    CHECK(encoder.finish());
+    return std::vector<unsigned char>(encoder.data(), encoder.data() + encoder.size());
+}
+
+void testGifLzw() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+    int width = (int)image[0].size();
+    int height = (int)image.size();
+
+    // daun 1x1 di frame terakhir: kamus LZW penuh (4095 kode) berkali-kali
+    const BuildCase cases[] = {{1, 100.0, 2}, {1, 0.0, 1}};
+    GifEncoder encoder;
+    for (const BuildCase& c : cases) {
+        QuadTree tree;
+        tree.buildfrImage(image, c.method, c.threshold, c.minBlock);
+        std::vector<std::vector<uint8_t>> frames = gifFrames(tree);
+
+        // pembanding: kamus baru tiap frame (dict NULL), sekaligus frame hasil
+        // threshold palet yang harus keluar dari decoder
+        GifBuffer reference = {};
+        GifWriteHeader(&reference, width, height, 100);
+        std::vector<uint8_t> state((size_t)width * height * 4);
+        std::vector<std::vector<uint8_t>> thresholded;
+        for (size_t i = 0; i < frames.size(); i++) {
+            GifWriteFrameToBuffer(&reference, state.data(), i == 0, frames[i].data(), width, height, 100);
+            thresholded.push_back(state);
+        }
+        GifWriteTrailer(&reference);
+
+        std::vector<unsigned char> gif = encodeGif(encoder, frames, width, height);
+        std::printf("metode %d threshold %g: %zu frame, %zu byte\n", c.method, c.threshold, frames.size(),
+                    gif.size());
+        CHECK(gif.size() == reference.size && std::memcmp(gif.data(), reference.data, gif.size()) == 0);
+        GifBufferFree(&reference);
+
+        int* delays = nullptr;
+        int decodedWidth, decodedHeight, count, comp;
+        unsigned char* decoded = stbi_load_gif_from_memory(gif.data(), (int)gif.size(), &delays, &decodedWidth,
+                                                           &decodedHeight, &count, &comp, 4);
+        CHECK(decoded != nullptr);
+        if (!decoded) continue;
+        CHECK(decodedWidth == width && decodedHeight == height && count == (int)frames.size());
+        size_t frameBytes = (size_t)width * height * 4;
+        for (int i = 0; i < count && i < (int)frames.size(); i++) {
+            const unsigned char* frame = decoded + i * frameBytes;
+            bool same = true;
+            for (size_t p = 0; p < frameBytes; p += 4) {
+                same = same && frame[p] == thresholded[i][p] && frame[p + 1] == thresholded[i][p + 1] &&
+                       frame[p + 2] == thresholded[i][p + 2] && frame[p + 3] == 255;
+            }
+            CHECK(same);
+            CHECK(delays[i] == 1000);
+        }
+        stbi_image_free(decoded);
+        stbi_image_free(delays);
+
+        // kamus, buffer, dan frame sebelumnya yang dipakai ulang tidak mengubah output
+        CHECK(encodeGif(encoder, frames, width, height) == gif);
+    }
+}
+
+void testGifEncoder() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+    std::vector<std::vector<Color>> cropped(image.begin(), image.end() - 2);
+    for (std::vector<Color>& row : cropped) row.pop_back();
+
+    struct GifCase {
+        const std::vector<std::vector<Color>>* image;
+        std::string path;
+        std::vector<std::vector<uint8_t>> frames;
+        std::vector<unsigned char> expected;
+    };
+    GifCase cases[] = {{&image, "quadtree_tests_a.gif", {}, {}}, {&cropped, "quadtree_tests_b.gif", {}, {}}};
+    for (GifCase& c : cases) {
+        QuadTree tree;
+        tree.buildfrImage(*c.image, 3, 30.0, 2);
+        c.frames = gifFrames(tree);
+        GifEncoder memory;
+        c.expected = encodeGif(memory, c.frames, tree.getWidth(), tree.getHeight());
+        CHECK(!c.expected.empty() && c.expected.back() == 0x3B);
+        CHECK(!memory.isOpen());
+        // sudah ditutup: frame dan finish berikutnya ditolak
+        CHECK(!memory.writeFrame(c.frames[0].data(), 100));
+        CHECK(!memory.finish());
+    }
+
+    // satu objek: path tidak valid, lalu dua file berturut-turut tanpa finish di
+    // antaranya (open menutup GIF sebelumnya), lalu kembali ke memori
+    GifEncoder encoder;
+    CHECK(!encoder.open("quadtree_tests_tidak_ada/x.gif", 16, 16, 100));
+    for (GifCase& c : cases) {
+        int width = (int)(*c.image)[0].size();
+        int height = (int)c.image->size();
+        CHECK(encoder.open(c.path, width, height, 100));
+        for (const std::vector<uint8_t>& frame : c.frames) CHECK(encoder.writeFrame(frame.data(), 100));
+    }
+    CHECK(encoder.finish());
+    for (GifCase& c : cases) {
+        std::vector<unsigned char> written = readFileBytes(c.path);
+        std::printf("%s: %zu byte (memori %zu)\n", c.path.c_str(), written.size(), c.expected.size());
+        CHECK(written == c.expected);
+        std::remove(c.path.c_str());
+    }
+    CHECK(encodeGif(encoder, cases[0].frames, (int)image[0].size(), (int)image.size()) == cases[0].expected);
+}
+
+// SSIM per jendela langsung dari definisinya (rata-rata, varians, dan
+// kovarians berbobot dua pass), pembanding hitungImageSSIM
+ImageSSIMReport naiveImageSSIM(const std::vector<std::vector<Color>>& a, const std::vector<std::vector<Color>>& b,
+                               SSIMWindow window) {
+    int height = (int)a.size();
+    int width = (int)a[0].size();
+    std::vector<double> kernel;
+    if (window == SSIM_WINDOW_BOX || width < 11 || height < 11) {
+        int size = std::min(8, std::min(width, height));
+        kernel.assign(size, 1.0 / size);
+    } else {
+        double total = 0.0;
+        for (int t = -5; t <= 5; t++) {
+            kernel.push_back(std::exp(-(t * t) / (2 * 1.5 * 1.5)));
+            total += kernel.back();
+        }
+        for (double& weight : kernel) weight /= total;
+    }
+    int size = (int)kernel.size();
+    const double C1 = (0.01 * 255) * (0.01 * 255);
+    const double C2 = (0.03 * 255) * (0.03 * 255);
+    auto value = [](const Color& c, int channel) { return (double)(channel == 0 ? c.r : channel == 1 ? c.g : c.b); };
+
+    ImageSSIMReport report;
+    for (int y0 = 0; y0 + size <= height; y0++) {
+        for (int x0 = 0; x0 + size <= width; x0++) {
+            report.windows++;
+            for (int channel = 0; channel < 3; channel++) {
+                double meanA = 0.0, meanB = 0.0;
+                for (int j = 0; j < size; j++) {
+                    for (int i = 0; i < size; i++) {
+                        double w = kernel[i] * kernel[j];
+                        meanA += w * value(a[y0 + j][x0 + i], channel);
+                        meanB += w * value(b[y0 + j][x0 + i], channel);
+                    }
+                }
+                double varianceA = 0.0, varianceB = 0.0, covariance = 0.0;
+                for (int j = 0; j < size; j++) {
+                    for (int i = 0; i < size; i++) {
+                        double w = kernel[i] * kernel[j];
+                        double da = value(a[y0 + j][x0 + i], channel) - meanA;
+                        double db = value(b[y0 + j][x0 + i], channel) - meanB;
+                        varianceA += w * da * da;
+                        varianceB += w * db * db;
+                        covariance += w * da * db;
+                    }
+                }
+                report.channel[channel] += ((2 * meanA * meanB + C1) * (2 * covariance + C2)) /
+                                           ((meanA * meanA + meanB * meanB + C1) * (varianceA + varianceB + C2));
+            }
+        }
+    }
+    for (int channel = 0; channel < 3; channel++) report.channel[channel] /= report.windows;
+    report.ssim = (report.channel[0] + report.channel[1] + report.channel[2]) / 3.0;
+    return report;
+}
+
+void testImageSSIM() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    // 97x83: lebih dari satu pita baris (minimal 64) untuk kedua jendela;
+    // 9x7: lebih kecil dari jendela Gaussian, jatuh ke kotak 7x7; tree hanya root
+    for (int size : {0, 1}) {
+        int width = size == 0 ? 97 : 9;
+        int height = size == 0 ? 83 : 7;
+        std::vector<std::vector<Color>> crop(image.begin() + 60, image.begin() + 60 + height);
+        for (std::vector<Color>& row : crop) row.assign(row.begin() + 180, row.begin() + 180 + width);
+
+        QuadTree tree;
+        tree.buildfrImage(crop, 1, size == 0 ? 20.0 : 1e9, 4);
+        std::vector<std::vector<Color>> result = tree.reconstructImage(tree.getWidth(), tree.getHeight());
+
+        for (SSIMWindow window : {SSIM_WINDOW_BOX, SSIM_WINDOW_GAUSSIAN}) {
+            ImageSSIMReport naive = naiveImageSSIM(crop, result, window);
+            for (int threads : {1, 3}) {
+                ImageSSIMReport fromImage = hitungImageSSIM(crop, result, window, threads);
+                ImageSSIMReport fromTree = hitungImageSSIM(crop, tree, window, threads);
+                std::printf("%dx%d jendela %d threads %d: SSIM %.12f (naif %.12f), %lld jendela\n", width, height,
+                            (int)window, threads, fromImage.ssim, naive.ssim, fromImage.windows);
+                for (const ImageSSIMReport* report : {&fromImage, &fromTree}) {
+                    CHECK(report->windows == naive.windows);
+                    CHECK(std::fabs(report->ssim - naive.ssim) <= 1e-10);
+                    for (int channel = 0; channel < 3; channel++) {
+                        CHECK(std::fabs(report->channel[channel] - naive.channel[channel]) <= 1e-10);
+                    }
+                }
+                // baris hasil sama dan urutan penjumlahan sama, jadi kedua varian identik
+                CHECK(fromImage.ssim == fromTree.ssim);
+            }
+        }
+    }
+}
+
+void testBuildMulti() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    // semua metode sekaligus, ditambah metode sama dengan threshold/minBlock lain
+    std::vector<QuadTreeConfig> configs = {
+        {1, 400.0, 4}, {2, 16.0, 8}, {3, 60.0, 4}, {4, 4.5, 4}, {5, 0.6, 8}, {6, 0.6, 1},
+    };
+    for (const BuildCase& c : kBuildCases) configs.push_back({c.method, c.threshold, c.minBlock});
+    std::vector<QuadTree> trees(configs.size());
+    std::vector<QuadTree*> pointers;
+    for (QuadTree& tree : trees) pointers.push_back(&tree);
+    QuadTree::buildMulti(image, configs, pointers);
+
+    for (size_t i = 0; i < configs.size(); i++) {
+        QuadTree single;
+        single.buildfrImage(image, configs[i].errorMethod, configs[i].threshold, configs[i].minBlockSize);
+        std::printf("metode %d threshold %g minBlock %d: %d simpul\n", configs[i].errorMethod, configs[i].threshold,
+                    configs[i].minBlockSize, trees[i].getTotalNodes());
+        CHECK(trees[i].getTotalNodes() == single.getTotalNodes());
+        CHECK(trees[i].getLeafCount() == single.getLeafCount());
+        CHECK(hashLeaves(trees[i]) == hashLeaves(single));
+    }
+}
+
+void testBuildfrTree() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    // source lebih halus (SSIM: threshold lebih besar) dengan minBlock 1,
+    // error simpulnya persis dari buildMulti atau buildBestFirst
+    const double fineThreshold[] = {20.0, 4.0, 10.0, 2.0, 0.95, 0.95};
+    for (size_t i = 0; i < sizeof(kBuildCases) / sizeof(kBuildCases[0]); i++) {
+        const BuildCase& c = kBuildCases[i];
+        QuadTree single;
+        single.buildfrImage(image, c.method, c.threshold, c.minBlock);
+
+        QuadTree multiSource;
+        QuadTree::buildMulti(image, {{c.method, fineThreshold[i], 1}}, {&multiSource});
+        QuadTree bestFirstSource;
+        bestFirstSource.buildBestFirst(image, c.method, fineThreshold[i], 1, QuadTreeBudget());
+
+        for (const QuadTree* source : {&multiSource, &bestFirstSource}) {
+            QuadTree derived;
+            derived.buildfrTree(*source, c.method, c.threshold, c.minBlock);
+            std::printf("metode %d threshold %g dari %d simpul: %d simpul\n", c.method, c.threshold,
+                        source->getTotalNodes(), derived.getTotalNodes());
+            CHECK(derived.getTotalNodes() == single.getTotalNodes());
+            CHECK(derived.getLeafCount() == single.getLeafCount());
+            CHECK(hashLeaves(derived) == hashLeaves(single));
+        }
+    }
+}
+
+// Jalan bersama dua tree: simpul di posisi yang sama pada keduanya. Blok
+// di bawah minBlockPixels diputuskan persis, jadi di sana keduanya harus
+// sama (status daun, error, warna). Mengembalikan banyak simpul yang dibanding.
+int compareExactBlocks(const QuadTreeNode* sampled, const QuadTreeNode* exact, int minBlockPixels) {
+    if (!sampled || !exact) return 0;
+    int compared = 0;
+    if ((long long)sampled->getpanjang() * sampled->getlebar() < minBlockPixels) {
+        Color a = sampled->getAvgColor(), b = exact->getAvgColor();
+        CHECK(sampled->isLeafNode() == exact->isLeafNode());
+        CHECK(sampled->getError() == exact->getError());
+        CHECK(a.r == b.r && a.g == b.g && a.b == b.b);
+        compared++;
+    }
+    if (sampled->isLeafNode() || exact->isLeafNode()) return compared;
+    compared += compareExactBlocks(sampled->getTopLeft(), exact->getTopLeft(), minBlockPixels);
+    compared += compareExactBlocks(sampled->getTopRight(), exact->getTopRight(), minBlockPixels);
+    compared += compareExactBlocks(sampled->getBottomLeft(), exact->getBottomLeft(), minBlockPixels);
+    compared += compareExactBlocks(sampled->getBottomRight(), exact->getBottomRight(), minBlockPixels);
+    return compared;
+}
+
+// simpul yang melewati keputusan sampel: bisa dipecah dan minimal minBlockPixels
+int countSampledBlocks(const QuadTreeNode* node, int minBlockSize, int minBlockPixels) {
+    if (!node) return 0;
+    bool canSplit = node->getpanjang() > minBlockSize && node->getlebar() > minBlockSize;
+    if (!canSplit || (long long)node->getpanjang() * node->getlebar() < minBlockPixels) return 0;
+    return 1 + countSampledBlocks(node->getTopLeft(), minBlockSize, minBlockPixels) +
+           countSampledBlocks(node->getTopRight(), minBlockSize, minBlockPixels) +
+           countSampledBlocks(node->getBottomLeft(), minBlockSize, minBlockPixels) +
+           countSampledBlocks(node->getBottomRight(), minBlockSize, minBlockPixels);
+}
+
+double millisSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void testDeadlineTreeReuse() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("benelli.jpg", image)) return;
+    std::vector<unsigned char> input = readFileBytes(testDir + "/benelli.jpg");
+
+    // tree sekitar 2 juta daun: simpulnya dipakai ulang, bukan dilepas satu per
+    // satu, jadi tidak ada biaya yang terbawa ke build berikutnya
+    QuadTree tree;
+    tree.buildfrImage(image, 1, 0.0, 1);
+    int previousLeaves = tree.getLeafCount();
+    auto start = std::chrono::steady_clock::now();
+    tree.clear();
+    double clearMillis = millisSince(start);
+
+    tree.buildfrImage(image, 1, 0.0, 1);
+    QuadTreeBudget budget;
+    budget.maxMillis = 100.0;
+    budget.weightByArea = true;
+    start = std::chrono::steady_clock::now();
+    QtBuildStop stop = tree.buildBestFirst(image, 1, 0.0, 1, budget);
+    double buildMillis = millisSince(start);
+    std::printf("tree %d daun: clear %.2f ms; buildBestFirst 100 ms: %.1f ms, %d daun\n", previousLeaves,
+                clearMillis, buildMillis, tree.getLeafCount());
+    CHECK(clearMillis < 5.0);
+    CHECK(stop == QT_STOP_TIME);
+    CHECK(buildMillis <= budget.maxMillis + 25.0);
+    CHECK(tree.getLeafCount() >= 1000);
+
+    // encoder: tree internal dan tree milik pemanggil, tidak ada kerja di luar jam pemanggilan
+    QtEncodeOptions options;
+    options.threshold = 0.0;
+    options.minBlockSize = 1;
+    options.format = "png";
+    QtEncodeOptions deadline = options;
+    deadline.deadlineMillis = 300.0;
+    std::vector<unsigned char> out;
+    for (bool callerTree : {false, true}) {
+        QuadtreeEncoder encoder;
+        QuadTree target;
+        QuadTree* targetTree = callerTree ? &target : nullptr;
+        CHECK(encoder.encodeFromMemory(input.data(), input.size(), options, out, targetTree) == QT_OK);
+        previousLeaves = encoder.getLastReport().leaves;
+
+        start = std::chrono::steady_clock::now();
+        CHECK(encoder.encodeFromMemory(input.data(), input.size(), deadline, out, targetTree) == QT_OK);
+        double callMillis = millisSince(start);
+        const QtEncodeReport& report = encoder.getLastReport();
+        std::printf("encoder setelah tree %d daun, deadline 300 ms: %.1f ms (laporan %.1f ms), %d daun\n",
+                    previousLeaves, callMillis, report.totalMillis, report.leaves);
+        CHECK(callMillis - report.totalMillis < 5.0);
+        CHECK(report.leaves >= 10000);
+        if (callerTree) CHECK(target.getLeafCount() == report.leaves);
+    }
+}
+
+void testDeadlineMet() {
+    std::vector<unsigned char> input = readFileBytes(testDir + "/benelli.jpg");
+    CHECK(!input.empty());
+    if (input.empty()) return;
+
+    // deadline masih membatasi build (tree penuh butuh > 500 ms) tetapi longgar;
+    // pemanggilan pertama memakai margin awal, berikutnya margin terkalibrasi
+    QtEncodeOptions options;
+    options.threshold = 0.0;
+    options.minBlockSize = 1;
+    options.deadlineMillis = 400.0;
+    std::vector<unsigned char> out;
+    for (const char* format : {"png", "jpg"}) {
+        options.format = format;
+        QuadtreeEncoder encoder;
+        for (int call = 0; call < 4; call++) {
+            CHECK(encoder.encodeFromMemory(input.data(), input.size(), options, out) == QT_OK);
+            const QtEncodeReport& report = encoder.getLastReport();
+            std::printf("%s deadline 400 ms, pemanggilan %d: %.1f ms (build %.1f, encode %.1f), %d daun\n", format,
+                        call, report.totalMillis, report.buildMillis, report.encodeMillis, report.leaves);
+            CHECK(report.buildStop == QT_STOP_TIME);
+            CHECK(report.deadlineMet);
+            // margin tidak boleh menghabiskan sebagian besar deadline
+            CHECK(report.totalMillis >= options.deadlineMillis * 0.5);
+        }
+    }
+}
+
+void testPipelineDeadline() {
+    std::string input = testDir + "/benelli.jpg";
+    CHECK(!readFileBytes(input).empty());
+
+    // jam deadline mulai saat reader mengambil job, jadi baca, decode, dan waktu
+    // antri ikut; satu job tidak berebut core dengan decode job berikutnya
+    PipelineJob job;
+    job.inputPath = input;
+    job.options.threshold = 0.0;
+    job.options.minBlockSize = 1;
+    job.options.deadlineMillis = 400.0;
+    PipelineOptions options;
+    options.computeThreads = 1;
+    options.queueCapacity = 1;
+    for (size_t count : {1, 3}) {
+        std::vector<PipelineJob> jobs(count, job);
+        for (size_t i = 0; i < count; i++) {
+            jobs[i].outputPath = "quadtree_tests_pipeline_" + std::to_string(i) + ".png";
+        }
+        std::vector<PipelineResult> results = runPipeline(jobs, options);
+        CHECK(results.size() == count);
+        for (const PipelineResult& result : results) {
+            std::printf("%zu job, %s: %.1f ms (build %.1f), %d daun, deadline %s\n", count,
+                        result.outputPath.c_str(), result.totalMillis, result.buildMillis, result.leaves,
+                        result.deadlineMet ? "ok" : "terlewat");
+            CHECK(result.status == QT_OK);
+            CHECK(result.buildMillis > 0 && result.totalMillis > result.buildMillis);
+            CHECK(result.deadlineMet == (result.totalMillis <= job.options.deadlineMillis));
+            std::remove(result.outputPath.c_str());
+        }
+        if (count == 1) {
+            CHECK(results[0].buildStop == QT_STOP_TIME);
+            CHECK(results[0].deadlineMet);
+        }
+    }
+}
+
+void testSampling() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("moana.png", image)) return;
+
+    for (const BuildCase& c : kBuildCases) {
+        QuadTree exact;
+        exact.buildfrImage(image, c.method, c.threshold, c.minBlock);
+        double exactPsnr = hitungPSNR(image, exact);
+        // MPD dan SSIM blok tidak bisa ditaksir: hasilnya selalu persis
+        bool canEstimate = c.method != 3 && c.method != 6;
+
+        // z kecil: keputusan sampel lebih sering berbeda dari scan persis
+        for (double z : {3.0, 0.5}) {
+            QuadTreeSampling sampling;
+            sampling.enabled = true;
+            sampling.sampleSize = 256;
+            sampling.confidenceZ = z;
+            QuadTree sampled;
+            sampled.buildfrImage(image, c.method, c.threshold, c.minBlock, sampling);
+            const QuadTreeScanStats& stats = sampled.getScanStats();
+            double sampledPsnr = hitungPSNR(image, sampled);
+            std::printf("metode %d z %g: daun %d persis %d, PSNR %.3f persis %.3f, sampel %d, persis %d\n", c.method,
+                        z, sampled.getLeafCount(), exact.getLeafCount(), sampledPsnr, exactPsnr,
+                        stats.sampledDecisions, stats.exactFallbacks);
+            CHECK(leavesCoverImage(sampled));
+
+            // tiap blok yang lolos syarat ukuran diputuskan dari sampel atau di-scan ulang persis
+            int eligible = countSampledBlocks(sampled.getRoot(), c.minBlock, sampling.minBlockPixels());
+            if (canEstimate) {
+                CHECK(stats.sampledDecisions + stats.exactFallbacks == eligible);
+                CHECK(stats.sampledDecisions > 0);
+                CHECK(std::abs(sampled.getLeafCount() - exact.getLeafCount()) <= exact.getLeafCount() / 20);
+                CHECK(std::fabs(sampledPsnr - exactPsnr) <= 0.25);
+            } else {
+                CHECK(stats.sampledDecisions == 0 && stats.exactFallbacks == 0);
+                CHECK(hashLeaves(sampled) == hashLeaves(exact));
+            }
+            CHECK(compareExactBlocks(sampled.getRoot(), exact.getRoot(), sampling.minBlockPixels()) > 0);
+        }
+
+        // root di bawah minBlockPixels: seluruh tree persis
+        QuadTreeSampling large;
+        large.enabled = true;
+        large.sampleSize = (int)(image.size() * image[0].size() / 16) + 1;
+        QuadTree whole;
+        whole.buildfrImage(image, c.method, c.threshold, c.minBlock, large);
+        CHECK(whole.getScanStats().sampledDecisions == 0 && whole.getScanStats().exactFallbacks == 0);
+        CHECK(hashLeaves(whole) == hashLeaves(exact));
+    }
+}
+
+void testBuildBudget() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    for (size_t i = 0; i < sizeof(kBuildCases) / sizeof(kBuildCases[0]); i++) {
+        const BuildCase& c = kBuildCases[i];
+        // tanpa batas, best-first memecah simpul yang sama dengan buildfrImage
+        QuadTree unlimited;
+        CHECK(unlimited.buildBestFirst(image, c.method, c.threshold, c.minBlock, QuadTreeBudget()) ==
+              QT_STOP_CONVERGED);
+        CHECK(unlimited.getTotalNodes() == kBuildExpected[i].nodes);
+        CHECK(unlimited.getLeafCount() == kBuildExpected[i].leaves);
+        CHECK(hashLeaves(unlimited) == kBuildExpected[i].hash);
+
+        // batas di atas ukuran tree penuh tidak berpengaruh
+        QuadTreeBudget loose;
+        loose.maxNodes = kBuildExpected[i].nodes;
+        loose.maxLeaves = kBuildExpected[i].leaves;
+        loose.maxBytes = (size_t)kBuildExpected[i].nodes * QuadTree::bytesPerNode;
+        QuadTree converged;
+        CHECK(converged.buildBestFirst(image, c.method, c.threshold, c.minBlock, loose) == QT_STOP_CONVERGED);
+        CHECK(hashLeaves(converged) == hashLeaves(unlimited));
+
+        // tiap batas dipenuhi sampai pemecahan berikutnya (4 simpul, 3 daun) melewatinya
+        for (int limit = 0; limit < 3; limit++) {
+            QuadTreeBudget budget;
+            QtBuildStop expected;
+            if (limit == 0) {
+                budget.maxNodes = kBuildExpected[i].nodes / 3;
+                expected = QT_STOP_NODES;
+            } else if (limit == 1) {
+                budget.maxLeaves = kBuildExpected[i].leaves / 3;
+                expected = QT_STOP_LEAVES;
+            } else {
+                budget.maxBytes = (size_t)kBuildExpected[i].nodes * QuadTree::bytesPerNode / 3;
+                expected = QT_STOP_BYTES;
+            }
+
+            QuadTree tree;
+            QtBuildStop stop = tree.buildBestFirst(image, c.method, c.threshold, c.minBlock, budget);
+            size_t bytes = (size_t)tree.hitungCompressedSize();
+            std::printf("metode %d batas %d: %s, %d simpul, %d daun, %zu byte\n", c.method, limit,
+                        qtBuildStopMessage(stop), tree.getTotalNodes(), tree.getLeafCount(), bytes);
+            CHECK(stop == expected);
+            CHECK(leavesCoverImage(tree));
+            CHECK(tree.getLeafCount() == (tree.getTotalNodes() - 1) / 4 * 3 + 1);
+            if (limit == 0) {
+                CHECK(tree.getTotalNodes() <= budget.maxNodes);
+                CHECK(tree.getTotalNodes() + 4 > budget.maxNodes);
+            } else if (limit == 1) {
+                CHECK(tree.getLeafCount() <= budget.maxLeaves);
+                CHECK(tree.getLeafCount() + 3 > budget.maxLeaves);
+            } else {
+                CHECK(bytes <= budget.maxBytes);
+                CHECK(bytes + 4 * QuadTree::bytesPerNode > budget.maxBytes);
+            }
+        }
+    }
+}
+
+void testBuildForQuality() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+
+    struct QualityCase {
+        QtQualityMetric metric;
+        double minimum;
+    };
+    // tree terhalus minBlock 2 sekitar 27 dB, jadi 80 dB tidak tercapai
+    const QualityCase targets[] = {
+        {QT_QUALITY_PSNR, 24.0}, {QT_QUALITY_PSNR, 26.5}, {QT_QUALITY_PSNR, 80.0},
+        {QT_QUALITY_SSIM, 0.7}, {QT_QUALITY_SSIM, 0.9},
+    };
+
+    for (int method = 1; method <= 6; method++) {
+        for (const QualityCase& q : targets) {
+            QuadTreeQualityTarget target;
+            target.metric = q.metric;
+            target.minimum = q.minimum;
+            QuadTree tree;
+            QuadTreeQuality result = tree.buildForQuality(image, method, target, 2);
+
+            QuadTree single;
+            single.buildfrImage(image, method, result.threshold, 2);
+            std::printf("metode %d target %g: tercapai %d threshold %g nilai %g, %d simpul\n", method, q.minimum,
+                        result.reached, result.threshold, result.value, tree.getTotalNodes());
+            CHECK(tree.getTotalNodes() == single.getTotalNodes());
+            CHECK(hashLeaves(tree) == hashLeaves(single));
+            CHECK(result.reached == (result.value >= q.minimum));
+            if (q.minimum == 80.0) CHECK(!result.reached);
+            if (q.metric == QT_QUALITY_PSNR) {
+                double psnr = hitungPSNR(image, single.reconstructImage(single.getWidth(), single.getHeight()));
+                CHECK(std::fabs(result.value - psnr) <= 1e-9 * std::fabs(psnr));
+            }
+        }
+    }
+}
+
+void testTargetCompression() {
+    std::vector<std::vector<Color>> image;
+    if (!loadImage("snoopy.png", image)) return;
+    // png asli cukup besar: tree paling halus pun sudah sekitar 0.77
+    int originalSize = (int)getFileSize(testDir + "/snoopy.png");
+
+    for (int method = 1; method <= 6; method++) {
+        for (int threads : {1, 3}) {
+            double threshold = estimateThresholdForTargetCompression(image, method, 2, 0.8, originalSize, threads);
+            QuadTree tree;
+            tree.buildfrImage(image, method, threshold, 2);
+            std::vector<unsigned char> jpeg;
+            encodeQuadtreeJPEG(tree, jpeg);
+            double ratio = 1.0 - (double)jpeg.size() / originalSize;
+            std::printf("metode %d threads %d: threshold %g rasio %.4f\n", method, threads, threshold, ratio);
+            CHECK(std::fabs(ratio - 0.8) <= 0.01);
+        }
+    }
+}
+
+void testLoadFailureReason() {
+    std::vector<std::vector<Color>> image;
+    int width, height;
+
+    // alasan tiap kegagalan milik kegagalan itu sendiri, bukan sisa sebelumnya
+    CHECK(!readImage(testDir + "/tidak-ada.png", image, width, height));
+    std::printf("file tidak ada: %s\n", imageLoadFailureReason());
+    CHECK(std::strcmp(imageLoadFailureReason(), std::strerror(ENOENT)) == 0);
+
+    const unsigned char garbage[] = "bukan gambar";
+    CHECK(!readImageFromMemory(garbage, sizeof(garbage), image, width, height));
+    std::printf("buffer rusak: %s\n", imageLoadFailureReason());
+    CHECK(imageLoadFailureReason()[0] != '\0');
+    CHECK(std::strcmp(imageLoadFailureReason(), std::strerror(ENOENT)) != 0);
+
+    CHECK(!readImageFromMemory(garbage, 0, image, width, height));
+    std::printf("buffer kosong: %s\n", imageLoadFailureReason());
+    CHECK(std::strcmp(imageLoadFailureReason(), "buffer kosong atau terlalu besar") == 0);
+
+    CHECK(readImage(testDir + "/snoopy.png", image, width, height));
+    CHECK(width == 392 && height == 347);
+}
+
+struct TestCase {
+    const char* name;
+    void (*run)();
+};
+
+const TestCase kCases[] = {
+    {"buildfrImage", testBuildfrImage},
+    {"pngOutput", testPngOutput},
+    {"bmpTgaOutput", testBmpTgaOutput},
+    {"pngLevels", testPngLevels},
+    {"deflateRoundTrip", testDeflateRoundTrip},
+    {"jpegSimd", testJpegSimd},
+    {"jpegRestartStrips", testJpegRestartStrips},
+    {"gifLzw", testGifLzw},
+    {"gifEncoder", testGifEncoder},
+    {"imageSSIM", testImageSSIM},
+    {"buildMulti", testBuildMulti},
+    {"buildfrTree", testBuildfrTree},
+    {"buildBudget", testBuildBudget},
+    {"deadlineTreeReuse", testDeadlineTreeReuse},
+    {"deadlineMet", testDeadlineMet},
+    {"pipelineDeadline", testPipelineDeadline},
+    {"sampling", testSampling},
+    {"buildForQuality", testBuildForQuality},
+    {"targetCompression", testTargetCompression},
+    {"loadFailureReason", testLoadFailureReason},
+};
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc != 3) {
+        std::fprintf(stderr, "pemakaian: quadtree_tests <kasus> <direktori test/>\n");
+        return 2;
+    }
+    testDir = argv[2];
+    for (const TestCase& c : kCases) {
+        if (std::strcmp(c.name, argv[1]) == 0) {
+            c.run();
+            return failures ? 1 : 0;
+        }
+    }
+    std::fprintf(stderr, "kasus tidak dikenal: %s\n", argv[1]);
+    return 2;
+}
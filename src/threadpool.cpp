@@ -0,0 +1,79 @@
+#include "header/threadpool.h"
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+ThreadPool::ThreadPool(int threads) {
+    if (threads <= 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < threads; i++) {
+        workers.emplace_back([this]() { workerLoop(); });
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    cv.notify_all();
+    for (auto& worker : workers) worker.join();
+}
+
+ThreadPool& ThreadPool::global() {
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::workerLoop() {
+    for (;;) {
+        std::function<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            cv.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop_front();
+        }
+        task();
+    }
+}
+
+void ThreadPool::parallelFor(size_t count, const std::function<void(size_t)>& fn, int maxParallel) {
+    if (count == 0) return;
+
+    int parallel = size();
+    if (maxParallel > 0) parallel = std::min(parallel, maxParallel);
+    if (parallel <= 1 || count == 1) {
+        for (size_t i = 0; i < count; i++) fn(i);
+        return;
+    }
+
+    struct Shared {
+        std::atomic<size_t> next{0};
+        std::atomic<size_t> done{0};
+        std::mutex mutex;
+        std::condition_variable finished;
+    };
+    auto shared = std::make_shared<Shared>();
+
+    auto runIndices = [shared, count, &fn]() {
+        size_t completed = 0;
+        for (size_t i; (i = shared->next.fetch_add(1)) < count; completed++) fn(i);
+        if (completed && shared->done.fetch_add(completed) + completed == count) {
+            std::lock_guard<std::mutex> lock(shared->mutex);
+            shared->finished.notify_all();
+        }
+    };
+
+    int helpers = (int)std::min<size_t>(parallel - 1, count - 1);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (int i = 0; i < helpers; i++) tasks.push_back(runIndices);
+    }
+    cv.notify_all();
+
+    runIndices();
+
+    std::unique_lock<std::mutex> lock(shared->mutex);
+    shared->finished.wait(lock, [&]() { return shared->done.load() == count; });
+}